@@ -1,4 +1,10 @@
 #include "Game/App.h"
+#include "Game/JobSystem.hpp"
+#include "Game/HeadlessInputScript.hpp"
+#include "Game/HeapAllocationCounter.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/TextureStreamer.hpp"
+#include "Game/FrameArena.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Renderer/Renderer.h"
 #include "Engine/Renderer/Camera.h"
@@ -11,12 +17,19 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/DebugRender.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <fstream>
+#include <stdlib.h>
 
 RandomNumberGenerator* g_rng = nullptr; // Created and owned by the App
 App* g_theApp = nullptr;				// Created and owned by Main_Windows.cpp
 Renderer* g_theRenderer = nullptr;		// Created and owned by the App
 AudioSystem* g_theAudio = nullptr;		// Created and owned by the App
 Window* g_theWindow = nullptr;			// Created and owned by the App
+JobSystem* g_theJobSystem = nullptr;	// Created and owned by the App
+Profiler* g_theProfiler = nullptr;		// Created and owned by the App
+TextureStreamer* g_theTextureStreamer = nullptr; // Created and owned by the App
+FrameArena* g_theFrameArena = nullptr;	// Created and owned by the App
 Game* m_theGame;						// Owns the Game instance
 
 
@@ -37,6 +50,34 @@ void App::Startup()
 	InputSystemConfig inputConfig;
 	g_theInput = new InputSystem(inputConfig);
 
+	JobSystemConfig jobSystemConfig;
+	g_theJobSystem = new JobSystem(jobSystemConfig);
+
+	ProfilerConfig profilerConfig;
+	g_theProfiler = new Profiler(profilerConfig);
+
+	TextureStreamerConfig textureStreamerConfig;
+	g_theTextureStreamer = new TextureStreamer(textureStreamerConfig);
+
+	FrameArenaConfig frameArenaConfig;
+	g_theFrameArena = new FrameArena(frameArenaConfig);
+
+	if (m_isHeadless)
+	{
+		// Only the systems the simulation needs; nothing here touches a window or the GPU
+		g_theEventSystem->Startup();
+		g_theProfiler->Startup();
+		g_theFrameArena->Startup();
+		g_theInput->Startup();
+		g_theJobSystem->Startup();
+		g_theTextureStreamer->Startup();
+
+		StartGame();
+
+		SubscribeToEvents();
+		return;
+	}
+
 	WindowConfig windowConfig;
 	windowConfig.m_aspectRatio = 2.f;
 	windowConfig.m_inputSystem = g_theInput;
@@ -56,34 +97,67 @@ void App::Startup()
 	g_theDevConsole = new DevConsole(devConsoleConfig);
 
 	g_theEventSystem->Startup();
+	g_theProfiler->Startup();
+	g_theFrameArena->Startup();
 	g_theDevConsole->Startup();
 	g_theInput->Startup();
 	g_theWindow->Startup();
 	g_theRenderer->Startup();
+	g_theJobSystem->Startup();
+	g_theTextureStreamer->Startup();
 
 	DebugRenderConfig debugRenderConfig;
 	debugRenderConfig.m_renderer = g_theRenderer;
 	debugRenderConfig.m_fontName = "Data/Fonts/SquirrelFixedFont";
 	DebugRenderSystemStartup(debugRenderConfig);
 
-	m_theGame = new Game(this);
-	m_theGame->StartUp();
+	StartGame();
 
 	SubscribeToEvents();
 }
 
+void App::StartGame()
+{
+	m_theGame = new Game(this);
+	m_theGame->StartUp();
+	m_theGame->SetSimulationRate(m_simulationHz);
+	if (!m_isBenchmark)
+	{
+		m_theGame->SpawnCollisionStressBodies(m_numCollisionStressBodies);
+	}
+	StartInputRecordingOrReplay();
+}
+
 void App::Shutdown()
 {
+	if (!m_inputRecordPath.empty())
+	{
+		m_theGame->SaveInputRecording(m_inputRecordPath);
+	}
+
 	m_theGame->Shutdown();
 	delete m_theGame;
 	m_theGame = nullptr;
 
-	DebugRenderSystemShutdown();
+	if (!m_isHeadless)
+	{
+		DebugRenderSystemShutdown();
+	}
 
-	g_theRenderer->Shutdown();
-	g_theWindow->Shutdown();
+	g_theTextureStreamer->Shutdown();
+	g_theJobSystem->Shutdown();
+	g_theFrameArena->Shutdown();
+	g_theProfiler->Shutdown();
+	if (!m_isHeadless)
+	{
+		g_theRenderer->Shutdown();
+		g_theWindow->Shutdown();
+	}
 	g_theInput->Shutdown();
-	g_theDevConsole->Shutdown();
+	if (!m_isHeadless)
+	{
+		g_theDevConsole->Shutdown();
+	}
 	g_theEventSystem->Shutdown();
 
 	delete g_theRenderer;
@@ -91,18 +165,35 @@ void App::Shutdown()
 	delete g_theWindow;
 	delete g_theInput;
 	delete g_theDevConsole;
+	delete g_theJobSystem;
+	delete g_theProfiler;
+	delete g_theTextureStreamer;
+	delete g_theFrameArena;
 
 	g_theRenderer = nullptr;
 	g_theEventSystem = nullptr;
 	g_theWindow = nullptr;
 	g_theInput = nullptr;
 	g_theDevConsole = nullptr;
+	g_theJobSystem = nullptr;
+	g_theProfiler = nullptr;
+	g_theTextureStreamer = nullptr;
+	g_theFrameArena = nullptr;
 }
 
 void App::BeginFrame()
 {
+	g_theProfiler->BeginFrame();
+	PROFILE_SCOPE("App::BeginFrame");
+
 	Clock::TickSystemClock();
 
+	if (m_isHeadless)
+	{
+		g_theEventSystem->BeginFrame();
+		return;
+	}
+
 	g_theRenderer->BeginFrame();
 	g_theEventSystem->BeginFrame();
 	g_theWindow->BeginFrame();
@@ -114,6 +205,14 @@ void App::BeginFrame()
 
 void App::Render() const
 {
+	PROFILE_SCOPE("App::Render");
+
+	if (m_isHeadless)
+	{
+		m_theGame->Render();
+		return;
+	}
+
 	g_theRenderer->ClearScreen(Rgba8(150, 150, 150, 255));
 	m_theGame->Render();
 	g_theDevConsole->Render(AABB2(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y)));
@@ -121,6 +220,14 @@ void App::Render() const
 
 void App::Update()
 {
+	PROFILE_SCOPE("App::Update");
+
+	if (m_isHeadless)
+	{
+		m_theGame->Update();
+		return;
+	}
+
 	if (g_theDevConsole->GetMode() == DevConsoleMode::OPEN_FULL || m_theGame->m_isAttractMode || GetActiveWindow() != Window::s_mainWindow->GetHwnd())
 	{
 		g_theInput->SetCursorMode(CursorMode::POINTER);
@@ -146,8 +253,18 @@ void App::Update()
 
 void App::EndFrame()
 {
+	PROFILE_SCOPE("App::EndFrame");
+
 	g_theEventSystem->EndFrame();
 	g_theInput->EndFrame();
+
+	// Nothing allocated from the arena this frame may be used past this point
+	g_theFrameArena->EndFrame();
+
+	if (m_isHeadless)
+	{
+		return;
+	}
 	g_theWindow->EndFrame();
 	g_theRenderer->EndFrame();
 	g_theDevConsole->EndFrame();
@@ -158,6 +275,10 @@ void App::EndFrame()
 void App::SubscribeToEvents()
 {
 	SubscribeEventCallbackFunction("Quit", HandleQuitRequested);
+	SubscribeEventCallbackFunction("SimulationRate", Command_SimulationRate);
+	SubscribeEventCallbackFunction("CollisionStress", Command_CollisionStress);
+	SubscribeEventCallbackFunction("OcclusionCulling", Command_OcclusionCulling);
+	SubscribeEventCallbackFunction("MeshLod", Command_MeshLod);
 }
 
 void App::RunFrame()
@@ -176,9 +297,347 @@ void App::RunMainLoop()
 	}
 }
 
+void App::RunHeadless()
+{
+	HeadlessInputScript inputScript = HeadlessInputScript::MakeDefaultFlythrough();
+
+	// Same phases as RunFrame, timed one by one
+	int frameIndex = 0;
+	for (; frameIndex < m_numHeadlessFrames && !IsQuitting(); ++frameIndex)
+	{
+		// A replay supplies its own input, so the script only drives runs without one
+		if (m_inputReplayPath.empty())
+		{
+			inputScript.ApplyFrame(frameIndex, *g_theInput);
+		}
+
+		double phaseStartTime = GetCurrentTimeSeconds();
+		BeginFrame();
+		double phaseEndTime = GetCurrentTimeSeconds();
+		RecordPhaseTime(APP_PHASE_BEGIN_FRAME, phaseEndTime - phaseStartTime, frameIndex);
+
+		phaseStartTime = phaseEndTime;
+		Update();
+		phaseEndTime = GetCurrentTimeSeconds();
+		RecordPhaseTime(APP_PHASE_UPDATE, phaseEndTime - phaseStartTime, frameIndex);
+
+		phaseStartTime = phaseEndTime;
+		Render();
+		phaseEndTime = GetCurrentTimeSeconds();
+		RecordPhaseTime(APP_PHASE_RENDER, phaseEndTime - phaseStartTime, frameIndex);
+
+		phaseStartTime = phaseEndTime;
+		EndFrame();
+		phaseEndTime = GetCurrentTimeSeconds();
+		RecordPhaseTime(APP_PHASE_END_FRAME, phaseEndTime - phaseStartTime, frameIndex);
+	}
+
+	ReportHeadlessTimings(frameIndex);
+	if (!m_headlessTracePath.empty())
+	{
+		g_theProfiler->ExportChromeTrace(m_headlessTracePath);
+	}
+
+	// The last frame's occlusion depth, for comparing against a reference image
+	if (!m_occlusionDepthImagePath.empty() && !m_theGame->ExportOcclusionDepthImage(m_occlusionDepthImagePath))
+	{
+		ERROR_RECOVERABLE(Stringf("Could not write occlusion depth image \"%s\"", m_occlusionDepthImagePath.c_str()));
+	}
+}
+
+void App::RunBenchmark()
+{
+	BenchmarkReport report;
+	std::vector<BenchmarkScene> scenes = BenchmarkReport::MakeSceneScalingSuite(m_benchmarkConfig.m_maxSceneSize);
+	for (size_t sceneIndex = 0; sceneIndex < scenes.size() && !IsQuitting(); ++sceneIndex)
+	{
+		// Every scene starts from a fresh game so nothing left over from the last one is measured
+		m_theGame->Shutdown();
+		delete m_theGame;
+		StartGame();
+		m_theGame->m_isAttractMode = false;
+		m_theGame->SpawnBenchmarkScene(scenes[sceneIndex]);
+
+		report.AddResult(MeasureBenchmarkScene(scenes[sceneIndex]));
+		DebuggerPrintf("Benchmark scene %s done\n", scenes[sceneIndex].m_name.c_str());
+	}
+
+	std::vector<std::string> reportLines;
+	reportLines.push_back(Stringf("Benchmark: %d scenes, %d measured frames each, %d worker threads", static_cast<int>(report.GetResults().size()),
+		m_benchmarkConfig.m_numMeasuredFrames, g_theJobSystem->GetNumWorkerThreads()));
+	report.GetSummaryLines(reportLines);
+
+	std::string error;
+	if (!report.SaveToFile(m_benchmarkConfig.m_resultsPath, error))
+	{
+		ERROR_RECOVERABLE(Stringf("Could not save benchmark results: %s", error.c_str()));
+	}
+
+	// A regression against the stored baseline fails the run so it can gate a release
+	if (!m_benchmarkConfig.m_baselinePath.empty())
+	{
+		BenchmarkReport baseline;
+		if (!baseline.LoadFromFile(m_benchmarkConfig.m_baselinePath, error))
+		{
+			ERROR_RECOVERABLE(Stringf("Could not load benchmark baseline: %s", error.c_str()));
+			m_exitCode = 1;
+		}
+		else if (report.CompareAgainstBaseline(baseline, m_benchmarkConfig.m_regressionTolerance, reportLines) > 0)
+		{
+			m_exitCode = 1;
+		}
+	}
+
+	for (size_t lineIndex = 0; lineIndex < reportLines.size(); ++lineIndex)
+	{
+		DebuggerPrintf("%s\n", reportLines[lineIndex].c_str());
+	}
+	if (!m_headlessReportPath.empty())
+	{
+		std::ofstream reportFile(m_headlessReportPath);
+		for (size_t lineIndex = 0; lineIndex < reportLines.size(); ++lineIndex)
+		{
+			reportFile << reportLines[lineIndex] << "\n";
+		}
+	}
+}
+
+BenchmarkResult App::MeasureBenchmarkScene(BenchmarkScene const& scene)
+{
+	BenchmarkResult result;
+	result.m_scene = scene;
+
+	int numFrames = m_benchmarkConfig.m_numWarmupFrames + m_benchmarkConfig.m_numMeasuredFrames;
+	for (int frameIndex = 0; frameIndex < numFrames && !IsQuitting(); ++frameIndex)
+	{
+		uint64_t heapAllocationsBefore = GetNumHeapAllocations();
+		uint64_t heapBytesBefore = GetNumHeapAllocatedBytes();
+
+		BeginFrame();
+		double updateStartTime = GetCurrentTimeSeconds();
+		Update();
+		double renderStartTime = GetCurrentTimeSeconds();
+		Render();
+		double renderEndTime = GetCurrentTimeSeconds();
+		EndFrame();
+
+		// Warmup frames fill the pipeline and let containers reach their working size
+		if (frameIndex < m_benchmarkConfig.m_numWarmupFrames)
+		{
+			continue;
+		}
+		double updateMs = (renderStartTime - updateStartTime) * 1000.0;
+		result.m_avgUpdateMs += updateMs;
+		result.m_maxUpdateMs = updateMs > result.m_maxUpdateMs ? updateMs : result.m_maxUpdateMs;
+		result.m_avgBuildRenderCommandsMs += m_theGame->GetLastBuildRenderCommandsSeconds() * 1000.0;
+		result.m_avgRenderMs += (renderEndTime - renderStartTime) * 1000.0;
+		result.m_avgDrawCalls += static_cast<double>(m_theGame->GetLastFrameRenderStats().m_numDrawCalls);
+		result.m_avgOccludedProps += static_cast<double>(m_theGame->GetNumOccludedEntities());
+		result.m_avgHeapAllocations += static_cast<double>(GetNumHeapAllocations() - heapAllocationsBefore);
+		result.m_avgHeapBytes += static_cast<double>(GetNumHeapAllocatedBytes() - heapBytesBefore);
+		result.m_avgFrameArenaBytes += static_cast<double>(g_theFrameArena->GetLastFrameBytes());
+		++result.m_numFrames;
+	}
+
+	if (result.m_numFrames > 0)
+	{
+		double frameScale = 1.0 / static_cast<double>(result.m_numFrames);
+		result.m_avgUpdateMs *= frameScale;
+		result.m_avgBuildRenderCommandsMs *= frameScale;
+		result.m_avgRenderMs *= frameScale;
+		result.m_avgDrawCalls *= frameScale;
+		result.m_avgOccludedProps *= frameScale;
+		result.m_avgHeapAllocations *= frameScale;
+		result.m_avgHeapBytes *= frameScale;
+		result.m_avgFrameArenaBytes *= frameScale;
+	}
+	return result;
+}
+
+void App::ParseCommandLine(std::string const& commandLine)
+{
+	// Arguments look like "-headless -frames=600 -report=HeadlessReport.txt -trace=HeadlessTrace.json -simhz=60 -collisionstress=50000 -record=Capture.input -occlusiondepth=OcclusionDepth.pgm"
+	// or "-benchmark -benchmarkmax=1000000 -benchmarkframes=60 -results=BenchmarkResults.json -baseline=BenchmarkBaseline.json -tolerance=0.2"
+	Strings arguments = SplitStringOnDelimiter(commandLine, ' ');
+	for (size_t argIndex = 0; argIndex < arguments.size(); ++argIndex)
+	{
+		Strings keyAndValue = SplitStringOnDelimiter(arguments[argIndex], '=');
+		std::string const& key = keyAndValue[0];
+		std::string value = keyAndValue.size() > 1 ? keyAndValue[1] : "";
+
+		if (key == "-headless")
+		{
+			m_isHeadless = true;
+		}
+		else if (key == "-frames" && !value.empty())
+		{
+			m_numHeadlessFrames = atoi(value.c_str());
+		}
+		else if (key == "-report" && !value.empty())
+		{
+			m_headlessReportPath = value;
+		}
+		else if (key == "-trace" && !value.empty())
+		{
+			m_headlessTracePath = value;
+		}
+		else if (key == "-simhz" && !value.empty())
+		{
+			m_simulationHz = static_cast<float>(atof(value.c_str()));
+		}
+		else if (key == "-collisionstress" && !value.empty())
+		{
+			m_numCollisionStressBodies = atoi(value.c_str());
+		}
+		else if (key == "-record" && !value.empty())
+		{
+			m_inputRecordPath = value;
+		}
+		else if (key == "-replay" && !value.empty())
+		{
+			m_inputReplayPath = value;
+		}
+		else if (key == "-occlusiondepth" && !value.empty())
+		{
+			m_occlusionDepthImagePath = value;
+		}
+		else if (key == "-benchmark")
+		{
+			m_isHeadless = true;
+			m_isBenchmark = true;
+		}
+		else if (key == "-benchmarkmax" && !value.empty())
+		{
+			m_benchmarkConfig.m_maxSceneSize = atoi(value.c_str());
+		}
+		else if (key == "-benchmarkframes" && !value.empty())
+		{
+			m_benchmarkConfig.m_numMeasuredFrames = atoi(value.c_str());
+		}
+		else if (key == "-results" && !value.empty())
+		{
+			m_benchmarkConfig.m_resultsPath = value;
+		}
+		else if (key == "-baseline" && !value.empty())
+		{
+			m_benchmarkConfig.m_baselinePath = value;
+		}
+		else if (key == "-tolerance" && !value.empty())
+		{
+			m_benchmarkConfig.m_regressionTolerance = atof(value.c_str());
+		}
+	}
+}
+
+void App::StartInputRecordingOrReplay()
+{
+	// Replays only match the recording when started with the same scene, -simhz and -collisionstress arguments
+	if (!m_inputReplayPath.empty())
+	{
+		m_inputRecordPath.clear();
+		if (m_theGame->StartInputReplay(m_inputReplayPath) && m_isHeadless)
+		{
+			// The recording decides how long a headless replay runs
+			m_numHeadlessFrames = m_theGame->GetNumReplayFrames();
+		}
+		return;
+	}
+	if (!m_inputRecordPath.empty())
+	{
+		m_theGame->StartInputRecording();
+	}
+}
+
+void App::RecordPhaseTime(AppFramePhase phase, double seconds, int frameIndex)
+{
+	AppPhaseTiming& timing = m_phaseTimings[phase];
+	timing.m_totalSeconds += seconds;
+	if (frameIndex == 0 || seconds < timing.m_minSeconds)
+	{
+		timing.m_minSeconds = seconds;
+	}
+	if (frameIndex == 0 || seconds > timing.m_maxSeconds)
+	{
+		timing.m_maxSeconds = seconds;
+	}
+}
+
+void App::ReportHeadlessTimings(int numFrames) const
+{
+	static char const* const PHASE_NAMES[NUM_APP_PHASES] = { "BeginFrame", "Update", "Render", "EndFrame" };
+
+	std::string report = Stringf("Headless run: %d frames, %d worker threads\n", numFrames, g_theJobSystem->GetNumWorkerThreads());
+	double totalFrameSeconds = 0.0;
+	for (int phaseIndex = 0; phaseIndex < NUM_APP_PHASES; ++phaseIndex)
+	{
+		AppPhaseTiming const& timing = m_phaseTimings[phaseIndex];
+		double averageSeconds = numFrames > 0 ? timing.m_totalSeconds / static_cast<double>(numFrames) : 0.0;
+		totalFrameSeconds += averageSeconds;
+		report += Stringf("  %-10s avg %8.3fms  min %8.3fms  max %8.3fms\n", PHASE_NAMES[phaseIndex],
+			averageSeconds * 1000.0, timing.m_minSeconds * 1000.0, timing.m_maxSeconds * 1000.0);
+	}
+	report += Stringf("  %-10s avg %8.3fms\n", "Frame", totalFrameSeconds * 1000.0);
+
+	RenderStats const& renderStats = m_theGame->GetLastFrameRenderStats();
+	report += Stringf("  Last frame: %d draws, %d vertexes, %d indexes, %d state changes issued, %d filtered, %d props occluded\n", renderStats.m_numDrawCalls,
+		renderStats.m_numVertexes, renderStats.m_numIndexes, renderStats.m_numStateChangesIssued, renderStats.m_numStateChangesFiltered, m_theGame->GetNumOccludedEntities());
+	report += Stringf("  Last frame: %zu bytes uploaded, %zu props drawn, %zu moving from shared meshes, %zu baked of which %zu rebaked\n", renderStats.m_numBytesUploaded,
+		m_theGame->GetNumDrawnInstances(), m_theGame->GetNumMovingInstances(), m_theGame->GetNumDrawnInstances() - m_theGame->GetNumMovingInstances(),
+		m_theGame->GetNumRebakedInstances());
+	report += Stringf("  Last frame: %d / %d / %d / %d visible props at LOD 0 / 1 / 2 / 3\n", m_theGame->GetNumEntitiesAtLod(0), m_theGame->GetNumEntitiesAtLod(1),
+		m_theGame->GetNumEntitiesAtLod(2), m_theGame->GetNumEntitiesAtLod(3));
+
+	CollisionStats const& collisionStats = m_theGame->GetCollisionStats();
+	double averageCollisionSeconds = collisionStats.m_numUpdates > 0 ? collisionStats.m_totalUpdateSeconds / static_cast<double>(collisionStats.m_numUpdates) : 0.0;
+	report += Stringf("  Collision: %d bodies (%d moving), avg %.3fms per step; last step %d candidate pairs, %d contacts\n", collisionStats.m_numBodies,
+		collisionStats.m_numDynamicBodies, averageCollisionSeconds * 1000.0, collisionStats.m_numCandidatePairs, collisionStats.m_numContacts);
+
+	DebuggerPrintf("%s", report.c_str());
+	if (!m_headlessReportPath.empty())
+	{
+		std::ofstream reportFile(m_headlessReportPath);
+		reportFile << report;
+	}
+}
+
 bool App::HandleQuitRequested(EventArgs& args)
 {
 	UNUSED(args);
 	g_theApp->m_isQuitting = true;
 	return true;
 }
+
+bool App::Command_SimulationRate(EventArgs& args)
+{
+	// Fixed step rate for the prop simulation, rendering is not affected
+	g_theApp->m_simulationHz = args.GetValue("hz", g_theApp->m_simulationHz);
+	m_theGame->SetSimulationRate(g_theApp->m_simulationHz);
+	return true;
+}
+
+bool App::Command_OcclusionCulling(EventArgs& args)
+{
+	// Occluders are still drawn either way; this only turns off the depth test against them
+	bool isEnabled = args.GetValue("enabled", true);
+	m_theGame->SetOcclusionCullingEnabled(isEnabled);
+	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, Stringf("OcclusionCulling: %s", isEnabled ? "on" : "off"));
+	return true;
+}
+
+bool App::Command_MeshLod(EventArgs& args)
+{
+	// With levels off every prop draws its full-detail mesh, for comparing cost and looks against the chosen levels
+	bool isEnabled = args.GetValue("enabled", true);
+	m_theGame->SetMeshLodEnabled(isEnabled);
+	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, Stringf("MeshLod: %s", isEnabled ? "on" : "off"));
+	return true;
+}
+
+bool App::Command_CollisionStress(EventArgs& args)
+{
+	// Adds moving props to the running scene to load the collision system
+	int numBodies = args.GetValue("count", 50000);
+	m_theGame->SpawnCollisionStressBodies(numBodies);
+	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, Stringf("CollisionStress: spawned %d moving props", numBodies));
+	return true;
+}
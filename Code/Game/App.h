@@ -2,7 +2,24 @@
 #include "Game/Game.h"
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Core/EventSystem.hpp"
-
+#include <string>
+// -----------------------------------------------------------------------------
+enum AppFramePhase
+{
+	APP_PHASE_BEGIN_FRAME,
+	APP_PHASE_UPDATE,
+	APP_PHASE_RENDER,
+	APP_PHASE_END_FRAME,
+	NUM_APP_PHASES
+};
+// -----------------------------------------------------------------------------
+struct AppPhaseTiming
+{
+	double m_totalSeconds = 0.0;
+	double m_minSeconds = 0.0;
+	double m_maxSeconds = 0.0;
+};
+// -----------------------------------------------------------------------------
 class App
 {
 public:
@@ -13,8 +30,18 @@ public:
 	void RunFrame();
 
 	void RunMainLoop();
+	void RunHeadless();
+	void RunBenchmark();
+	void ParseCommandLine(std::string const& commandLine);
 	bool IsQuitting() const { return m_isQuitting; }
+	bool IsHeadless() const { return m_isHeadless; }
+	bool IsBenchmark() const { return m_isBenchmark; }
+	int  GetExitCode() const { return m_exitCode; }
 	static bool HandleQuitRequested(EventArgs& args);
+	static bool Command_SimulationRate(EventArgs& args);
+	static bool Command_CollisionStress(EventArgs& args);
+	static bool Command_OcclusionCulling(EventArgs& args);
+	static bool Command_MeshLod(EventArgs& args);
 	
 private:
 	void BeginFrame();
@@ -23,8 +50,33 @@ private:
 	void EndFrame();
 
 	void SubscribeToEvents();
+	void RecordPhaseTime(AppFramePhase phase, double seconds, int frameIndex);
+	void ReportHeadlessTimings(int numFrames) const;
+	void StartInputRecordingOrReplay();
+	void StartGame();
+	BenchmarkResult MeasureBenchmarkScene(BenchmarkScene const& scene);
 
 private:
 	Game* m_game = nullptr;
 	bool  m_isQuitting = false;
+	int   m_exitCode = 0;
+
+	// Headless runs have no window or renderer; draws go to a null backend and input comes from a script
+	bool  m_isHeadless = false;
+	int   m_numHeadlessFrames = 600;
+	std::string m_headlessReportPath;
+	std::string m_headlessTracePath;
+	std::string m_occlusionDepthImagePath;
+	AppPhaseTiming m_phaseTimings[NUM_APP_PHASES];
+
+	float m_simulationHz = DEFAULT_SIMULATION_HZ;
+	int   m_numCollisionStressBodies = 0;
+
+	// Player input is recorded from the first frame and saved on shutdown, or replayed from a file in place of live input
+	std::string m_inputRecordPath;
+	std::string m_inputReplayPath;
+
+	// Benchmark runs are headless and measure a fresh game per scene of the scaling suite
+	bool  m_isBenchmark = false;
+	BenchmarkConfig m_benchmarkConfig;
 };
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "Game/Benchmark.hpp"
+#include "Game/DebugPrimitivePool.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/StringUtils.hpp"
+#include <fstream>
+#include <stdlib.h>
+#include <string.h>
+
+constexpr int BENCHMARK_FILE_VERSION = 2;
+constexpr int BENCHMARK_MIN_SCENE_SIZE = 10;
+constexpr int BENCHMARK_OCCLUDER_WALL_CUBES = BENCHMARK_OCCLUDER_WALL_WIDTH * BENCHMARK_OCCLUDER_WALL_HEIGHT;
+
+// Differences below these never count as regressions, so timer noise on the smallest scenes does not fail a run
+constexpr double BENCHMARK_TIMING_SLACK_MS = 0.05;
+constexpr double BENCHMARK_COUNT_SLACK = 0.5;
+
+static bool ReadJsonNumber(std::string const& line, char const* key, double& out_value)
+{
+	std::string quotedKey = Stringf("\"%s\":", key);
+	size_t keyPosition = line.find(quotedKey);
+	if (keyPosition == std::string::npos)
+	{
+		return false;
+	}
+	char const* valueStart = line.c_str() + keyPosition + quotedKey.size();
+	char* valueEnd = nullptr;
+	out_value = strtod(valueStart, &valueEnd);
+	return valueEnd != valueStart;
+}
+
+static bool ReadJsonString(std::string const& line, char const* key, std::string& out_value)
+{
+	std::string quotedKey = Stringf("\"%s\":\"", key);
+	size_t keyPosition = line.find(quotedKey);
+	if (keyPosition == std::string::npos)
+	{
+		return false;
+	}
+	size_t valueStart = keyPosition + quotedKey.size();
+	size_t valueEnd = line.find('"', valueStart);
+	if (valueEnd == std::string::npos)
+	{
+		return false;
+	}
+	out_value = line.substr(valueStart, valueEnd - valueStart);
+	return true;
+}
+
+static bool IsRegression(double baselineValue, double currentValue, double tolerance, double slack)
+{
+	return currentValue > baselineValue * (1.0 + tolerance) && currentValue - baselineValue > slack;
+}
+
+void BenchmarkReport::AddResult(BenchmarkResult const& result)
+{
+	m_results.push_back(result);
+}
+
+void BenchmarkReport::GetSummaryLines(std::vector<std::string>& out_lines) const
+{
+	out_lines.push_back(Stringf("  %-16s %10s %10s %10s %10s %8s %10s %10s %12s", "Scene", "Update", "Max", "Build", "Render", "Draws", "Occluded", "Allocs", "Arena bytes"));
+	for (size_t resultIndex = 0; resultIndex < m_results.size(); ++resultIndex)
+	{
+		BenchmarkResult const& result = m_results[resultIndex];
+		out_lines.push_back(Stringf("  %-16s %8.3fms %8.3fms %8.3fms %8.3fms %8.0f %10.0f %10.1f %12.0f", result.m_scene.m_name.c_str(), result.m_avgUpdateMs, result.m_maxUpdateMs,
+			result.m_avgBuildRenderCommandsMs, result.m_avgRenderMs, result.m_avgDrawCalls, result.m_avgOccludedProps, result.m_avgHeapAllocations, result.m_avgFrameArenaBytes));
+	}
+}
+
+bool BenchmarkReport::SaveToFile(std::string const& filePath, std::string& out_error) const
+{
+	std::ofstream resultsFile(filePath);
+	if (!resultsFile.is_open())
+	{
+		out_error = Stringf("could not write \"%s\"", filePath.c_str());
+		return false;
+	}
+
+	resultsFile << Stringf("{\"benchmark\":\"SceneScaling\",\"version\":%d,\"scenes\":[\n", BENCHMARK_FILE_VERSION);
+	for (size_t resultIndex = 0; resultIndex < m_results.size(); ++resultIndex)
+	{
+		BenchmarkResult const& result = m_results[resultIndex];
+		resultsFile << Stringf("{\"name\":\"%s\",\"cubes\":%d,\"spheres\":%d,\"debugPrimitives\":%d,\"occluders\":%d,\"frames\":%d,", result.m_scene.m_name.c_str(),
+			result.m_scene.m_numCubes, result.m_scene.m_numSpheres, result.m_scene.m_numDebugPrimitives, result.m_scene.m_numOccluders, result.m_numFrames);
+		resultsFile << Stringf("\"avgUpdateMs\":%.4f,\"maxUpdateMs\":%.4f,\"avgBuildRenderCommandsMs\":%.4f,\"avgRenderMs\":%.4f,", result.m_avgUpdateMs,
+			result.m_maxUpdateMs, result.m_avgBuildRenderCommandsMs, result.m_avgRenderMs);
+		resultsFile << Stringf("\"avgDrawCalls\":%.2f,\"avgOccludedProps\":%.2f,\"avgHeapAllocations\":%.2f,\"avgHeapBytes\":%.1f,\"avgFrameArenaBytes\":%.1f}",
+			result.m_avgDrawCalls, result.m_avgOccludedProps, result.m_avgHeapAllocations, result.m_avgHeapBytes, result.m_avgFrameArenaBytes);
+		resultsFile << (resultIndex + 1 < m_results.size() ? ",\n" : "\n");
+	}
+	resultsFile << "]}\n";
+	return resultsFile.good();
+}
+
+bool BenchmarkReport::LoadFromFile(std::string const& filePath, std::string& out_error)
+{
+	m_results.clear();
+
+	std::ifstream resultsFile(filePath);
+	if (!resultsFile.is_open())
+	{
+		out_error = Stringf("could not open \"%s\"", filePath.c_str());
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(resultsFile, line))
+	{
+		++lineNumber;
+		double version = 0.0;
+		if (lineNumber == 1)
+		{
+			if (!ReadJsonNumber(line, "version", version) || static_cast<int>(version) != BENCHMARK_FILE_VERSION)
+			{
+				out_error = Stringf("\"%s\" is not a version %d benchmark file", filePath.c_str(), BENCHMARK_FILE_VERSION);
+				return false;
+			}
+			continue;
+		}
+		if (line.find("\"name\":") == std::string::npos)
+		{
+			continue;
+		}
+
+		BenchmarkResult result;
+		double numCubes = 0.0;
+		double numSpheres = 0.0;
+		double numDebugPrimitives = 0.0;
+		double numOccluders = 0.0;
+		double numFrames = 0.0;
+		bool isValid = ReadJsonString(line, "name", result.m_scene.m_name)
+			&& ReadJsonNumber(line, "cubes", numCubes)
+			&& ReadJsonNumber(line, "spheres", numSpheres)
+			&& ReadJsonNumber(line, "debugPrimitives", numDebugPrimitives)
+			&& ReadJsonNumber(line, "occluders", numOccluders)
+			&& ReadJsonNumber(line, "frames", numFrames)
+			&& ReadJsonNumber(line, "avgUpdateMs", result.m_avgUpdateMs)
+			&& ReadJsonNumber(line, "maxUpdateMs", result.m_maxUpdateMs)
+			&& ReadJsonNumber(line, "avgBuildRenderCommandsMs", result.m_avgBuildRenderCommandsMs)
+			&& ReadJsonNumber(line, "avgRenderMs", result.m_avgRenderMs)
+			&& ReadJsonNumber(line, "avgDrawCalls", result.m_avgDrawCalls)
+			&& ReadJsonNumber(line, "avgOccludedProps", result.m_avgOccludedProps)
+			&& ReadJsonNumber(line, "avgHeapAllocations", result.m_avgHeapAllocations)
+			&& ReadJsonNumber(line, "avgHeapBytes", result.m_avgHeapBytes)
+			&& ReadJsonNumber(line, "avgFrameArenaBytes", result.m_avgFrameArenaBytes);
+		if (!isValid)
+		{
+			out_error = Stringf("line %d: missing or bad scene field", lineNumber);
+			m_results.clear();
+			return false;
+		}
+		result.m_scene.m_numCubes = static_cast<int>(numCubes);
+		result.m_scene.m_numSpheres = static_cast<int>(numSpheres);
+		result.m_scene.m_numDebugPrimitives = static_cast<int>(numDebugPrimitives);
+		result.m_scene.m_numOccluders = static_cast<int>(numOccluders);
+		result.m_numFrames = static_cast<int>(numFrames);
+		m_results.push_back(result);
+	}
+	return true;
+}
+
+int BenchmarkReport::CompareAgainstBaseline(BenchmarkReport const& baseline, double tolerance, std::vector<std::string>& out_lines) const
+{
+	struct ComparedMetric
+	{
+		char const* m_name;
+		double BenchmarkResult::* m_value;
+		double m_slack;
+	};
+	static ComparedMetric const COMPARED_METRICS[] =
+	{
+		{ "update ms", &BenchmarkResult::m_avgUpdateMs, BENCHMARK_TIMING_SLACK_MS },
+		{ "build ms", &BenchmarkResult::m_avgBuildRenderCommandsMs, BENCHMARK_TIMING_SLACK_MS },
+		{ "render ms", &BenchmarkResult::m_avgRenderMs, BENCHMARK_TIMING_SLACK_MS },
+		{ "draw calls", &BenchmarkResult::m_avgDrawCalls, BENCHMARK_COUNT_SLACK },
+		{ "heap allocations", &BenchmarkResult::m_avgHeapAllocations, BENCHMARK_COUNT_SLACK },
+	};
+
+	int numRegressions = 0;
+	for (size_t resultIndex = 0; resultIndex < m_results.size(); ++resultIndex)
+	{
+		BenchmarkResult const& result = m_results[resultIndex];
+		BenchmarkResult const* baselineResult = baseline.FindResult(result.m_scene.m_name);
+		if (baselineResult == nullptr)
+		{
+			out_lines.push_back(Stringf("  %-16s not in baseline", result.m_scene.m_name.c_str()));
+			continue;
+		}
+
+		for (ComparedMetric const& metric : COMPARED_METRICS)
+		{
+			double baselineValue = baselineResult->*metric.m_value;
+			double currentValue = result.*metric.m_value;
+			if (IsRegression(baselineValue, currentValue, tolerance, metric.m_slack))
+			{
+				out_lines.push_back(Stringf("  %-16s REGRESSION %s %.3f -> %.3f (+%.0f%%)", result.m_scene.m_name.c_str(), metric.m_name, baselineValue, currentValue,
+					baselineValue > 0.0 ? (currentValue / baselineValue - 1.0) * 100.0 : 100.0));
+				++numRegressions;
+			}
+		}
+	}
+	out_lines.push_back(Stringf("  %d regressions over %.0f%% against %d baseline scenes", numRegressions, tolerance * 100.0, static_cast<int>(baseline.m_results.size())));
+	return numRegressions;
+}
+
+std::vector<BenchmarkScene> BenchmarkReport::MakeSceneScalingSuite(int maxSceneSize)
+{
+	// Cubes alone, spheres alone, an even mix with as many debug spheres as the pool keeps alive, then the mix again behind an occluder wall, at every power of ten
+	std::vector<BenchmarkScene> scenes;
+	for (int sceneSize = BENCHMARK_MIN_SCENE_SIZE; sceneSize <= maxSceneSize; sceneSize *= 10)
+	{
+		BenchmarkScene cubes;
+		cubes.m_name = Stringf("cubes_%d", sceneSize);
+		cubes.m_numCubes = sceneSize;
+		scenes.push_back(cubes);
+
+		BenchmarkScene spheres;
+		spheres.m_name = Stringf("spheres_%d", sceneSize);
+		spheres.m_numSpheres = sceneSize;
+		scenes.push_back(spheres);
+
+		BenchmarkScene mixed;
+		mixed.m_name = Stringf("mixed_%d", sceneSize);
+		mixed.m_numCubes = sceneSize / 2;
+		mixed.m_numSpheres = sceneSize - sceneSize / 2;
+		mixed.m_numDebugPrimitives = sceneSize < DEBUG_PRIMITIVE_POOL_CAPACITY ? sceneSize : DEBUG_PRIMITIVE_POOL_CAPACITY;
+		scenes.push_back(mixed);
+
+		BenchmarkScene occluded;
+		occluded.m_name = Stringf("occluded_%d", sceneSize);
+		occluded.m_numCubes = sceneSize / 2;
+		occluded.m_numSpheres = sceneSize - sceneSize / 2;
+		occluded.m_numOccluders = BENCHMARK_OCCLUDER_WALL_CUBES;
+		scenes.push_back(occluded);
+
+		// Stop before the next power of ten could overflow
+		if (sceneSize > maxSceneSize / 10)
+		{
+			break;
+		}
+	}
+	return scenes;
+}
+
+BenchmarkResult const* BenchmarkReport::FindResult(std::string const& sceneName) const
+{
+	for (size_t resultIndex = 0; resultIndex < m_results.size(); ++resultIndex)
+	{
+		if (m_results[resultIndex].m_scene.m_name == sceneName)
+		{
+			return &m_results[resultIndex];
+		}
+	}
+	return nullptr;
+}
\ No newline at end of file
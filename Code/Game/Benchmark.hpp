@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int BENCHMARK_OCCLUDER_WALL_WIDTH = 24;
+constexpr int BENCHMARK_OCCLUDER_WALL_HEIGHT = 6;
+// -----------------------------------------------------------------------------
+struct BenchmarkScene
+{
+	std::string m_name;
+	int m_numCubes = 0;
+	int m_numSpheres = 0;
+	int m_numDebugPrimitives = 0;
+	int m_numOccluders = 0;		// Cubes in a wall across the view, flagged as occluders
+};
+// -----------------------------------------------------------------------------
+// Per-frame averages over the measured frames of one scene
+// -----------------------------------------------------------------------------
+struct BenchmarkResult
+{
+	BenchmarkScene m_scene;
+	int m_numFrames = 0;
+	double m_avgUpdateMs = 0.0;
+	double m_maxUpdateMs = 0.0;
+	double m_avgBuildRenderCommandsMs = 0.0;
+	double m_avgRenderMs = 0.0;
+	double m_avgDrawCalls = 0.0;
+	double m_avgOccludedProps = 0.0;
+	double m_avgHeapAllocations = 0.0;
+	double m_avgHeapBytes = 0.0;
+	double m_avgFrameArenaBytes = 0.0;
+};
+// -----------------------------------------------------------------------------
+struct BenchmarkConfig
+{
+	int m_maxSceneSize = 1000000;
+	int m_numWarmupFrames = 10;
+	int m_numMeasuredFrames = 60;
+	std::string m_resultsPath = "BenchmarkResults.json";
+	std::string m_baselinePath;
+	double m_regressionTolerance = 0.2;		// Fraction a metric may grow over the baseline before it counts as a regression
+};
+// -----------------------------------------------------------------------------
+// Results of a benchmark run and their JSON form. Files are written one scene
+// per line so LoadFromFile only has to read back what SaveToFile writes, which
+// is how a stored baseline is read for CompareAgainstBaseline.
+// -----------------------------------------------------------------------------
+class BenchmarkReport
+{
+public:
+	void AddResult(BenchmarkResult const& result);
+	std::vector<BenchmarkResult> const& GetResults() const { return m_results; }
+	void GetSummaryLines(std::vector<std::string>& out_lines) const;
+
+	bool SaveToFile(std::string const& filePath, std::string& out_error) const;
+	bool LoadFromFile(std::string const& filePath, std::string& out_error);
+	int CompareAgainstBaseline(BenchmarkReport const& baseline, double tolerance, std::vector<std::string>& out_lines) const;
+
+	static std::vector<BenchmarkScene> MakeSceneScalingSuite(int maxSceneSize);
+
+private:
+	BenchmarkResult const* FindResult(std::string const& sceneName) const;
+
+	std::vector<BenchmarkResult> m_results;
+};
\ No newline at end of file
@@ -0,0 +1,510 @@
+#include "Game/CollisionSystem.hpp"
+#include "Game/MeshCache.hpp"
+#include "Game/SpatialGrid.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/GameCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Core/Time.hpp"
+#include <math.h>
+
+// Rows of neighbour cells (y, z offsets) that come after the current cell's row, so each pair of neighbouring cells is only visited once
+static const int FORWARD_NEIGHBOR_ROWS[4][2] =
+{
+	{ 1, 0 },
+	{-1, 1 }, { 0, 1 }, { 1, 1 },
+};
+
+// Large enough for tens of thousands of bodies spread over the grid area; the cell size grows instead of exceeding it
+static const int MAX_BROAD_PHASE_CELLS = 1 << 20;
+
+static Vec3 GetNearestPointOnSegment(Vec3 const& segmentStart, Vec3 const& segmentEnd, Vec3 const& point)
+{
+	Vec3 segment = segmentEnd - segmentStart;
+	float segmentLengthSquared = segment.GetLengthSquared();
+	if (segmentLengthSquared <= 0.f)
+	{
+		return segmentStart;
+	}
+	float fraction = GetClamped(DotProduct3D(point - segmentStart, segment) / segmentLengthSquared, 0.f, 1.f);
+	return segmentStart + segment * fraction;
+}
+
+static Vec3 GetNearestPointOnBox(Vec3 const& boxCenter, Vec3 const& boxHalfExtents, Vec3 const& point)
+{
+	return Vec3(GetClamped(point.x, boxCenter.x - boxHalfExtents.x, boxCenter.x + boxHalfExtents.x),
+		GetClamped(point.y, boxCenter.y - boxHalfExtents.y, boxCenter.y + boxHalfExtents.y),
+		GetClamped(point.z, boxCenter.z - boxHalfExtents.z, boxCenter.z + boxHalfExtents.z));
+}
+
+static bool ComputeBoxVsBoxContact(Vec3 const& centerA, Vec3 const& halfExtentsA, Vec3 const& centerB, Vec3 const& halfExtentsB, Vec3& out_normal, float& out_depth)
+{
+	// Separate along whichever axis overlaps least
+	Vec3 displacement = centerB - centerA;
+	float overlapX = halfExtentsA.x + halfExtentsB.x - fabsf(displacement.x);
+	float overlapY = halfExtentsA.y + halfExtentsB.y - fabsf(displacement.y);
+	float overlapZ = halfExtentsA.z + halfExtentsB.z - fabsf(displacement.z);
+	if (overlapX <= 0.f || overlapY <= 0.f || overlapZ <= 0.f)
+	{
+		return false;
+	}
+
+	if (overlapX <= overlapY && overlapX <= overlapZ)
+	{
+		out_normal = Vec3(displacement.x >= 0.f ? 1.f : -1.f, 0.f, 0.f);
+		out_depth = overlapX;
+	}
+	else if (overlapY <= overlapZ)
+	{
+		out_normal = Vec3(0.f, displacement.y >= 0.f ? 1.f : -1.f, 0.f);
+		out_depth = overlapY;
+	}
+	else
+	{
+		out_normal = Vec3(0.f, 0.f, displacement.z >= 0.f ? 1.f : -1.f);
+		out_depth = overlapZ;
+	}
+	return true;
+}
+
+static bool ComputeSphereVsSphereContact(Vec3 const& centerA, float radiusA, Vec3 const& centerB, float radiusB, Vec3& out_normal, float& out_depth)
+{
+	Vec3 displacement = centerB - centerA;
+	float distanceSquared = displacement.GetLengthSquared();
+	float radiusSum = radiusA + radiusB;
+	if (distanceSquared >= radiusSum * radiusSum)
+	{
+		return false;
+	}
+
+	float distance = sqrtf(distanceSquared);
+	out_normal = distance > 0.0001f ? displacement / distance : Vec3::ZAXE;
+	out_depth = radiusSum - distance;
+	return true;
+}
+
+static bool ComputeSphereVsBoxContact(Vec3 const& sphereCenter, float sphereRadius, Vec3 const& boxCenter, Vec3 const& boxHalfExtents, Vec3& out_normal, float& out_depth)
+{
+	Vec3 nearestPoint = GetNearestPointOnBox(boxCenter, boxHalfExtents, sphereCenter);
+	Vec3 displacement = nearestPoint - sphereCenter;
+	float distanceSquared = displacement.GetLengthSquared();
+	if (distanceSquared >= sphereRadius * sphereRadius)
+	{
+		return false;
+	}
+	if (distanceSquared <= 0.00000001f)
+	{
+		// Center is inside the box, so there is no nearest surface point to push along; treat the sphere as its bounding box
+		return ComputeBoxVsBoxContact(sphereCenter, Vec3(sphereRadius, sphereRadius, sphereRadius), boxCenter, boxHalfExtents, out_normal, out_depth);
+	}
+
+	float distance = sqrtf(distanceSquared);
+	out_normal = displacement / distance;
+	out_depth = sphereRadius - distance;
+	return true;
+}
+
+static bool ComputeShapeContact(CollisionShape shapeA, Vec3 const& centerA, Vec3 const& halfExtentsA, CollisionShape shapeB, Vec3 const& centerB, Vec3 const& halfExtentsB,
+	Vec3& out_normal, float& out_depth)
+{
+	// Spheres keep their radius in every half extent
+	if (shapeA == CollisionShape::SPHERE && shapeB == CollisionShape::SPHERE)
+	{
+		return ComputeSphereVsSphereContact(centerA, halfExtentsA.x, centerB, halfExtentsB.x, out_normal, out_depth);
+	}
+	if (shapeA == CollisionShape::SPHERE)
+	{
+		return ComputeSphereVsBoxContact(centerA, halfExtentsA.x, centerB, halfExtentsB, out_normal, out_depth);
+	}
+	if (shapeB == CollisionShape::SPHERE)
+	{
+		bool isTouching = ComputeSphereVsBoxContact(centerB, halfExtentsB.x, centerA, halfExtentsA, out_normal, out_depth);
+		out_normal = -out_normal;
+		return isTouching;
+	}
+	return ComputeBoxVsBoxContact(centerA, halfExtentsA, centerB, halfExtentsB, out_normal, out_depth);
+}
+
+CollisionSystem::CollisionSystem()
+{
+}
+
+CollisionSystem::~CollisionSystem()
+{
+}
+
+void CollisionSystem::Initialize(CollisionSystemConfig const& config)
+{
+	m_config = config;
+}
+
+void CollisionSystem::Update(EntityStore& entities, MeshCache const& meshCache)
+{
+	PROFILE_SCOPE("CollisionSystem::Update");
+	double startTime = GetCurrentTimeSeconds();
+
+	// Positions written here are picked up by the world transform update that follows
+	UpdateMeshShapes(meshCache);
+	GatherBodies(entities);
+	BuildBroadPhaseGrid();
+	FindContacts();
+	ResolveContacts(entities);
+	ApplyDynamicBounds(entities);
+
+	m_stats.m_lastUpdateSeconds = GetCurrentTimeSeconds() - startTime;
+	m_stats.m_totalUpdateSeconds += m_stats.m_lastUpdateSeconds;
+	++m_stats.m_numUpdates;
+}
+
+bool CollisionSystem::ResolveCapsule(EntityStore const& entities, SpatialGrid const& spatialGrid, CollisionCapsule& capsule) const
+{
+	bool didCollide = false;
+
+	// Keep the whole capsule above the ground plane
+	float groundHeight = m_config.m_dynamicBounds.m_mins.z;
+	float lowestHeight = fminf(capsule.m_start.z, capsule.m_end.z) - capsule.m_radius;
+	if (lowestHeight < groundHeight)
+	{
+		Vec3 pushOut(0.f, 0.f, groundHeight - lowestHeight);
+		capsule.m_start += pushOut;
+		capsule.m_end += pushOut;
+		didCollide = true;
+	}
+
+	Vec3 radiusExtents(capsule.m_radius, capsule.m_radius, capsule.m_radius);
+	AABB3 capsuleBounds(Vec3(fminf(capsule.m_start.x, capsule.m_end.x), fminf(capsule.m_start.y, capsule.m_end.y), fminf(capsule.m_start.z, capsule.m_end.z)) - radiusExtents,
+		Vec3(fmaxf(capsule.m_start.x, capsule.m_end.x), fmaxf(capsule.m_start.y, capsule.m_end.y), fmaxf(capsule.m_start.z, capsule.m_end.z)) + radiusExtents);
+	m_capsuleCandidates.clear();
+	spatialGrid.FindOverlappingAABB(entities, capsuleBounds, m_capsuleCandidates);
+
+	for (size_t candidateIndex = 0; candidateIndex < m_capsuleCandidates.size(); ++candidateIndex)
+	{
+		int entityIndex = entities.GetIndex(m_capsuleCandidates[candidateIndex]);
+		int meshID = entities.m_meshIDs[entityIndex];
+		if (meshID < 0 || meshID >= static_cast<int>(m_meshShapes.size()))
+		{
+			continue;
+		}
+
+		// Test the prop against the sphere at the point of the capsule's segment nearest to it
+		CollisionShape shape = m_meshShapes[meshID];
+		Vec3 center(entities.m_boundsCentersX[entityIndex], entities.m_boundsCentersY[entityIndex], entities.m_boundsCentersZ[entityIndex]);
+		Vec3 halfExtents = shape == CollisionShape::SPHERE ? m_meshHalfExtents[meshID] : GetWorldHalfExtents(entities, entityIndex);
+		Vec3 segmentPoint = GetNearestPointOnSegment(capsule.m_start, capsule.m_end, center);
+		if (shape == CollisionShape::BOX)
+		{
+			segmentPoint = GetNearestPointOnSegment(capsule.m_start, capsule.m_end, GetNearestPointOnBox(center, halfExtents, segmentPoint));
+		}
+
+		Vec3 normal;
+		float depth = 0.f;
+		if (ComputeShapeContact(CollisionShape::SPHERE, segmentPoint, radiusExtents, shape, center, halfExtents, normal, depth))
+		{
+			capsule.m_start -= normal * depth;
+			capsule.m_end -= normal * depth;
+			didCollide = true;
+		}
+	}
+	return didCollide;
+}
+
+CollisionStats const& CollisionSystem::GetStats() const
+{
+	return m_stats;
+}
+
+void CollisionSystem::UpdateMeshShapes(MeshCache const& meshCache)
+{
+	int numMeshes = meshCache.GetNumMeshes();
+	for (int meshID = static_cast<int>(m_meshShapes.size()); meshID < numMeshes; ++meshID)
+	{
+		Mesh const& mesh = meshCache.GetMesh(meshID);
+		if (mesh.m_key.m_shape == MeshShape::SPHERE)
+		{
+			m_meshShapes.push_back(CollisionShape::SPHERE);
+			m_meshHalfExtents.push_back(Vec3(mesh.m_boundingRadius, mesh.m_boundingRadius, mesh.m_boundingRadius));
+		}
+		else
+		{
+			m_meshShapes.push_back(CollisionShape::BOX);
+			m_meshHalfExtents.push_back((mesh.m_bounds.m_maxs - mesh.m_bounds.m_mins) * 0.5f);
+		}
+	}
+}
+
+void CollisionSystem::GatherBodies(EntityStore const& entities)
+{
+	m_gatheredBodies.clear();
+	m_stats.m_numDynamicBodies = 0;
+	m_stats.m_numCandidatePairs = 0;
+	m_stats.m_numContacts = 0;
+
+	// Children ride on their parents, so only roots take part. Their local position is their world position and is already
+	// this step's; box rotations come from the last world transform, a step behind, which is close enough for contacts
+	int numEntities = entities.GetNumEntities();
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex)
+	{
+		int meshID = entities.m_meshIDs[entityIndex];
+		if (meshID < 0 || meshID >= static_cast<int>(m_meshShapes.size()) || !entities.IsRoot(entityIndex))
+		{
+			continue;
+		}
+
+		Vec3 const& linearVelocity = entities.m_linearVelocities[entityIndex];
+		bool isDynamic = linearVelocity.x != 0.f || linearVelocity.y != 0.f || linearVelocity.z != 0.f;
+		CollisionBody body;
+		body.m_shape = m_meshShapes[meshID];
+		body.m_center = entities.m_positions[entityIndex];
+		body.m_halfExtents = body.m_shape == CollisionShape::SPHERE ? m_meshHalfExtents[meshID] : GetWorldHalfExtents(entities, entityIndex);
+		body.m_inverseMass = isDynamic ? 1.f : 0.f;
+		body.m_entityIndex = entityIndex;
+		m_gatheredBodies.push_back(body);
+		m_stats.m_numDynamicBodies += isDynamic ? 1 : 0;
+	}
+	m_stats.m_numBodies = static_cast<int>(m_gatheredBodies.size());
+}
+
+void CollisionSystem::BuildBroadPhaseGrid()
+{
+	int numBodies = m_stats.m_numBodies;
+	m_bodies.resize(static_cast<size_t>(numBodies));
+	if (numBodies == 0)
+	{
+		m_cellStarts.assign(1, 0);
+		m_numCellsX = m_numCellsY = m_numCellsZ = 0;
+		return;
+	}
+
+	// Cells at least as wide as the largest body mean any two touching bodies are in the same or adjacent cells
+	Vec3 gridMins = m_gatheredBodies[0].m_center;
+	Vec3 gridMaxs = m_gatheredBodies[0].m_center;
+	float maxExtent = 0.f;
+	for (int bodyIndex = 0; bodyIndex < numBodies; ++bodyIndex)
+	{
+		Vec3 const& center = m_gatheredBodies[bodyIndex].m_center;
+		Vec3 const& halfExtents = m_gatheredBodies[bodyIndex].m_halfExtents;
+		gridMins = Vec3(fminf(gridMins.x, center.x), fminf(gridMins.y, center.y), fminf(gridMins.z, center.z));
+		gridMaxs = Vec3(fmaxf(gridMaxs.x, center.x), fmaxf(gridMaxs.y, center.y), fmaxf(gridMaxs.z, center.z));
+		maxExtent = fmaxf(maxExtent, 2.f * fmaxf(halfExtents.x, fmaxf(halfExtents.y, halfExtents.z)));
+	}
+
+	m_gridMins = gridMins;
+	m_cellSize = fmaxf(maxExtent, 0.01f);
+	Vec3 gridSize = gridMaxs - gridMins;
+	for (;;)
+	{
+		m_numCellsX = static_cast<int>(gridSize.x / m_cellSize) + 1;
+		m_numCellsY = static_cast<int>(gridSize.y / m_cellSize) + 1;
+		m_numCellsZ = static_cast<int>(gridSize.z / m_cellSize) + 1;
+		if (static_cast<long long>(m_numCellsX) * m_numCellsY * m_numCellsZ <= MAX_BROAD_PHASE_CELLS)
+		{
+			break;
+		}
+		m_cellSize *= 1.5f;
+	}
+
+	// Counting sort of the bodies by cell; m_cellStarts first holds counts, then the end of each cell, then its start
+	int numCells = m_numCellsX * m_numCellsY * m_numCellsZ;
+	m_cellStarts.assign(static_cast<size_t>(numCells + 1), 0);
+	for (int bodyIndex = 0; bodyIndex < numBodies; ++bodyIndex)
+	{
+		CollisionBody& body = m_gatheredBodies[bodyIndex];
+		body.m_cell = GetCellCoord(body.m_center.x, m_gridMins.x, m_numCellsX) + m_numCellsX * (GetCellCoord(body.m_center.y, m_gridMins.y, m_numCellsY)
+			+ m_numCellsY * GetCellCoord(body.m_center.z, m_gridMins.z, m_numCellsZ));
+		++m_cellStarts[body.m_cell + 1];
+	}
+	for (int cell = 0; cell < numCells; ++cell)
+	{
+		m_cellStarts[cell + 1] += m_cellStarts[cell];
+	}
+	for (int bodyIndex = 0; bodyIndex < numBodies; ++bodyIndex)
+	{
+		CollisionBody const& body = m_gatheredBodies[bodyIndex];
+		m_bodies[m_cellStarts[body.m_cell]++] = body;
+	}
+	for (int cell = numCells; cell > 0; --cell)
+	{
+		m_cellStarts[cell] = m_cellStarts[cell - 1];
+	}
+	m_cellStarts[0] = 0;
+}
+
+void CollisionSystem::FindContacts()
+{
+	// Each range of bodies gathers its own contacts; ranges are fixed by body index so joining them keeps a stable order
+	constexpr int BODIES_PER_CONTACT_RANGE = 2048;
+	int numBodies = m_stats.m_numBodies;
+	m_contactRanges.resize(static_cast<size_t>((numBodies + BODIES_PER_CONTACT_RANGE - 1) / BODIES_PER_CONTACT_RANGE));
+	g_theJobSystem->ParallelFor(numBodies, BODIES_PER_CONTACT_RANGE, [this](int beginIndex, int endIndex)
+		{
+			for (int rangeBegin = beginIndex; rangeBegin < endIndex; rangeBegin += BODIES_PER_CONTACT_RANGE)
+			{
+				int rangeEnd = rangeBegin + BODIES_PER_CONTACT_RANGE < endIndex ? rangeBegin + BODIES_PER_CONTACT_RANGE : endIndex;
+				FindContactsForBodies(rangeBegin, rangeEnd, m_contactRanges[rangeBegin / BODIES_PER_CONTACT_RANGE]);
+			}
+		});
+
+	m_contacts.clear();
+	for (size_t rangeIndex = 0; rangeIndex < m_contactRanges.size(); ++rangeIndex)
+	{
+		ContactRange const& range = m_contactRanges[rangeIndex];
+		m_contacts.insert(m_contacts.end(), range.m_contacts.begin(), range.m_contacts.end());
+		m_stats.m_numCandidatePairs += range.m_numCandidatePairs;
+	}
+	m_stats.m_numContacts = static_cast<int>(m_contacts.size());
+}
+
+void CollisionSystem::FindContactsForBodies(int firstBodyA, int endBodyA, ContactRange& out_range) const
+{
+	out_range.m_contacts.clear();
+	out_range.m_numCandidatePairs = 0;
+	int numCellsXY = m_numCellsX * m_numCellsY;
+	for (int bodyA = firstBodyA; bodyA < endBodyA; ++bodyA)
+	{
+		int cell = m_bodies[bodyA].m_cell;
+		int cellX = cell % m_numCellsX;
+		int cellY = (cell / m_numCellsX) % m_numCellsY;
+		int cellZ = cell / numCellsXY;
+
+		// Later bodies in the same cell and the cell after it in the row, then the three-cell rows ahead
+		int rowEndCell = cellX + 1 < m_numCellsX ? cell + 1 : cell;
+		TestBodyAgainstBodies(bodyA, bodyA + 1, m_cellStarts[rowEndCell + 1], out_range);
+		for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+		{
+			TestBodyAgainstRow(bodyA, cellX, cellY + FORWARD_NEIGHBOR_ROWS[rowIndex][0], cellZ + FORWARD_NEIGHBOR_ROWS[rowIndex][1], out_range);
+		}
+	}
+}
+
+void CollisionSystem::TestBodyAgainstRow(int bodyA, int cellX, int rowY, int rowZ, ContactRange& out_range) const
+{
+	if (rowY < 0 || rowY >= m_numCellsY || rowZ >= m_numCellsZ)
+	{
+		return;
+	}
+
+	int rowStartCell = m_numCellsX * (rowY + m_numCellsY * rowZ);
+	int firstCell = rowStartCell + (cellX > 0 ? cellX - 1 : cellX);
+	int lastCell = rowStartCell + (cellX + 1 < m_numCellsX ? cellX + 1 : cellX);
+	TestBodyAgainstBodies(bodyA, m_cellStarts[firstCell], m_cellStarts[lastCell + 1], out_range);
+}
+
+void CollisionSystem::TestBodyAgainstBodies(int bodyA, int firstBodyB, int endBodyB, ContactRange& out_range) const
+{
+	CollisionBody const& a = m_bodies[bodyA];
+	for (int bodyB = firstBodyB; bodyB < endBodyB; ++bodyB)
+	{
+		CollisionBody const& b = m_bodies[bodyB];
+		if (a.m_inverseMass == 0.f && b.m_inverseMass == 0.f)
+		{
+			continue;
+		}
+
+		// Bounding box rejection before the shape test
+		if (fabsf(b.m_center.x - a.m_center.x) >= a.m_halfExtents.x + b.m_halfExtents.x || fabsf(b.m_center.y - a.m_center.y) >= a.m_halfExtents.y + b.m_halfExtents.y
+			|| fabsf(b.m_center.z - a.m_center.z) >= a.m_halfExtents.z + b.m_halfExtents.z)
+		{
+			continue;
+		}
+		++out_range.m_numCandidatePairs;
+
+		CollisionContact contact;
+		if (ComputeShapeContact(a.m_shape, a.m_center, a.m_halfExtents, b.m_shape, b.m_center, b.m_halfExtents, contact.m_normal, contact.m_depth))
+		{
+			contact.m_bodyA = bodyA;
+			contact.m_bodyB = bodyB;
+			out_range.m_contacts.push_back(contact);
+		}
+	}
+}
+
+void CollisionSystem::ResolveContacts(EntityStore& entities)
+{
+	// One pass in a fixed order: separate the pair, then exchange the approaching part of their velocities
+	for (size_t contactIndex = 0; contactIndex < m_contacts.size(); ++contactIndex)
+	{
+		CollisionContact const& contact = m_contacts[contactIndex];
+		CollisionBody const& bodyA = m_bodies[contact.m_bodyA];
+		CollisionBody const& bodyB = m_bodies[contact.m_bodyB];
+		float inverseMassSum = bodyA.m_inverseMass + bodyB.m_inverseMass;
+
+		Vec3 correction = contact.m_normal * (contact.m_depth / inverseMassSum);
+		if (bodyA.m_inverseMass > 0.f)
+		{
+			entities.m_positions[bodyA.m_entityIndex] -= correction * bodyA.m_inverseMass;
+			entities.MarkTransformDirty(bodyA.m_entityIndex);
+		}
+		if (bodyB.m_inverseMass > 0.f)
+		{
+			entities.m_positions[bodyB.m_entityIndex] += correction * bodyB.m_inverseMass;
+			entities.MarkTransformDirty(bodyB.m_entityIndex);
+		}
+
+		Vec3& velocityA = entities.m_linearVelocities[bodyA.m_entityIndex];
+		Vec3& velocityB = entities.m_linearVelocities[bodyB.m_entityIndex];
+		float approachSpeed = DotProduct3D(velocityB - velocityA, contact.m_normal);
+		if (approachSpeed < 0.f)
+		{
+			float impulse = -(1.f + m_config.m_restitution) * approachSpeed / inverseMassSum;
+			velocityA -= contact.m_normal * (impulse * bodyA.m_inverseMass);
+			velocityB += contact.m_normal * (impulse * bodyB.m_inverseMass);
+		}
+	}
+}
+
+void CollisionSystem::ApplyDynamicBounds(EntityStore& entities)
+{
+	AABB3 const& bounds = m_config.m_dynamicBounds;
+	float restitution = m_config.m_restitution;
+	for (size_t bodyIndex = 0; bodyIndex < m_bodies.size(); ++bodyIndex)
+	{
+		CollisionBody const& body = m_bodies[bodyIndex];
+		if (body.m_inverseMass == 0.f)
+		{
+			continue;
+		}
+
+		Vec3& position = entities.m_positions[body.m_entityIndex];
+		Vec3& velocity = entities.m_linearVelocities[body.m_entityIndex];
+		Vec3 positionMins = bounds.m_mins + body.m_halfExtents;
+		Vec3 positionMaxs = bounds.m_maxs - body.m_halfExtents;
+		Vec3 clampedPosition(GetClamped(position.x, positionMins.x, positionMaxs.x), GetClamped(position.y, positionMins.y, positionMaxs.y),
+			GetClamped(position.z, positionMins.z, positionMaxs.z));
+		if (clampedPosition == position)
+		{
+			continue;
+		}
+
+		// Bounce off whichever walls were crossed
+		if (clampedPosition.x != position.x)
+		{
+			velocity.x = clampedPosition.x > position.x ? fabsf(velocity.x) * restitution : -fabsf(velocity.x) * restitution;
+		}
+		if (clampedPosition.y != position.y)
+		{
+			velocity.y = clampedPosition.y > position.y ? fabsf(velocity.y) * restitution : -fabsf(velocity.y) * restitution;
+		}
+		if (clampedPosition.z != position.z)
+		{
+			velocity.z = clampedPosition.z > position.z ? fabsf(velocity.z) * restitution : -fabsf(velocity.z) * restitution;
+		}
+		position = clampedPosition;
+		entities.MarkTransformDirty(body.m_entityIndex);
+	}
+}
+
+Vec3 CollisionSystem::GetWorldHalfExtents(EntityStore const& entities, int entityIndex) const
+{
+	// Half extents of the world AABB around the rotated mesh bounds: each axis sums the basis vectors' reach along it
+	Vec3 const& localHalfExtents = m_meshHalfExtents[entities.m_meshIDs[entityIndex]];
+	float const* values = entities.m_worldTransforms[entityIndex].m_values;
+	return Vec3(fabsf(values[Mat44::Ix]) * localHalfExtents.x + fabsf(values[Mat44::Jx]) * localHalfExtents.y + fabsf(values[Mat44::Kx]) * localHalfExtents.z,
+		fabsf(values[Mat44::Iy]) * localHalfExtents.x + fabsf(values[Mat44::Jy]) * localHalfExtents.y + fabsf(values[Mat44::Ky]) * localHalfExtents.z,
+		fabsf(values[Mat44::Iz]) * localHalfExtents.x + fabsf(values[Mat44::Jz]) * localHalfExtents.y + fabsf(values[Mat44::Kz]) * localHalfExtents.z);
+}
+
+int CollisionSystem::GetCellCoord(float value, float gridMin, int numCells) const
+{
+	int cellCoord = static_cast<int>((value - gridMin) / m_cellSize);
+	return GetClamped(cellCoord, 0, numCells - 1);
+}
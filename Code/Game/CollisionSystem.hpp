@@ -0,0 +1,125 @@
+#pragma once
+#include "Game/EntityStore.hpp"
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/AABB3.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+class MeshCache;
+class SpatialGrid;
+// -----------------------------------------------------------------------------
+enum class CollisionShape
+{
+	SPHERE,
+	BOX,
+	COUNT
+};
+// -----------------------------------------------------------------------------
+struct CollisionCapsule
+{
+	Vec3 m_start;	// Centers of the two end caps
+	Vec3 m_end;
+	float m_radius = 0.f;
+};
+// -----------------------------------------------------------------------------
+struct CollisionStats
+{
+	int m_numBodies = 0;
+	int m_numDynamicBodies = 0;
+	int m_numCandidatePairs = 0;
+	int m_numContacts = 0;
+	double m_lastUpdateSeconds = 0.0;
+	double m_totalUpdateSeconds = 0.0;
+	int m_numUpdates = 0;
+};
+// -----------------------------------------------------------------------------
+struct CollisionSystemConfig
+{
+	AABB3 m_dynamicBounds = AABB3(-50.f, -50.f, 0.f, 50.f, 50.f, 20.f);	// Moving props bounce off these walls; the floor is the ground plane
+	float m_restitution = 0.8f;
+};
+// -----------------------------------------------------------------------------
+// Contact detection and response for root entities. Props with a linear
+// velocity are dynamic, everything else is static and only pushes back.
+//
+// The broad phase is a uniform 3D grid rebuilt every step with a counting sort,
+// with cells as large as the biggest body so each body only has to be tested
+// against its own cell and the 13 neighbours that come after it. Bodies are
+// stored in cell order, so those neighbours are four contiguous rows of three
+// cells plus the rest of the body's own row. The search is split across the
+// job system in fixed body ranges and the results joined in range order, so
+// contacts resolve in the same order on any number of threads. Boxes are
+// collided as the world AABB around their rotated mesh bounds. The player is
+// not a body; it pushes its capsule out of props through ResolveCapsule.
+// -----------------------------------------------------------------------------
+class CollisionSystem
+{
+public:
+	CollisionSystem();
+	~CollisionSystem();
+
+	void Initialize(CollisionSystemConfig const& config);
+	void Update(EntityStore& entities, MeshCache const& meshCache);
+	bool ResolveCapsule(EntityStore const& entities, SpatialGrid const& spatialGrid, CollisionCapsule& capsule) const;
+	CollisionStats const& GetStats() const;
+
+private:
+	void UpdateMeshShapes(MeshCache const& meshCache);
+	void GatherBodies(EntityStore const& entities);
+	void BuildBroadPhaseGrid();
+	void FindContacts();
+	void ResolveContacts(EntityStore& entities);
+	void ApplyDynamicBounds(EntityStore& entities);
+	Vec3 GetWorldHalfExtents(EntityStore const& entities, int entityIndex) const;
+	int  GetCellCoord(float value, float gridMin, int numCells) const;
+
+private:
+	struct CollisionBody
+	{
+		Vec3 m_center;
+		Vec3 m_halfExtents;	// Sphere radius on every axis for spheres
+		float m_inverseMass = 0.f;
+		int m_entityIndex = 0;
+		int m_cell = 0;
+		CollisionShape m_shape = CollisionShape::SPHERE;
+	};
+
+	struct CollisionContact
+	{
+		int m_bodyA = 0;
+		int m_bodyB = 0;
+		Vec3 m_normal;	// Points from A to B
+		float m_depth = 0.f;
+	};
+
+	struct ContactRange
+	{
+		std::vector<CollisionContact> m_contacts;
+		int m_numCandidatePairs = 0;
+	};
+
+	void FindContactsForBodies(int firstBodyA, int endBodyA, ContactRange& out_range) const;
+	void TestBodyAgainstRow(int bodyA, int cellX, int rowY, int rowZ, ContactRange& out_range) const;
+	void TestBodyAgainstBodies(int bodyA, int firstBodyB, int endBodyB, ContactRange& out_range) const;
+
+	CollisionSystemConfig m_config;
+	CollisionStats m_stats;
+
+	// Indexed by mesh ID, refreshed when the cache grows
+	std::vector<CollisionShape>	m_meshShapes;
+	std::vector<Vec3>			m_meshHalfExtents;
+
+	// Bodies in entity order as gathered, then the same bodies grouped by cell; the bodies in a cell start at m_cellStarts[cell]
+	std::vector<CollisionBody>	m_gatheredBodies;
+	std::vector<CollisionBody>	m_bodies;
+
+	Vec3 m_gridMins;
+	float m_cellSize = 1.f;
+	int m_numCellsX = 0;
+	int m_numCellsY = 0;
+	int m_numCellsZ = 0;
+	std::vector<int>			m_cellStarts;
+
+	std::vector<ContactRange>	m_contactRanges;
+	std::vector<CollisionContact> m_contacts;
+	mutable std::vector<EntityHandle> m_capsuleCandidates;
+};
\ No newline at end of file
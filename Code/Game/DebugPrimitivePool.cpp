@@ -0,0 +1,259 @@
+#include "Game/DebugPrimitivePool.hpp"
+#include "Game/GameCommon.h"
+#include "Game/IndexedVertexUtils.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/RenderStateTracker.hpp"
+#include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <float.h>
+
+DebugPrimitivePool::DebugPrimitivePool()
+{
+}
+
+DebugPrimitivePool::~DebugPrimitivePool()
+{
+	Shutdown();
+}
+
+void DebugPrimitivePool::Startup(bool createGPUBuffers)
+{
+	m_hasGPUBuffers = createGPUBuffers;
+
+	// One low-poly unit sphere, positioned and colored per primitive when it is added
+	m_unitSphereVertexes.clear();
+	m_unitSphereIndexes.clear();
+	AddVertsForIndexedSphere3D(m_unitSphereVertexes, m_unitSphereIndexes, Vec3(0.f, 0.f, 0.f), 1.f, Rgba8::WHITE, AABB2(Vec2::ZERO, Vec2::ONE),
+		DEBUG_SPHERE_NUM_SLICES, DEBUG_SPHERE_NUM_STACKS);
+	OptimizeVertexCacheOrder(m_unitSphereIndexes, static_cast<int>(m_unitSphereVertexes.size()));
+	OptimizeVertexFetchOrder(m_unitSphereVertexes, m_unitSphereIndexes);
+
+	int numUnitVertexes = static_cast<int>(m_unitSphereVertexes.size());
+	int numUnitIndexes = static_cast<int>(m_unitSphereIndexes.size());
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			DebugPrimitiveBatch& batch = m_batches[modeIndex][fillIndex];
+			batch.m_primitives.reserve(DEBUG_PRIMITIVE_POOL_CAPACITY);
+			batch.m_vertexes.reserve(static_cast<size_t>(DEBUG_PRIMITIVE_POOL_CAPACITY) * numUnitVertexes);
+		}
+	}
+
+	if (!m_hasGPUBuffers)
+	{
+		return;
+	}
+
+	// Every primitive uses the same index pattern offset by its first vertex, so this never changes
+	std::vector<unsigned int> indexes;
+	indexes.reserve(static_cast<size_t>(DEBUG_PRIMITIVE_POOL_CAPACITY) * numUnitIndexes);
+	for (int primitiveIndex = 0; primitiveIndex < DEBUG_PRIMITIVE_POOL_CAPACITY; ++primitiveIndex)
+	{
+		unsigned int firstVertex = static_cast<unsigned int>(primitiveIndex * numUnitVertexes);
+		for (int index = 0; index < numUnitIndexes; ++index)
+		{
+			indexes.push_back(firstVertex + m_unitSphereIndexes[index]);
+		}
+	}
+	unsigned int indexBufferSize = static_cast<unsigned int>(indexes.size() * sizeof(unsigned int));
+	m_indexBuffer = g_theRenderer->CreateIndexBuffer(indexBufferSize);
+	g_theRenderer->CopyCPUToGPU(indexes.data(), indexBufferSize, m_indexBuffer);
+
+	unsigned int vertexBufferSize = static_cast<unsigned int>(DEBUG_PRIMITIVE_POOL_CAPACITY * numUnitVertexes * sizeof(Vertex_PCU));
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			m_batches[modeIndex][fillIndex].m_vertexBuffer = g_theRenderer->CreateVertexBuffer(vertexBufferSize);
+		}
+	}
+}
+
+void DebugPrimitivePool::Shutdown()
+{
+	Clear();
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			delete m_batches[modeIndex][fillIndex].m_vertexBuffer;
+			m_batches[modeIndex][fillIndex].m_vertexBuffer = nullptr;
+		}
+	}
+	delete m_indexBuffer;
+	m_indexBuffer = nullptr;
+	m_hasGPUBuffers = false;
+}
+
+void DebugPrimitivePool::Clear()
+{
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			DebugPrimitiveBatch& batch = m_batches[modeIndex][fillIndex];
+			batch.m_primitives.clear();
+			batch.m_vertexes.clear();
+			batch.m_isDirty = true;
+		}
+	}
+}
+
+void DebugPrimitivePool::AddWorldSphere(Vec3 const& center, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor,
+	DebugRenderMode mode, bool isWireframe)
+{
+	DebugPrimitiveBatch& batch = GetBatch(mode, isWireframe);
+	if (static_cast<int>(batch.m_primitives.size()) == DEBUG_PRIMITIVE_POOL_CAPACITY)
+	{
+		int soonestIndex = 0;
+		for (int primitiveIndex = 1; primitiveIndex < DEBUG_PRIMITIVE_POOL_CAPACITY; ++primitiveIndex)
+		{
+			if (batch.m_primitives[primitiveIndex].m_expireSeconds < batch.m_primitives[soonestIndex].m_expireSeconds)
+			{
+				soonestIndex = primitiveIndex;
+			}
+		}
+		RemovePrimitive(batch, soonestIndex);
+	}
+
+	DebugPrimitive primitive;
+	primitive.m_expireSeconds = duration < 0.f ? DBL_MAX : m_currentSeconds + static_cast<double>(duration);
+	primitive.m_duration = duration;
+	primitive.m_startColor = startColor;
+	primitive.m_endColor = endColor;
+	batch.m_primitives.push_back(primitive);
+
+	for (size_t vertexIndex = 0; vertexIndex < m_unitSphereVertexes.size(); ++vertexIndex)
+	{
+		Vertex_PCU vertex = m_unitSphereVertexes[vertexIndex];
+		vertex.m_position = center + vertex.m_position * radius;
+		vertex.m_color = startColor;
+		batch.m_vertexes.push_back(vertex);
+	}
+	batch.m_isDirty = true;
+}
+
+void DebugPrimitivePool::Update(double currentSeconds)
+{
+	PROFILE_SCOPE("DebugPrimitivePool::Update");
+	m_currentSeconds = currentSeconds;
+
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			DebugPrimitiveBatch& batch = m_batches[modeIndex][fillIndex];
+			for (int primitiveIndex = static_cast<int>(batch.m_primitives.size()) - 1; primitiveIndex >= 0; --primitiveIndex)
+			{
+				DebugPrimitive const& primitive = batch.m_primitives[primitiveIndex];
+				if (currentSeconds >= primitive.m_expireSeconds)
+				{
+					RemovePrimitive(batch, primitiveIndex);
+				}
+				else if (primitive.m_duration > 0.f && !(primitive.m_startColor == primitive.m_endColor))
+				{
+					// Only fading primitives pay for a per-frame color rewrite
+					float fraction = 1.f - static_cast<float>((primitive.m_expireSeconds - currentSeconds) / static_cast<double>(primitive.m_duration));
+					Rgba8 color(
+						static_cast<unsigned char>(Interpolate(static_cast<float>(primitive.m_startColor.r), static_cast<float>(primitive.m_endColor.r), fraction)),
+						static_cast<unsigned char>(Interpolate(static_cast<float>(primitive.m_startColor.g), static_cast<float>(primitive.m_endColor.g), fraction)),
+						static_cast<unsigned char>(Interpolate(static_cast<float>(primitive.m_startColor.b), static_cast<float>(primitive.m_endColor.b), fraction)),
+						static_cast<unsigned char>(Interpolate(static_cast<float>(primitive.m_startColor.a), static_cast<float>(primitive.m_endColor.a), fraction)));
+					SetPrimitiveColor(batch, primitiveIndex, color);
+				}
+			}
+
+			if (batch.m_isDirty && m_hasGPUBuffers && !batch.m_vertexes.empty())
+			{
+				g_theRenderer->CopyCPUToGPU(batch.m_vertexes.data(), static_cast<unsigned int>(batch.m_vertexes.size() * sizeof(Vertex_PCU)), batch.m_vertexBuffer);
+			}
+			batch.m_isDirty = false;
+		}
+	}
+}
+
+void DebugPrimitivePool::Render(RenderStateTracker& renderStateTracker) const
+{
+	PROFILE_SCOPE("DebugPrimitivePool::Render");
+	renderStateTracker.SetModelConstants();
+	renderStateTracker.BindTexture(nullptr);
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			RenderBatch(renderStateTracker, m_batches[modeIndex][fillIndex], static_cast<DebugRenderMode>(modeIndex), fillIndex == 1);
+		}
+	}
+	renderStateTracker.SetModelConstants();
+}
+
+int DebugPrimitivePool::GetNumLivePrimitives() const
+{
+	int numLivePrimitives = 0;
+	for (int modeIndex = 0; modeIndex < NUM_DEBUG_RENDER_MODES; ++modeIndex)
+	{
+		for (int fillIndex = 0; fillIndex < 2; ++fillIndex)
+		{
+			numLivePrimitives += static_cast<int>(m_batches[modeIndex][fillIndex].m_primitives.size());
+		}
+	}
+	return numLivePrimitives;
+}
+
+DebugPrimitivePool::DebugPrimitiveBatch& DebugPrimitivePool::GetBatch(DebugRenderMode mode, bool isWireframe)
+{
+	return m_batches[static_cast<int>(mode)][isWireframe ? 1 : 0];
+}
+
+void DebugPrimitivePool::RemovePrimitive(DebugPrimitiveBatch& batch, int primitiveIndex)
+{
+	// Swap the last primitive and its vertexes into the hole so the batch stays one contiguous range
+	int lastIndex = static_cast<int>(batch.m_primitives.size()) - 1;
+	size_t numUnitVertexes = m_unitSphereVertexes.size();
+	if (primitiveIndex != lastIndex)
+	{
+		batch.m_primitives[primitiveIndex] = batch.m_primitives[lastIndex];
+		std::copy(batch.m_vertexes.begin() + lastIndex * numUnitVertexes, batch.m_vertexes.end(), batch.m_vertexes.begin() + primitiveIndex * numUnitVertexes);
+	}
+	batch.m_primitives.pop_back();
+	batch.m_vertexes.resize(batch.m_vertexes.size() - numUnitVertexes);
+	batch.m_isDirty = true;
+}
+
+void DebugPrimitivePool::SetPrimitiveColor(DebugPrimitiveBatch& batch, int primitiveIndex, Rgba8 const& color)
+{
+	size_t numUnitVertexes = m_unitSphereVertexes.size();
+	Vertex_PCU* vertexes = batch.m_vertexes.data() + primitiveIndex * numUnitVertexes;
+	for (size_t vertexIndex = 0; vertexIndex < numUnitVertexes; ++vertexIndex)
+	{
+		vertexes[vertexIndex].m_color = color;
+	}
+	batch.m_isDirty = true;
+}
+
+void DebugPrimitivePool::RenderBatch(RenderStateTracker& renderStateTracker, DebugPrimitiveBatch const& batch, DebugRenderMode mode, bool isWireframe) const
+{
+	if (batch.m_primitives.empty())
+	{
+		return;
+	}
+
+	int numIndexes = static_cast<int>(batch.m_primitives.size() * m_unitSphereIndexes.size());
+	renderStateTracker.SetRasterizerMode(isWireframe ? RasterizerMode::WIREFRAME_CULL_BACK : RasterizerMode::SOLID_CULL_BACK);
+	if (mode == DebugRenderMode::X_RAY)
+	{
+		// Faded pass that shows through walls, then the normal depth-tested pass on top
+		renderStateTracker.SetBlendMode(BlendMode::ALPHA);
+		renderStateTracker.SetDepthMode(DepthMode::READ_ONLY_ALWAYS);
+		renderStateTracker.SetModelConstants(Mat44(), Rgba8(255, 255, 255, 80));
+		renderStateTracker.DrawIndexedVertexBuffer(batch.m_vertexBuffer, m_indexBuffer, numIndexes);
+		renderStateTracker.SetModelConstants();
+	}
+	renderStateTracker.SetBlendMode(BlendMode::OPAQUE);
+	renderStateTracker.SetDepthMode(mode == DebugRenderMode::ALWAYS ? DepthMode::DISABLED : DepthMode::READ_WRITE_LESS_EQUAL);
+	renderStateTracker.DrawIndexedVertexBuffer(batch.m_vertexBuffer, m_indexBuffer, numIndexes);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/DebugRender.hpp"
+#include "Engine/Math/Vec3.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+class IndexBuffer;
+class RenderStateTracker;
+class VertexBuffer;
+// -----------------------------------------------------------------------------
+constexpr int DEBUG_PRIMITIVE_POOL_CAPACITY = 4096;
+constexpr int DEBUG_SPHERE_NUM_SLICES = 12;
+constexpr int DEBUG_SPHERE_NUM_STACKS = 6;
+constexpr int NUM_DEBUG_RENDER_MODES = 3;
+// -----------------------------------------------------------------------------
+// Fixed-capacity store for long-lived debug spheres. Each render mode and fill
+// mode has its own batch whose vertexes are written once when a sphere is added
+// and live in one vertex buffer, so every live sphere in a batch is one draw.
+// All batches share an index buffer built at Startup for the full capacity.
+// When a batch is full, the sphere closest to expiring is replaced. A negative
+// duration keeps a sphere until Clear.
+// -----------------------------------------------------------------------------
+class DebugPrimitivePool
+{
+public:
+	DebugPrimitivePool();
+	~DebugPrimitivePool();
+
+	void Startup(bool createGPUBuffers);
+	void Shutdown();
+	void Clear();
+
+	void AddWorldSphere(Vec3 const& center, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor,
+		DebugRenderMode mode = DebugRenderMode::USE_DEPTH, bool isWireframe = false);
+	void Update(double currentSeconds);
+	void Render(RenderStateTracker& renderStateTracker) const;
+
+	int GetNumLivePrimitives() const;
+
+private:
+	struct DebugPrimitive
+	{
+		double m_expireSeconds = 0.0;
+		float m_duration = 0.f;
+		Rgba8 m_startColor;
+		Rgba8 m_endColor;
+	};
+
+	struct DebugPrimitiveBatch
+	{
+		std::vector<DebugPrimitive> m_primitives;
+		std::vector<Vertex_PCU> m_vertexes;		// Unit mesh vertexes per primitive, in the same order as m_primitives
+		VertexBuffer* m_vertexBuffer = nullptr;
+		bool m_isDirty = false;
+	};
+
+	DebugPrimitiveBatch& GetBatch(DebugRenderMode mode, bool isWireframe);
+	void RemovePrimitive(DebugPrimitiveBatch& batch, int primitiveIndex);
+	void SetPrimitiveColor(DebugPrimitiveBatch& batch, int primitiveIndex, Rgba8 const& color);
+	void RenderBatch(RenderStateTracker& renderStateTracker, DebugPrimitiveBatch const& batch, DebugRenderMode mode, bool isWireframe) const;
+
+private:
+	bool m_hasGPUBuffers = false;
+	double m_currentSeconds = 0.0;
+	std::vector<Vertex_PCU> m_unitSphereVertexes;
+	std::vector<unsigned int> m_unitSphereIndexes;
+	IndexBuffer* m_indexBuffer = nullptr;
+	DebugPrimitiveBatch m_batches[NUM_DEBUG_RENDER_MODES][2];
+};
\ No newline at end of file
@@ -12,8 +12,19 @@ Entity::~Entity()
 
 Mat44 Entity::GetModelToWorldTransform() const
 {
+	bool isOrientationUnchanged = m_cachedOrientation.m_yawDegrees == m_orientation.m_yawDegrees
+		&& m_cachedOrientation.m_pitchDegrees == m_orientation.m_pitchDegrees && m_cachedOrientation.m_rollDegrees == m_orientation.m_rollDegrees;
+	if (m_isModelToWorldCached && isOrientationUnchanged && m_cachedPosition == m_position)
+	{
+		return m_cachedModelToWorld;
+	}
+
 	Mat44 modelToWorldMatrix;
 	modelToWorldMatrix.SetTranslation3D(m_position);
 	modelToWorldMatrix.Append(m_orientation.GetAsMatrix_IFwd_JLeft_KUp());
+	m_cachedModelToWorld = modelToWorldMatrix;
+	m_cachedPosition = m_position;
+	m_cachedOrientation = m_orientation;
+	m_isModelToWorldCached = true;
 	return modelToWorldMatrix;
 }
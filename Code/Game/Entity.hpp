@@ -1,10 +1,10 @@
 #pragma once
 #include "Engine/Math/Vec3.h"
 #include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
 #include "Engine/Core/Rgba8.h"
 // -----------------------------------------------------------------------------
 class Game;
-class Mat44;
 // -----------------------------------------------------------------------------
 class Entity
 {
@@ -22,4 +22,11 @@ public:
 
 	Vec3 m_position = Vec3::ZERO;
 	EulerAngles m_orientation = EulerAngles(0.f, 0.f, 0.f);
+
+private:
+	// m_position and m_orientation are written directly, so the cache is checked against copies of them instead of a dirty flag
+	mutable Mat44 m_cachedModelToWorld;
+	mutable Vec3 m_cachedPosition;
+	mutable EulerAngles m_cachedOrientation;
+	mutable bool m_isModelToWorldCached = false;
 };
\ No newline at end of file
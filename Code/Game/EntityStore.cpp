@@ -0,0 +1,435 @@
+#include "Game/EntityStore.hpp"
+#include "Game/TransformKernels.hpp"
+#include "Engine/Core/EngineCommon.h"
+
+EntityStore::EntityStore()
+{
+}
+
+EntityStore::~EntityStore()
+{
+}
+
+EntityHandle EntityStore::CreateEntity(Vec3 const& position, Rgba8 const& color, int meshID, float boundingRadius, int textureID)
+{
+	unsigned int slot;
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = static_cast<unsigned int>(m_slotToIndex.size());
+		m_slotToIndex.push_back(INVALID_ENTITY_SLOT);
+		m_slotGenerations.push_back(0);
+		m_parentSlots.push_back(INVALID_ENTITY_SLOT);
+		m_firstChildSlots.push_back(INVALID_ENTITY_SLOT);
+		m_nextSiblingSlots.push_back(INVALID_ENTITY_SLOT);
+	}
+	m_parentSlots[slot] = INVALID_ENTITY_SLOT;
+	m_firstChildSlots[slot] = INVALID_ENTITY_SLOT;
+	m_nextSiblingSlots[slot] = INVALID_ENTITY_SLOT;
+
+	unsigned int index = static_cast<unsigned int>(m_positions.size());
+	m_slotToIndex[slot] = index;
+	m_indexToSlot.push_back(slot);
+
+	m_positions.push_back(position);
+	m_orientations.push_back(EulerAngles(0.f, 0.f, 0.f));
+	m_angularVelocities.push_back(EulerAngles(0.f, 0.f, 0.f));
+	m_linearVelocities.push_back(Vec3::ZERO);
+	m_colors.push_back(color);
+	m_meshIDs.push_back(meshID);
+	m_textureIDs.push_back(textureID);
+	m_boundingRadii.push_back(boundingRadius);
+	m_worldTransforms.push_back(Mat44::MakeTranslation3D(position));
+	m_previousWorldTransforms.push_back(m_worldTransforms.back());
+	m_transformOrientations.push_back(EulerAngles(0.f, 0.f, 0.f));
+	m_previousTransformOrientations.push_back(EulerAngles(0.f, 0.f, 0.f));
+	m_isTransformDirty.push_back(0);
+	m_boundsCentersX.push_back(position.x);
+	m_boundsCentersY.push_back(position.y);
+	m_boundsCentersZ.push_back(position.z);
+
+	EntityHandle handle;
+	handle.m_slot = slot;
+	handle.m_generation = m_slotGenerations[slot];
+	return handle;
+}
+
+void EntityStore::DestroyEntity(EntityHandle handle)
+{
+	if (!IsAlive(handle))
+	{
+		return;
+	}
+
+	// Children become roots where they are; their local values are kept, so they are rebuilt relative to the world
+	unsigned int childSlot = m_firstChildSlots[handle.m_slot];
+	while (childSlot != INVALID_ENTITY_SLOT)
+	{
+		unsigned int nextSiblingSlot = m_nextSiblingSlots[childSlot];
+		m_parentSlots[childSlot] = INVALID_ENTITY_SLOT;
+		m_nextSiblingSlots[childSlot] = INVALID_ENTITY_SLOT;
+		MarkTransformDirty(static_cast<int>(m_slotToIndex[childSlot]));
+		childSlot = nextSiblingSlot;
+	}
+	m_firstChildSlots[handle.m_slot] = INVALID_ENTITY_SLOT;
+	UnlinkFromParent(handle.m_slot);
+
+	// Indexes from the last transform update would point at the wrong entities after the swap below
+	m_updatedTransformIndexes.clear();
+
+	// Move the last entity into the freed index so the arrays stay dense
+	unsigned int index = m_slotToIndex[handle.m_slot];
+	unsigned int lastIndex = static_cast<unsigned int>(m_positions.size()) - 1;
+	if (index != lastIndex)
+	{
+		m_positions[index]			= m_positions[lastIndex];
+		m_orientations[index]		= m_orientations[lastIndex];
+		m_angularVelocities[index]	= m_angularVelocities[lastIndex];
+		m_linearVelocities[index]	= m_linearVelocities[lastIndex];
+		m_colors[index]				= m_colors[lastIndex];
+		m_meshIDs[index]			= m_meshIDs[lastIndex];
+		m_textureIDs[index]			= m_textureIDs[lastIndex];
+		m_boundingRadii[index]		= m_boundingRadii[lastIndex];
+		m_worldTransforms[index]	= m_worldTransforms[lastIndex];
+		m_previousWorldTransforms[index] = m_previousWorldTransforms[lastIndex];
+		m_transformOrientations[index] = m_transformOrientations[lastIndex];
+		m_previousTransformOrientations[index] = m_previousTransformOrientations[lastIndex];
+		m_isTransformDirty[index]	= m_isTransformDirty[lastIndex];
+		m_boundsCentersX[index]		= m_boundsCentersX[lastIndex];
+		m_boundsCentersY[index]		= m_boundsCentersY[lastIndex];
+		m_boundsCentersZ[index]		= m_boundsCentersZ[lastIndex];
+
+		unsigned int movedSlot = m_indexToSlot[lastIndex];
+		m_indexToSlot[index] = movedSlot;
+		m_slotToIndex[movedSlot] = index;
+	}
+
+	m_positions.pop_back();
+	m_orientations.pop_back();
+	m_angularVelocities.pop_back();
+	m_linearVelocities.pop_back();
+	m_colors.pop_back();
+	m_meshIDs.pop_back();
+	m_textureIDs.pop_back();
+	m_boundingRadii.pop_back();
+	m_worldTransforms.pop_back();
+	m_previousWorldTransforms.pop_back();
+	m_transformOrientations.pop_back();
+	m_previousTransformOrientations.pop_back();
+	m_isTransformDirty.pop_back();
+	m_boundsCentersX.pop_back();
+	m_boundsCentersY.pop_back();
+	m_boundsCentersZ.pop_back();
+	m_indexToSlot.pop_back();
+
+	m_slotToIndex[handle.m_slot] = INVALID_ENTITY_SLOT;
+	++m_slotGenerations[handle.m_slot];
+	m_freeSlots.push_back(handle.m_slot);
+}
+
+void EntityStore::Clear()
+{
+	m_positions.clear();
+	m_orientations.clear();
+	m_angularVelocities.clear();
+	m_linearVelocities.clear();
+	m_colors.clear();
+	m_meshIDs.clear();
+	m_textureIDs.clear();
+	m_boundingRadii.clear();
+	m_worldTransforms.clear();
+	m_previousWorldTransforms.clear();
+	m_transformOrientations.clear();
+	m_previousTransformOrientations.clear();
+	m_isTransformDirty.clear();
+	m_boundsCentersX.clear();
+	m_boundsCentersY.clear();
+	m_boundsCentersZ.clear();
+
+	m_indexToSlot.clear();
+	m_slotToIndex.clear();
+	m_slotGenerations.clear();
+	m_freeSlots.clear();
+	m_parentSlots.clear();
+	m_firstChildSlots.clear();
+	m_nextSiblingSlots.clear();
+	m_updatedTransformIndexes.clear();
+}
+
+void EntityStore::Reserve(int numEntities)
+{
+	size_t capacity = static_cast<size_t>(numEntities);
+	m_positions.reserve(capacity);
+	m_orientations.reserve(capacity);
+	m_angularVelocities.reserve(capacity);
+	m_linearVelocities.reserve(capacity);
+	m_colors.reserve(capacity);
+	m_meshIDs.reserve(capacity);
+	m_textureIDs.reserve(capacity);
+	m_boundingRadii.reserve(capacity);
+	m_worldTransforms.reserve(capacity);
+	m_previousWorldTransforms.reserve(capacity);
+	m_transformOrientations.reserve(capacity);
+	m_previousTransformOrientations.reserve(capacity);
+	m_isTransformDirty.reserve(capacity);
+	m_boundsCentersX.reserve(capacity);
+	m_boundsCentersY.reserve(capacity);
+	m_boundsCentersZ.reserve(capacity);
+	m_indexToSlot.reserve(capacity);
+}
+
+bool EntityStore::IsAlive(EntityHandle handle) const
+{
+	if (handle.m_slot >= m_slotToIndex.size())
+	{
+		return false;
+	}
+	return m_slotGenerations[handle.m_slot] == handle.m_generation && m_slotToIndex[handle.m_slot] != INVALID_ENTITY_SLOT;
+}
+
+int EntityStore::GetIndex(EntityHandle handle) const
+{
+	GUARANTEE_OR_DIE(IsAlive(handle), "EntityStore::GetIndex called with a stale or invalid EntityHandle");
+	return static_cast<int>(m_slotToIndex[handle.m_slot]);
+}
+
+int EntityStore::GetNumEntities() const
+{
+	return static_cast<int>(m_positions.size());
+}
+
+int EntityStore::GetNumSlots() const
+{
+	return static_cast<int>(m_slotToIndex.size());
+}
+
+EntityHandle EntityStore::GetHandle(int index) const
+{
+	EntityHandle handle;
+	handle.m_slot = m_indexToSlot[index];
+	handle.m_generation = m_slotGenerations[handle.m_slot];
+	return handle;
+}
+
+void EntityStore::SetPosition(EntityHandle handle, Vec3 const& position)
+{
+	int index = GetIndex(handle);
+	m_positions[index] = position;
+	MarkTransformDirty(index);
+}
+
+void EntityStore::SetOrientation(EntityHandle handle, EulerAngles const& orientation)
+{
+	int index = GetIndex(handle);
+	m_orientations[index] = orientation;
+	MarkTransformDirty(index);
+}
+
+void EntityStore::SetParent(EntityHandle child, EntityHandle parent)
+{
+	int childIndex = GetIndex(child);
+	unsigned int parentSlot = INVALID_ENTITY_SLOT;
+	if (parent.IsValid())
+	{
+		GetIndex(parent);
+		parentSlot = parent.m_slot;
+
+		// Refuse links that would make the child its own ancestor
+		for (unsigned int ancestorSlot = parentSlot; ancestorSlot != INVALID_ENTITY_SLOT; ancestorSlot = m_parentSlots[ancestorSlot])
+		{
+			if (ancestorSlot == child.m_slot)
+			{
+				ERROR_RECOVERABLE("EntityStore::SetParent would create a cycle in the transform hierarchy");
+				return;
+			}
+		}
+	}
+
+	UnlinkFromParent(child.m_slot);
+	if (parentSlot != INVALID_ENTITY_SLOT)
+	{
+		m_parentSlots[child.m_slot] = parentSlot;
+		m_nextSiblingSlots[child.m_slot] = m_firstChildSlots[parentSlot];
+		m_firstChildSlots[parentSlot] = child.m_slot;
+	}
+	MarkTransformDirty(childIndex);
+}
+
+EntityHandle EntityStore::GetParent(EntityHandle handle) const
+{
+	EntityHandle parent;
+	if (!IsAlive(handle))
+	{
+		return parent;
+	}
+	unsigned int parentSlot = m_parentSlots[handle.m_slot];
+	if (parentSlot != INVALID_ENTITY_SLOT)
+	{
+		parent.m_slot = parentSlot;
+		parent.m_generation = m_slotGenerations[parentSlot];
+	}
+	return parent;
+}
+
+void EntityStore::MarkTransformDirty(int index)
+{
+	m_isTransformDirty[index] = 1;
+}
+
+bool EntityStore::IsRoot(int index) const
+{
+	return m_parentSlots[m_indexToSlot[index]] == INVALID_ENTITY_SLOT;
+}
+
+void EntityStore::UpdatePositions(float deltaSeconds, int beginIndex, int endIndex)
+{
+	Vec3* positions = m_positions.data();
+	Vec3 const* linearVelocities = m_linearVelocities.data();
+	unsigned char* isTransformDirty = m_isTransformDirty.data();
+	for (int entityIndex = beginIndex; entityIndex < endIndex; ++entityIndex)
+	{
+		Vec3 const& linearVelocity = linearVelocities[entityIndex];
+		if (linearVelocity.x == 0.f && linearVelocity.y == 0.f && linearVelocity.z == 0.f)
+		{
+			continue;
+		}
+		positions[entityIndex] += linearVelocity * deltaSeconds;
+		isTransformDirty[entityIndex] = 1;
+	}
+}
+
+void EntityStore::UpdateOrientations(float deltaSeconds, int beginIndex, int endIndex)
+{
+	// Only spinning entities change, and only those are marked for a transform rebuild
+	EulerAngles* orientations = m_orientations.data();
+	EulerAngles const* angularVelocities = m_angularVelocities.data();
+	unsigned char* isTransformDirty = m_isTransformDirty.data();
+	for (int entityIndex = beginIndex; entityIndex < endIndex; ++entityIndex)
+	{
+		EulerAngles const& angularVelocity = angularVelocities[entityIndex];
+		if (angularVelocity.m_yawDegrees == 0.f && angularVelocity.m_pitchDegrees == 0.f && angularVelocity.m_rollDegrees == 0.f)
+		{
+			continue;
+		}
+		orientations[entityIndex].m_yawDegrees += angularVelocity.m_yawDegrees * deltaSeconds;
+		orientations[entityIndex].m_pitchDegrees += angularVelocity.m_pitchDegrees * deltaSeconds;
+		orientations[entityIndex].m_rollDegrees += angularVelocity.m_rollDegrees * deltaSeconds;
+		isTransformDirty[entityIndex] = 1;
+	}
+}
+
+void EntityStore::UpdateWorldTransforms()
+{
+	m_updatedTransformIndexes.clear();
+	m_batchIndexes.clear();
+
+	// Dirty entities outside any hierarchy go through the batched kernel; anything with a parent or children
+	// is rebuilt as a subtree from its highest dirty ancestor so parents are always done before children
+	int numEntities = GetNumEntities();
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex)
+	{
+		if (m_isTransformDirty[entityIndex] == 0)
+		{
+			continue;
+		}
+
+		unsigned int slot = m_indexToSlot[entityIndex];
+		unsigned int parentSlot = m_parentSlots[slot];
+		if (parentSlot == INVALID_ENTITY_SLOT && m_firstChildSlots[slot] == INVALID_ENTITY_SLOT)
+		{
+			m_batchIndexes.push_back(entityIndex);
+		}
+		else if (!HasDirtyAncestor(slot))
+		{
+			Mat44 const* parentTransform = parentSlot != INVALID_ENTITY_SLOT ? &m_worldTransforms[m_slotToIndex[parentSlot]] : nullptr;
+			UpdateSubtree(entityIndex, parentTransform);
+		}
+	}
+
+	int numBatched = static_cast<int>(m_batchIndexes.size());
+	if (numBatched == 0)
+	{
+		return;
+	}
+	m_batchPositions.resize(static_cast<size_t>(numBatched));
+	m_batchOrientations.resize(static_cast<size_t>(numBatched));
+	m_batchTransforms.resize(static_cast<size_t>(numBatched));
+	for (int batchIndex = 0; batchIndex < numBatched; ++batchIndex)
+	{
+		m_batchPositions[batchIndex] = m_positions[m_batchIndexes[batchIndex]];
+		m_batchOrientations[batchIndex] = m_orientations[m_batchIndexes[batchIndex]];
+	}
+	ComputeModelToWorldTransforms(numBatched, m_batchPositions.data(), m_batchOrientations.data(), m_batchTransforms.data());
+	for (int batchIndex = 0; batchIndex < numBatched; ++batchIndex)
+	{
+		StoreWorldTransform(m_batchIndexes[batchIndex], m_batchTransforms[batchIndex]);
+	}
+}
+
+bool EntityStore::HasDirtyAncestor(unsigned int slot) const
+{
+	for (unsigned int ancestorSlot = m_parentSlots[slot]; ancestorSlot != INVALID_ENTITY_SLOT; ancestorSlot = m_parentSlots[ancestorSlot])
+	{
+		if (m_isTransformDirty[m_slotToIndex[ancestorSlot]] != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void EntityStore::UpdateSubtree(int index, Mat44 const* parentTransform)
+{
+	Mat44 localTransform;
+	ComputeModelToWorldTransforms_Reference(1, &m_positions[index], &m_orientations[index], &localTransform);
+	Mat44 worldTransform = localTransform;
+	if (parentTransform != nullptr)
+	{
+		worldTransform = *parentTransform;
+		worldTransform.Append(localTransform);
+	}
+	StoreWorldTransform(index, worldTransform);
+
+	// Children move with their parent whether or not they were dirty themselves
+	for (unsigned int childSlot = m_firstChildSlots[m_indexToSlot[index]]; childSlot != INVALID_ENTITY_SLOT; childSlot = m_nextSiblingSlots[childSlot])
+	{
+		UpdateSubtree(static_cast<int>(m_slotToIndex[childSlot]), &m_worldTransforms[index]);
+	}
+}
+
+void EntityStore::StoreWorldTransform(int index, Mat44 const& worldTransform)
+{
+	m_previousWorldTransforms[index] = m_worldTransforms[index];
+	m_worldTransforms[index] = worldTransform;
+	m_previousTransformOrientations[index] = m_transformOrientations[index];
+	m_transformOrientations[index] = m_orientations[index];
+	m_isTransformDirty[index] = 0;
+	m_updatedTransformIndexes.push_back(index);
+
+	// Meshes are centered on their local origin, so each bounding sphere sits at the entity's world position
+	m_boundsCentersX[index] = worldTransform.m_values[Mat44::Tx];
+	m_boundsCentersY[index] = worldTransform.m_values[Mat44::Ty];
+	m_boundsCentersZ[index] = worldTransform.m_values[Mat44::Tz];
+}
+
+void EntityStore::UnlinkFromParent(unsigned int slot)
+{
+	unsigned int parentSlot = m_parentSlots[slot];
+	if (parentSlot == INVALID_ENTITY_SLOT)
+	{
+		return;
+	}
+
+	unsigned int* link = &m_firstChildSlots[parentSlot];
+	while (*link != slot)
+	{
+		link = &m_nextSiblingSlots[*link];
+	}
+	*link = m_nextSiblingSlots[slot];
+	m_parentSlots[slot] = INVALID_ENTITY_SLOT;
+	m_nextSiblingSlots[slot] = INVALID_ENTITY_SLOT;
+}
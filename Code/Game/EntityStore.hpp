@@ -0,0 +1,103 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Core/Rgba8.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr unsigned int INVALID_ENTITY_SLOT = 0xFFFFFFFF;
+// -----------------------------------------------------------------------------
+struct EntityHandle
+{
+	unsigned int m_slot = INVALID_ENTITY_SLOT;
+	unsigned int m_generation = 0;
+
+	bool IsValid() const { return m_slot != INVALID_ENTITY_SLOT; }
+};
+// -----------------------------------------------------------------------------
+// Structure-of-arrays storage for world entities. The per-entity arrays stay
+// densely packed (destroying an entity swaps the last one into its place), and
+// handles stay valid across those moves through a slot indirection table.
+//
+// Positions and orientations are relative to the entity's parent, or to the
+// world for roots. World transforms are cached and only rebuilt for entities
+// marked dirty, plus everything below them in the hierarchy, so entities that
+// do not move cost nothing in UpdateWorldTransforms. Writes that go straight to
+// m_positions or m_orientations must call MarkTransformDirty.
+// -----------------------------------------------------------------------------
+class EntityStore
+{
+public:
+	EntityStore();
+	~EntityStore();
+
+	EntityHandle CreateEntity(Vec3 const& position, Rgba8 const& color, int meshID, float boundingRadius, int textureID = -1);
+	void DestroyEntity(EntityHandle handle);
+	void Clear();
+	void Reserve(int numEntities);
+
+	bool IsAlive(EntityHandle handle) const;
+	int  GetIndex(EntityHandle handle) const;
+	int  GetNumEntities() const;
+	int  GetNumSlots() const;
+	EntityHandle GetHandle(int index) const;
+
+	void SetPosition(EntityHandle handle, Vec3 const& position);
+	void SetOrientation(EntityHandle handle, EulerAngles const& orientation);
+	void SetParent(EntityHandle child, EntityHandle parent);
+	EntityHandle GetParent(EntityHandle handle) const;
+	void MarkTransformDirty(int index);
+	bool IsRoot(int index) const;
+
+	void UpdatePositions(float deltaSeconds, int beginIndex, int endIndex);
+	void UpdateOrientations(float deltaSeconds, int beginIndex, int endIndex);
+	void UpdateWorldTransforms();
+	std::vector<int> const& GetUpdatedTransformIndexes() const { return m_updatedTransformIndexes; }
+
+public:
+	// Dense per-entity arrays, all indexed by the same entity index
+	std::vector<Vec3>			m_positions;
+	std::vector<EulerAngles>	m_orientations;
+	std::vector<EulerAngles>	m_angularVelocities;
+	std::vector<Vec3>			m_linearVelocities;	// Props with a velocity are moved and pushed around by the CollisionSystem
+	std::vector<Rgba8>			m_colors;
+	std::vector<int>			m_meshIDs;
+	std::vector<int>			m_textureIDs;	// TextureStreamer IDs, -1 for untextured
+	std::vector<float>			m_boundingRadii;
+
+	// Cached by UpdateWorldTransforms; the previous transform is what it was before the last rebuild, for render interpolation
+	std::vector<Mat44>			m_worldTransforms;
+	std::vector<Mat44>			m_previousWorldTransforms;
+	std::vector<EulerAngles>	m_transformOrientations;		// Local orientation each cached transform was built from, so interpolation can blend angles
+	std::vector<EulerAngles>	m_previousTransformOrientations;
+	std::vector<unsigned char>	m_isTransformDirty;
+
+	// World-space bounding sphere centers split by axis for SIMD culling, refreshed with the world transforms
+	std::vector<float>			m_boundsCentersX;
+	std::vector<float>			m_boundsCentersY;
+	std::vector<float>			m_boundsCentersZ;
+
+private:
+	bool HasDirtyAncestor(unsigned int slot) const;
+	void UpdateSubtree(int index, Mat44 const* parentTransform);
+	void StoreWorldTransform(int index, Mat44 const& worldTransform);
+	void UnlinkFromParent(unsigned int slot);
+
+private:
+	std::vector<unsigned int>	m_indexToSlot;
+	std::vector<unsigned int>	m_slotToIndex;
+	std::vector<unsigned int>	m_slotGenerations;
+	std::vector<unsigned int>	m_freeSlots;
+
+	// Hierarchy links by slot so they survive the dense arrays being reordered
+	std::vector<unsigned int>	m_parentSlots;
+	std::vector<unsigned int>	m_firstChildSlots;
+	std::vector<unsigned int>	m_nextSiblingSlots;
+
+	// Scratch for UpdateWorldTransforms, kept to reuse capacity
+	std::vector<int>			m_updatedTransformIndexes;
+	std::vector<int>			m_batchIndexes;
+	std::vector<Vec3>			m_batchPositions;
+	std::vector<EulerAngles>	m_batchOrientations;
+	std::vector<Mat44>			m_batchTransforms;
+};
\ No newline at end of file
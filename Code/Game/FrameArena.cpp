@@ -0,0 +1,84 @@
+#include "Game/FrameArena.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <stdlib.h>
+
+FrameArena::FrameArena(FrameArenaConfig const& config)
+	: m_config(config)
+{
+}
+
+FrameArena::~FrameArena()
+{
+}
+
+void FrameArena::Startup()
+{
+	m_memory = static_cast<unsigned char*>(malloc(m_config.m_capacityBytes));
+	m_offset.store(0, std::memory_order_relaxed);
+
+	SubscribeEventCallbackFunction("FrameArenaReport", Command_FrameArenaReport);
+}
+
+void FrameArena::Shutdown()
+{
+	free(m_memory);
+	m_memory = nullptr;
+}
+
+void FrameArena::EndFrame()
+{
+	m_lastFrameBytes = m_offset.load(std::memory_order_relaxed);
+	m_lastFrameNumOverflows = m_numOverflows.load(std::memory_order_relaxed);
+	if (m_lastFrameBytes > m_peakFrameBytes)
+	{
+		m_peakFrameBytes = m_lastFrameBytes;
+	}
+
+	m_offset.store(0, std::memory_order_relaxed);
+	m_numOverflows.store(0, std::memory_order_relaxed);
+}
+
+void* FrameArena::Allocate(size_t numBytes, size_t alignment)
+{
+	// Several threads can bump at once, so the aligned offset is claimed with a compare-exchange
+	size_t offset = m_offset.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		size_t alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+		size_t endOffset = alignedOffset + numBytes;
+		if (m_memory == nullptr || endOffset > m_config.m_capacityBytes)
+		{
+			m_numOverflows.fetch_add(1, std::memory_order_relaxed);
+			return malloc(numBytes);
+		}
+		if (m_offset.compare_exchange_weak(offset, endOffset, std::memory_order_relaxed))
+		{
+			return m_memory + alignedOffset;
+		}
+	}
+}
+
+void FrameArena::Free(void* memory)
+{
+	if (!Owns(memory))
+	{
+		free(memory);
+	}
+}
+
+bool FrameArena::Owns(void const* memory) const
+{
+	unsigned char const* bytes = static_cast<unsigned char const*>(memory);
+	return m_memory != nullptr && bytes >= m_memory && bytes < m_memory + m_config.m_capacityBytes;
+}
+
+bool FrameArena::Command_FrameArenaReport(EventArgs& args)
+{
+	UNUSED(args);
+	g_theFrameArena->m_isReportVisible = !g_theFrameArena->m_isReportVisible;
+	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, Stringf("FrameArena: last frame %zu bytes, peak %zu of %zu, %d overflows", g_theFrameArena->m_lastFrameBytes,
+		g_theFrameArena->m_peakFrameBytes, g_theFrameArena->m_config.m_capacityBytes, g_theFrameArena->m_lastFrameNumOverflows));
+	return true;
+}
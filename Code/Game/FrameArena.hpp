@@ -0,0 +1,85 @@
+#pragma once
+#include "Game/GameCommon.h"
+#include "Engine/Core/EventSystem.hpp"
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+// -----------------------------------------------------------------------------
+struct FrameArenaConfig
+{
+	size_t m_capacityBytes = 4 * 1024 * 1024;
+};
+// -----------------------------------------------------------------------------
+// Linear allocator for memory that only lives until the end of the frame.
+// Allocation bumps an offset, and App::EndFrame resets it, so nothing is ever
+// freed one block at a time. Any thread may allocate, but jobs that outlive
+// the frame must not hold arena memory. Requests that do not fit fall back to
+// the heap and are counted as overflows, so the capacity can be tuned from the
+// FrameArenaReport numbers.
+// -----------------------------------------------------------------------------
+class FrameArena
+{
+public:
+	FrameArena(FrameArenaConfig const& config);
+	~FrameArena();
+
+	void Startup();
+	void Shutdown();
+	void EndFrame();
+
+	void* Allocate(size_t numBytes, size_t alignment);
+	void Free(void* memory);
+	bool Owns(void const* memory) const;
+
+	size_t GetLastFrameBytes() const { return m_lastFrameBytes; }
+	size_t GetPeakFrameBytes() const { return m_peakFrameBytes; }
+	int GetLastFrameNumOverflows() const { return m_lastFrameNumOverflows; }
+	bool IsReportVisible() const { return m_isReportVisible; }
+
+	static bool Command_FrameArenaReport(EventArgs& args);
+
+private:
+	FrameArenaConfig m_config;
+	unsigned char* m_memory = nullptr;
+	std::atomic<size_t> m_offset{ 0 };
+	std::atomic<int> m_numOverflows{ 0 };
+	size_t m_lastFrameBytes = 0;
+	size_t m_peakFrameBytes = 0;
+	int m_lastFrameNumOverflows = 0;
+	bool m_isReportVisible = false;
+};
+// -----------------------------------------------------------------------------
+// Lets STL containers live in the frame arena. Deallocation only returns memory
+// that overflowed to the heap; everything else goes away at the end of frame.
+// -----------------------------------------------------------------------------
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator() = default;
+	template<typename U> FrameAllocator(FrameAllocator<U> const&) {}
+
+	T* allocate(size_t numElements);
+	void deallocate(T* elements, size_t numElements);
+
+	template<typename U> bool operator==(FrameAllocator<U> const&) const { return true; }
+	template<typename U> bool operator!=(FrameAllocator<U> const&) const { return false; }
+};
+// -----------------------------------------------------------------------------
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+// -----------------------------------------------------------------------------
+template<typename T>
+T* FrameAllocator<T>::allocate(size_t numElements)
+{
+	return static_cast<T*>(g_theFrameArena->Allocate(numElements * sizeof(T), alignof(T)));
+}
+// -----------------------------------------------------------------------------
+template<typename T>
+void FrameAllocator<T>::deallocate(T* elements, size_t numElements)
+{
+	(void)numElements;
+	g_theFrameArena->Free(elements);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include "Game/Frustum.hpp"
+#include "Engine/Renderer/Camera.h"
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Core/Rgba8.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+class Texture;
+// -----------------------------------------------------------------------------
+// Everything the render list needs from one simulated frame, copied out of the
+// live game state so the render list can be built while the next frame is
+// being simulated. Each of the two buffers keeps its contents between
+// captures, and a capture only rewrites the entities that changed since that
+// buffer was last written.
+// -----------------------------------------------------------------------------
+struct FrameSnapshot
+{
+	Camera m_worldCamera;
+	Vec3 m_viewPosition;
+	EulerAngles m_viewOrientation;
+	Frustum m_viewFrustum;
+	bool m_isOcclusionCullingEnabled = true;
+	bool m_isMeshLodEnabled = true;
+
+	std::vector<Mat44>			m_worldTransforms;	// Interpolated between the last two simulation steps
+	std::vector<unsigned char>	m_isMoving;			// Transform rebuilt in the last step, so drawn from the shared mesh rather than baked
+	std::vector<Rgba8>			m_colors;
+	std::vector<int>			m_meshIDs;
+	std::vector<int>			m_textureIDs;
+	std::vector<float>			m_boundingRadii;
+	std::vector<float>			m_boundsCentersX;
+	std::vector<float>			m_boundsCentersY;
+	std::vector<float>			m_boundsCentersZ;
+	std::vector<int>			m_occluderIndexes;	// Entities drawn into the occlusion buffer before the rest are tested
+
+	// Streamed textures resolved on the main thread at capture, indexed by texture ID
+	std::vector<Texture*>		m_textures;
+
+	int GetNumEntities() const { return static_cast<int>(m_worldTransforms.size()); }
+};
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "Game/Frustum.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/Mat44.hpp"
+#include <math.h>
+#include <xmmintrin.h>
+
+static FrustumPlane MakePlaneThroughPoint(Vec3 const& normal, Vec3 const& point)
+{
+	FrustumPlane plane;
+	plane.m_normal = normal;
+	plane.m_distance = DotProduct3D(normal, point);
+	return plane;
+}
+
+Frustum Frustum::MakePerspective(Vec3 const& position, EulerAngles const& orientation, float aspect, float fovDegrees, float nearZ, float farZ)
+{
+	Mat44 orientationMatrix = orientation.GetAsMatrix_IFwd_JLeft_KUp();
+	Vec3 forward = orientationMatrix.GetIBasis3D();
+	Vec3 left = orientationMatrix.GetJBasis3D();
+	Vec3 up = orientationMatrix.GetKBasis3D();
+
+	// A side plane through the eye leaning out by 1/scale per unit of depth has the normal (1, -scale) / sqrt(1 + scale^2) in (forward, side)
+	float verticalScale = GetProjectionScale(fovDegrees);
+	float horizontalScale = verticalScale / aspect;
+	float sinHalfVertical = 1.f / sqrtf(1.f + verticalScale * verticalScale);
+	float cosHalfVertical = verticalScale * sinHalfVertical;
+	float sinHalfHorizontal = 1.f / sqrtf(1.f + horizontalScale * horizontalScale);
+	float cosHalfHorizontal = horizontalScale * sinHalfHorizontal;
+
+	Frustum frustum;
+	frustum.m_planes[FRUSTUM_PLANE_NEAR] = MakePlaneThroughPoint(forward, position + forward * nearZ);
+	frustum.m_planes[FRUSTUM_PLANE_FAR] = MakePlaneThroughPoint(forward * -1.f, position + forward * farZ);
+	frustum.m_planes[FRUSTUM_PLANE_LEFT] = MakePlaneThroughPoint(forward * sinHalfHorizontal - left * cosHalfHorizontal, position);
+	frustum.m_planes[FRUSTUM_PLANE_RIGHT] = MakePlaneThroughPoint(forward * sinHalfHorizontal + left * cosHalfHorizontal, position);
+	frustum.m_planes[FRUSTUM_PLANE_TOP] = MakePlaneThroughPoint(forward * sinHalfVertical - up * cosHalfVertical, position);
+	frustum.m_planes[FRUSTUM_PLANE_BOTTOM] = MakePlaneThroughPoint(forward * sinHalfVertical + up * cosHalfVertical, position);
+	return frustum;
+}
+
+float Frustum::GetProjectionScale(float fovDegrees)
+{
+	// fovDegrees is vertical, matching Camera::SetPerspectiveView
+	return 1.f / TanDegrees(0.5f * fovDegrees);
+}
+
+bool Frustum::IsSphereVisible(Vec3 const& center, float radius) const
+{
+	for (int planeIndex = 0; planeIndex < NUM_FRUSTUM_PLANES; ++planeIndex)
+	{
+		FrustumPlane const& plane = m_planes[planeIndex];
+		if (DotProduct3D(plane.m_normal, center) - plane.m_distance < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int Frustum::CullSpheres(int numSpheres, float const* centersX, float const* centersY, float const* centersZ, float const* radii, unsigned char* out_isVisible) const
+{
+	int numVisible = 0;
+	int sphereIndex = 0;
+
+	// Four spheres at a time against all six planes
+	for (; sphereIndex + 4 <= numSpheres; sphereIndex += 4)
+	{
+		__m128 x = _mm_loadu_ps(centersX + sphereIndex);
+		__m128 y = _mm_loadu_ps(centersY + sphereIndex);
+		__m128 z = _mm_loadu_ps(centersZ + sphereIndex);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii + sphereIndex));
+
+		__m128 outsideMask = _mm_setzero_ps();
+		for (int planeIndex = 0; planeIndex < NUM_FRUSTUM_PLANES; ++planeIndex)
+		{
+			FrustumPlane const& plane = m_planes[planeIndex];
+			__m128 distance = _mm_mul_ps(x, _mm_set1_ps(plane.m_normal.x));
+			distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.m_normal.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.m_normal.z)));
+			distance = _mm_sub_ps(distance, _mm_set1_ps(plane.m_distance));
+			outsideMask = _mm_or_ps(outsideMask, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		int outsideBits = _mm_movemask_ps(outsideMask);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			unsigned char isVisible = (outsideBits & (1 << lane)) == 0 ? 1 : 0;
+			out_isVisible[sphereIndex + lane] = isVisible;
+			numVisible += isVisible;
+		}
+	}
+
+	for (; sphereIndex < numSpheres; ++sphereIndex)
+	{
+		unsigned char isVisible = IsSphereVisible(Vec3(centersX[sphereIndex], centersY[sphereIndex], centersZ[sphereIndex]), radii[sphereIndex]) ? 1 : 0;
+		out_isVisible[sphereIndex] = isVisible;
+		numVisible += isVisible;
+	}
+
+	return numVisible;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/EulerAngles.hpp"
+// -----------------------------------------------------------------------------
+struct FrustumPlane
+{
+	Vec3 m_normal;
+	float m_distance = 0.f;
+};
+// -----------------------------------------------------------------------------
+enum FrustumPlaneID
+{
+	FRUSTUM_PLANE_NEAR,
+	FRUSTUM_PLANE_FAR,
+	FRUSTUM_PLANE_LEFT,
+	FRUSTUM_PLANE_RIGHT,
+	FRUSTUM_PLANE_TOP,
+	FRUSTUM_PLANE_BOTTOM,
+	NUM_FRUSTUM_PLANES
+};
+// -----------------------------------------------------------------------------
+// Six inward-facing planes; a point p is inside a plane when
+// DotProduct3D(m_normal, p) >= m_distance.
+// -----------------------------------------------------------------------------
+class Frustum
+{
+public:
+	static Frustum MakePerspective(Vec3 const& position, EulerAngles const& orientation, float aspect, float fovDegrees, float nearZ, float farZ);
+	static float GetProjectionScale(float fovDegrees);	// Half screen heights per unit of view height at unit depth
+
+	bool IsSphereVisible(Vec3 const& center, float radius) const;
+	int  CullSpheres(int numSpheres, float const* centersX, float const* centersY, float const* centersZ, float const* radii, unsigned char* out_isVisible) const;
+
+public:
+	FrustumPlane m_planes[NUM_FRUSTUM_PLANES];
+};
\ No newline at end of file
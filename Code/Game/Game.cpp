@@ -2,10 +2,16 @@
 #include "Game/GameCommon.h"
 #include "Game/App.h"
 #include "Game/Player.hpp"
-#include "Game/Prop.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/Profiler.hpp"
+#include "Game/SceneFile.hpp"
+#include "Game/TextureStreamer.hpp"
+#include "Game/FrameArena.hpp"
+#include "Game/TransformKernels.hpp"
 
 #include "Engine/Input/InputSystem.h"
 #include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/SpriteSheet.hpp"
 #include "Engine/Window/Window.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Core/Rgba8.h"
@@ -17,6 +23,8 @@
 #include "Engine/Core/DebugRender.hpp"
 #include "Engine/Math/MathUtils.h"
 #include "Engine/Math/AABB3.hpp"
+#include <math.h>
+#include <string.h>
 
 Game::Game(App* owner)
 	: m_app(owner)
@@ -29,6 +37,42 @@ Game::~Game()
 
 void Game::StartUp()
 {
+	SubscribeEventCallbackFunction("TestJobSystem", Command_TestJobSystem);
+	SubscribeEventCallbackFunction("ConvertScene", Command_ConvertScene);
+	SubscribeEventCallbackFunction("TestTransformKernels", Command_TestTransformKernels);
+
+	// Spatial index over the grid area, props outside it are kept in the edge cells
+	m_spatialGrid.Initialize(Vec2(-50.f, -50.f), Vec2(50.f, 50.f), 4.f);
+
+	// Moving props are kept over the same area, between the ground plane and a ceiling
+	CollisionSystemConfig collisionConfig;
+	collisionConfig.m_dynamicBounds = AABB3(-50.f, -50.f, 0.f, 50.f, 50.f, 20.f);
+	m_collisionSystem.Initialize(collisionConfig);
+
+	// Create the player, then the props from the baked scene; benchmark scenes start from an empty world so only their own props are measured
+	m_player = new Player(this, Vec3(-1.f, 0.f, 0.5f));
+	if (!m_app->IsBenchmark())
+	{
+		LoadScene(DEFAULT_SCENE_PATH);
+	}
+
+	// Initialize the grid
+	InitializeGrid();
+	m_debugPrimitives.Startup(!IsHeadless());
+
+	// Prime the pipeline so the first update has a snapshot to build from
+	CaptureFrameSnapshot(m_pendingSnapshotIndex);
+	m_renderedSnapshotIndex = m_pendingSnapshotIndex;
+
+	// Headless runs draw into a null backend and have no dev console or debug renderer
+	if (IsHeadless())
+	{
+		m_renderStateTracker.SetNullBackend(true);
+		return;
+	}
+
+	InitializeHud();
+
 	// Write control interface into devconsole
 	g_theDevConsole->AddLine(Rgba8::CYAN, "Welcome to Protogame3D!");
 	g_theDevConsole->AddLine(Rgba8::SEAWEED, "----------------------------------------------------------------------");
@@ -52,15 +96,6 @@ void Game::StartUp()
 	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, "7   - Spanws a orientation message");
 	g_theDevConsole->AddLine(Rgba8::SEAWEED, "----------------------------------------------------------------------");
 
-	// Create and push back the entities
-	m_player = new Player(this, Vec3(-1.f, 0.f, 0.5f));
-	m_cube = new Prop(this, Vec3(2.f, 2.f, 0.f));
-	m_identicalCube = new Prop(this, Vec3(-2.f, -2.f, 0.f));
-	m_sphere = new Prop(this, Vec3(10.f, -5.f, 1.f));
-
-	m_allEntities.push_back(m_cube);
-	m_allEntities.push_back(m_identicalCube);
-
 	// Create basis with debug arrows, giving them infinite duration
 	float arrowRadius = 0.15f;
 	DebugAddWorldArrow(Vec3::ZERO, Vec3::XAXE, arrowRadius, -1.f, Rgba8::RED);
@@ -87,49 +122,140 @@ void Game::StartUp()
 
 	// Adding a plus crosshair with infinite duration
 	DebugAddScreenText("+", AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 20.f, Vec2::ONEHALF, -1.f);
-
-	// Initialize the grid
-	InitializeGrid();
 }
 
 void Game::Update()
 {
+	PROFILE_SCOPE("Game::Update");
+
+	// Headless runs take exactly one step per frame so a given frame count always simulates the same thing
+	float frameSeconds = IsHeadless() ? m_simulationStepSeconds : static_cast<float>(m_gameClock.GetDeltaSeconds());
+
+	// A replayed frame carries the delta it was recorded with, so the player and the props step exactly as they did then
+	UpdatePlayerInput(frameSeconds);
+
 	// Setting clock time variables
-	double deltaSeconds = m_gameClock.GetDeltaSeconds();
+	double deltaSeconds = static_cast<double>(m_playerInput.m_deltaSeconds);
 	double totalTime    = Clock::GetSystemClock().GetTotalSeconds();
 	double frameRate    = Clock::GetSystemClock().GetFrameRate();
 	double scale        = Clock::GetSystemClock().GetTimeScale();
 
-	m_colorBrightness += 30.f * static_cast<float>(deltaSeconds);
-
-	// Brightness change over few seconds
-	float sinColor = fabsf(SinDegrees(m_colorBrightness));
-	unsigned char colorValue = static_cast<unsigned char>(GetClamped(sinColor, 0.f, 1.f) * 255);
-	m_identicalCube->m_color = Rgba8(colorValue, colorValue, colorValue, 255);
-
-	// Rotate about the x and y axis by 30 degrees
-	m_cube->m_orientation.m_pitchDegrees += 30.f * static_cast<float>(deltaSeconds);
-	m_cube->m_orientation.m_rollDegrees += 30.f * static_cast<float>(deltaSeconds);
-
-	// Rotate sphere about z
-	m_sphere->m_orientation.m_yawDegrees += 45.f * static_cast<float>(deltaSeconds);
+	// Build the render list for the last simulated frame in the background while this frame simulates
+	int buildSnapshotIndex = m_pendingSnapshotIndex;
+	JobCounter buildCounter;
+	g_theJobSystem->SubmitJob([this, buildSnapshotIndex]()
+		{
+			PROFILE_SCOPE("Game::BuildRenderCommands");
+			double buildStartSeconds = GetCurrentTimeSeconds();
+			BuildRenderCommands(m_frameSnapshots[buildSnapshotIndex]);
+			m_lastBuildRenderCommandsSeconds = GetCurrentTimeSeconds() - buildStartSeconds;
+		}, buildCounter);
 
-	// Set text for position, time, FPS, and scale
-	std::string positionText = Stringf("Player position: %0.2f %0.2f %0.2f", m_player->m_position.x, m_player->m_position.y, m_player->m_position.z);
-	std::string timeScaleText = Stringf("Time: %0.2fs FPS: %0.2f Scale: %0.2f", totalTime, frameRate, scale);
-	DebugAddScreenText(positionText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.f, 0.97f), 0.f);
-	DebugAddScreenText(timeScaleText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 15.f, Vec2(0.98f, 0.97f), 0.f);
+	m_simulationAccumulatorSeconds += deltaSeconds;
+	m_numSimulationStepsThisFrame = 0;
+	while (m_simulationAccumulatorSeconds >= static_cast<double>(m_simulationStepSeconds) && m_numSimulationStepsThisFrame < MAX_SIMULATION_STEPS_PER_FRAME)
+	{
+		SimulateStep(m_simulationStepSeconds);
+		m_simulationAccumulatorSeconds -= static_cast<double>(m_simulationStepSeconds);
+		++m_numSimulationStepsThisFrame;
+	}
+	if (m_numSimulationStepsThisFrame == MAX_SIMULATION_STEPS_PER_FRAME && m_simulationAccumulatorSeconds >= static_cast<double>(m_simulationStepSeconds))
+	{
+		// Too far behind to catch up; drop the backlog rather than spiral
+		m_simulationAccumulatorSeconds = 0.0;
+	}
+	m_simulationBlend = static_cast<float>(m_simulationAccumulatorSeconds / static_cast<double>(m_simulationStepSeconds));
 
+	// The camera follows input every frame so it stays responsive at any render rate
 	m_player->Update(static_cast<float>(deltaSeconds));
+	m_debugPrimitives.Update(totalTime);
 
 	AdjustForPauseAndTimeDistortion(static_cast<float>(deltaSeconds));
 	KeyInputPresses();
 
 	UpdateCameras();
+
+	// Render draws the snapshot that was just built, and this frame's state becomes the next one to build
+	{
+		PROFILE_SCOPE("Game::WaitForRenderCommands");
+		g_theJobSystem->WaitForCounter(buildCounter);
+	}
+	m_renderedSnapshotIndex = buildSnapshotIndex;
+	m_pendingSnapshotIndex = 1 - buildSnapshotIndex;
+	UpdateTextureStreaming(m_frameSnapshots[buildSnapshotIndex]);
+	{
+		PROFILE_SCOPE("Game::CaptureFrameSnapshot");
+		CaptureFrameSnapshot(m_pendingSnapshotIndex);
+	}
+
+	if (IsHeadless())
+	{
+		return;
+	}
+
+	// Set text for position, time, FPS, and scale
+	m_positionText.Printf("Player position: %0.2f %0.2f %0.2f", m_player->m_position.x, m_player->m_position.y, m_player->m_position.z);
+	m_timeScaleText.Printf("Time: %0.2fs FPS: %0.2f Scale: %0.2f Sim: %0.0fHz x%d", totalTime, frameRate, scale, 1.f / m_simulationStepSeconds, m_numSimulationStepsThisFrame);
+
+	// Render stats from the last completed frame
+	RenderStats const& renderStats = m_renderStateTracker.GetLastFrameStats();
+	m_renderStatsText.Printf("Draws: %d State changes: %d issued %d filtered", renderStats.m_numDrawCalls, renderStats.m_numStateChangesIssued,
+		renderStats.m_numStateChangesFiltered);
+	m_visibilityStatsText.Printf("Visible: %d/%d Occluded: %d LOD: %d/%d/%d/%d Debug spheres: %d", m_numVisibleEntities, m_entities.GetNumEntities(),
+		m_numOccludedEntities, m_numEntitiesAtLod[0], m_numEntitiesAtLod[1], m_numEntitiesAtLod[2], m_numEntitiesAtLod[3], m_debugPrimitives.GetNumLivePrimitives());
+
+	// Transient memory from the last completed frame, toggled with the FrameArenaReport command
+	if (g_theFrameArena->IsReportVisible())
+	{
+		m_frameArenaText.Printf("Frame arena: %zu bytes last frame, peak %zu, %d overflows", g_theFrameArena->GetLastFrameBytes(), g_theFrameArena->GetPeakFrameBytes(),
+			g_theFrameArena->GetLastFrameNumOverflows());
+	}
+
+	// Profiler zones for the last frame, toggled with the ProfileOverlay command
+	if (g_theProfiler->IsOverlayVisible())
+	{
+		FrameVector<ProfileReportRow> profileRows;
+		g_theProfiler->GetLastFrameRows(profileRows);
+		m_profileOverlayTexts[0].Printf("Last frame: %.3fms", g_theProfiler->GetLastFrameSeconds() * 1000.0);
+
+		// Rows past the last line are summarized rather than dropped without a trace
+		int numRows = static_cast<int>(profileRows.size());
+		int numRowLines = numRows < PROFILE_OVERLAY_MAX_LINES - 1 ? numRows : PROFILE_OVERLAY_MAX_LINES - 2;
+		for (int rowIndex = 0; rowIndex < numRowLines; ++rowIndex)
+		{
+			ProfileReportRow const& row = profileRows[rowIndex];
+			if (row.m_name == nullptr)
+			{
+				m_profileOverlayTexts[1 + rowIndex].Printf("Thread %d", row.m_threadID);
+			}
+			else
+			{
+				m_profileOverlayTexts[1 + rowIndex].Printf("%*s%-28s %8.3fms %4dx", 2 + row.m_depth * 2, "", row.m_name, row.m_totalSeconds * 1000.0, row.m_numCalls);
+			}
+		}
+		m_numProfileOverlayLines = 1 + numRowLines;
+		if (numRowLines < numRows)
+		{
+			m_profileOverlayTexts[m_numProfileOverlayLines].Printf("... %d more rows", numRows - numRowLines);
+			m_numProfileOverlayLines += 1;
+		}
+	}
 }
 
 void Game::Render() const
 {
+	PROFILE_SCOPE("Game::Render");
+
+	if (IsHeadless())
+	{
+		// Same draw stream as a windowed frame, counted by the tracker instead of reaching a device
+		m_renderStateTracker.BeginFrame();
+		RenderEntities();
+		RenderGrid();
+		m_debugPrimitives.Render(m_renderStateTracker);
+		return;
+	}
+
 	if (m_isAttractMode == true)
 	{
 		g_theRenderer->BeginCamera(m_screenCamera);
@@ -138,34 +264,65 @@ void Game::Render() const
 	}
 	if (m_isAttractMode == false)
 	{
-		g_theRenderer->BeginCamera(m_player->GetPlayerCamera());
+		// The world is drawn from the same snapshot its render list was built from, so camera and props stay in step
+		Camera const& worldCamera = m_frameSnapshots[m_renderedSnapshotIndex].m_worldCamera;
+		g_theRenderer->BeginCamera(worldCamera);
 		g_theRenderer->ClearScreen(Rgba8(70, 70, 70, 255));
+		m_renderStateTracker.BeginFrame();
 		RenderEntities();
-		m_sphere->RenderSphere();
 		RenderGrid();
-		g_theRenderer->EndCamera(m_player->GetPlayerCamera());
+		m_debugPrimitives.Render(m_renderStateTracker);
+		g_theRenderer->EndCamera(worldCamera);
 
-		DebugRenderWorld(m_player->GetPlayerCamera());
-		DebugRenderScreen(m_screenCamera);
+		{
+			PROFILE_SCOPE("DebugRenderWorld");
+			DebugRenderWorld(worldCamera);
+		}
+		{
+			PROFILE_SCOPE("DebugRenderScreen");
+			DebugRenderScreen(m_screenCamera);
+		}
+		RenderHud();
 	}
 }
 
 void Game::Shutdown()
 {
-	for (size_t entityIndex = 0; entityIndex < m_allEntities.size(); ++entityIndex)
+	// A benchmark starts a new game per scene, which subscribes these again
+	UnsubscribeEventCallbackFunction("TestJobSystem", Command_TestJobSystem);
+	UnsubscribeEventCallbackFunction("ConvertScene", Command_ConvertScene);
+	UnsubscribeEventCallbackFunction("TestTransformKernels", Command_TestTransformKernels);
+
+	delete m_player;
+	m_player = nullptr;
+
+	m_grid.Release();
+	m_debugPrimitives.Shutdown();
+
+	delete m_hudGlyphSheet;
+	m_hudGlyphSheet = nullptr;
+	m_spatialGrid.Clear();
+	m_entities.Clear();
+
+	m_renderCommands.Release();
+	m_meshCache.Clear();
+	for (size_t sceneIndex = 0; sceneIndex < m_loadedScenes.size(); ++sceneIndex)
 	{
-		delete m_allEntities[entityIndex];
+		delete m_loadedScenes[sceneIndex];
 	}
-	m_allEntities.clear();
+	m_loadedScenes.clear();
 }
 
 void Game::InitializeGrid()
 {
+	// Fine lines are tiled so distant tiles can be dropped, major lines are always drawn
+	m_grid.Initialize(Vec2(-50.f, -50.f), Vec2(50.f, 50.f), 4, 4);
+
 	// Layout
 	for (int gridIndex = 0; gridIndex < 100; ++gridIndex)
 	{
-		AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.01f + gridIndex, -0.005f, 50.f, -49.99f + gridIndex, 0.005f), Rgba8::DARKGRAY);
-		AddVertsForAABB3D(m_gridVerts, AABB3(-50.01f + gridIndex, -50.0f, -0.005f, -49.99f + gridIndex, 50.f, 0.005f), Rgba8::DARKGRAY);
+		m_grid.AddFineLine(AABB3(-50.f, -50.01f + gridIndex, -0.005f, 50.f, -49.99f + gridIndex, 0.005f), Rgba8::DARKGRAY);
+		m_grid.AddFineLine(AABB3(-50.01f + gridIndex, -50.0f, -0.005f, -49.99f + gridIndex, 50.f, 0.005f), Rgba8::DARKGRAY);
 	}
 
 	// Y axis
@@ -173,11 +330,11 @@ void Game::InitializeGrid()
 	{
 		if (x == 50)
 		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::GREEN);
+			m_grid.AddMajorLine(AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::GREEN);
 		}
 		else
 		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::SEAWEED);
+			m_grid.AddMajorLine(AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::SEAWEED);
 		}
 	}
 
@@ -186,27 +343,72 @@ void Game::InitializeGrid()
 	{
 		if (y == 50)
 		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::RED);
+			m_grid.AddMajorLine(AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::RED);
 		}
 		else
 		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::DARKRED);
+			m_grid.AddMajorLine(AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::DARKRED);
 		}
 	}
+
+	// Uploaded once, nothing is sent to the GPU per frame
+	m_grid.Bake();
+}
+
+void Game::InitializeHud()
+{
+	// Same glyph atlas the dev console and debug renderer use, one 16x16 grid of fixed-width cells
+	Texture* fontTexture = g_theRenderer->CreateOrGetTextureFromFile("Data/Fonts/SquirrelFixedFont.png");
+	m_hudGlyphSheet = new SpriteSheet(*fontTexture, IntVec2(16, 16));
+
+	AABB2 screenBox(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y);
+	m_positionText.Initialize(m_hudGlyphSheet, screenBox, 10.f, Vec2(0.f, 0.97f));
+	m_timeScaleText.Initialize(m_hudGlyphSheet, screenBox, 15.f, Vec2(0.98f, 0.97f));
+	m_renderStatsText.Initialize(m_hudGlyphSheet, screenBox, 10.f, Vec2(0.f, 0.94f));
+	m_visibilityStatsText.Initialize(m_hudGlyphSheet, screenBox, 10.f, Vec2(0.f, 0.925f));
+	m_frameArenaText.Initialize(m_hudGlyphSheet, screenBox, 10.f, Vec2(0.f, 0.91f));
+	for (int lineIndex = 0; lineIndex < PROFILE_OVERLAY_MAX_LINES; ++lineIndex)
+	{
+		m_profileOverlayTexts[lineIndex].Initialize(m_hudGlyphSheet, screenBox, 10.f, Vec2(0.f, 0.895f - 0.015f * static_cast<float>(lineIndex)));
+	}
 }
 
 void Game::KeyInputPresses()
 {
 	// Attract Mode
-	if (g_theInput->WasKeyJustPressed(' '))
+	if (m_playerInput.WasButtonJustPressed(PLAYER_INPUT_START))
 	{
 		m_isAttractMode = false;
 	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC))
+	if (m_playerInput.WasButtonJustPressed(PLAYER_INPUT_ATTRACT))
 	{
 		m_isAttractMode = true;
 	}}
 
+void Game::UpdatePlayerInput(float deltaSeconds)
+{
+	if (m_isReplayingInput)
+	{
+		if (m_replayFrameIndex < m_inputRecording.GetNumFrames())
+		{
+			m_playerInput = m_inputRecording.GetFrame(m_replayFrameIndex);
+			++m_replayFrameIndex;
+			return;
+		}
+
+		// Out of recorded frames; control goes back to live input
+		m_isReplayingInput = false;
+		m_inputRecording.Clear();
+		DebuggerPrintf("Input replay finished after %d frames\n", m_replayFrameIndex);
+	}
+
+	m_playerInput = PlayerInputFrame::CaptureLive(*g_theInput, deltaSeconds);
+	if (m_isRecordingInput)
+	{
+		m_inputRecording.AppendFrame(m_playerInput);
+	}
+}
+
 void Game::AdjustForPauseAndTimeDistortion(float deltaSeconds) {
 
 	UNUSED(deltaSeconds);
@@ -236,20 +438,573 @@ void Game::AdjustForPauseAndTimeDistortion(float deltaSeconds) {
 	}
 }
 
+EntityHandle Game::SpawnProp(Vec3 const& position, MeshShape shape)
+{
+	// Geometry is built once per shape and shared by every prop that uses it
+	MeshKey meshKey = MeshKey::MakeFullDetail(shape);
+	int textureID = -1;
+	if (shape == MeshShape::SPHERE)
+	{
+		textureID = g_theTextureStreamer->RequestTexture("Data/Images/TestUV.png");
+	}
+	int meshID = m_meshCache.CreateOrGetMeshID(meshKey);
+	float boundingRadius = m_meshCache.GetMesh(meshID).m_boundingRadius;
+	return m_entities.CreateEntity(position, Rgba8::WHITE, meshID, boundingRadius, textureID);
+}
+
+bool Game::LoadScene(std::string const& filePath)
+{
+	// Meshes use the file's vertexes and indexes in place, so the mapping stays open until Shutdown
+	SceneFile* sceneFile = new SceneFile();
+	std::string error;
+	if (!sceneFile->Open(filePath, error))
+	{
+		ERROR_RECOVERABLE(Stringf("Could not load scene \"%s\": %s", filePath.c_str(), error.c_str()));
+		delete sceneFile;
+		return false;
+	}
+	m_loadedScenes.push_back(sceneFile);
+
+	// Meshes and textures are resolved once, entity records then only index into them
+	std::vector<int> meshIDs(static_cast<size_t>(sceneFile->GetNumMeshes()));
+	for (int meshIndex = 0; meshIndex < sceneFile->GetNumMeshes(); ++meshIndex)
+	{
+		SceneMeshRecord const& meshRecord = sceneFile->GetMesh(meshIndex);
+		MeshKey meshKey;
+		meshKey.m_shape = static_cast<MeshShape>(meshRecord.m_shape);
+		meshKey.m_numSlices = meshRecord.m_numSlices;
+		meshKey.m_numStacks = meshRecord.m_numStacks;
+		meshIDs[meshIndex] = m_meshCache.CreateOrGetMeshIDFromData(meshKey, static_cast<Vertex_PCU const*>(sceneFile->GetBytesAt(meshRecord.m_vertexesOffset)),
+			meshRecord.m_numVertexes, sceneFile->GetBytesAt(meshRecord.m_indexesOffset), static_cast<MeshIndexFormat>(meshRecord.m_indexFormat), meshRecord.m_numIndexes);
+	}
+
+	// Texture requests return immediately; the images decode in the background and show a placeholder until then
+	std::vector<int> textureIDs(static_cast<size_t>(sceneFile->GetNumTextures()), -1);
+	for (int textureIndex = 0; textureIndex < sceneFile->GetNumTextures(); ++textureIndex)
+	{
+		textureIDs[textureIndex] = g_theTextureStreamer->RequestTexture(sceneFile->GetTexturePath(textureIndex));
+	}
+
+	int numSceneEntities = sceneFile->GetNumEntities();
+	SceneEntityRecord const* entityRecords = sceneFile->GetEntities();
+	m_entities.Reserve(m_entities.GetNumEntities() + numSceneEntities);
+	for (int recordIndex = 0; recordIndex < numSceneEntities; ++recordIndex)
+	{
+		SceneEntityRecord const& record = entityRecords[recordIndex];
+		int meshID = meshIDs[record.m_meshIndex];
+		int textureID = record.m_textureIndex >= 0 ? textureIDs[record.m_textureIndex] : -1;
+		Rgba8 color(record.m_color[0], record.m_color[1], record.m_color[2], record.m_color[3]);
+		Vec3 position(record.m_position[0], record.m_position[1], record.m_position[2]);
+
+		EntityHandle handle = m_entities.CreateEntity(position, color, meshID, m_meshCache.GetMesh(meshID).m_boundingRadius, textureID);
+		m_entities.SetOrientation(handle, EulerAngles(record.m_orientationDegrees[0], record.m_orientationDegrees[1], record.m_orientationDegrees[2]));
+		int entityIndex = m_entities.GetIndex(handle);
+		m_entities.m_angularVelocities[entityIndex] = EulerAngles(record.m_angularVelocityDegrees[0], record.m_angularVelocityDegrees[1], record.m_angularVelocityDegrees[2]);
+		if ((record.m_flags & SCENE_ENTITY_FLAG_PULSE_COLOR) != 0)
+		{
+			m_pulsingEntities.push_back(handle);
+		}
+		if ((record.m_flags & SCENE_ENTITY_FLAG_OCCLUDER) != 0)
+		{
+			m_occluderEntities.push_back(handle);
+		}
+	}
+
+	// Build the loaded poses now so the first interpolated frame does not blend from an unrotated prop
+	m_entities.UpdateWorldTransforms();
+	m_entities.m_previousWorldTransforms = m_entities.m_worldTransforms;
+	m_entities.m_previousTransformOrientations = m_entities.m_transformOrientations;
+	MarkSnapshotEntitiesStale(m_entities.GetUpdatedTransformIndexes());
+	return true;
+}
+
+EntityRaycastResult Game::RaycastVsEntities(Vec3 const& start, Vec3 const& forwardNormal, float maxDist) const
+{
+	return m_spatialGrid.Raycast(m_entities, start, forwardNormal, maxDist);
+}
+
+bool Game::ResolvePlayerCollision(CollisionCapsule& capsule) const
+{
+	return m_collisionSystem.ResolveCapsule(m_entities, m_spatialGrid, capsule);
+}
+
+void Game::SpawnCollisionStressBodies(int numBodies)
+{
+	// Alternating cubes and spheres scattered through the collision bounds, each moving and spinning in a random direction
+	RandomNumberGenerator rng;
+	m_entities.Reserve(m_entities.GetNumEntities() + numBodies);
+	for (int bodyIndex = 0; bodyIndex < numBodies; ++bodyIndex)
+	{
+		Vec3 position(rng.RollRandomFloatInRange(-49.f, 49.f), rng.RollRandomFloatInRange(-49.f, 49.f), rng.RollRandomFloatInRange(1.f, 19.f));
+		EntityHandle handle = SpawnProp(position, (bodyIndex & 1) != 0 ? MeshShape::SPHERE : MeshShape::CUBE);
+		int entityIndex = m_entities.GetIndex(handle);
+		m_entities.m_linearVelocities[entityIndex] = Vec3(rng.RollRandomFloatInRange(-3.f, 3.f), rng.RollRandomFloatInRange(-3.f, 3.f), rng.RollRandomFloatInRange(-3.f, 3.f));
+		m_entities.m_angularVelocities[entityIndex] = EulerAngles(rng.RollRandomFloatInRange(-90.f, 90.f), 0.f, 0.f);
+	}
+}
+
+void Game::SpawnBenchmarkScene(BenchmarkScene const& scene)
+{
+	// Spinning props packed into the view in front of the player, so every one of them is transformed, culled and drawn
+	RandomNumberGenerator rng;
+	int numProps = scene.m_numCubes + scene.m_numSpheres;
+	m_entities.Reserve(m_entities.GetNumEntities() + numProps + scene.m_numOccluders);
+	for (int propIndex = 0; propIndex < numProps; ++propIndex)
+	{
+		Vec3 position(rng.RollRandomFloatInRange(2.f, 50.f), rng.RollRandomFloatInRange(-25.f, 25.f), rng.RollRandomFloatInRange(0.5f, 10.f));
+		EntityHandle handle = SpawnProp(position, propIndex < scene.m_numCubes ? MeshShape::CUBE : MeshShape::SPHERE);
+		m_entities.m_angularVelocities[m_entities.GetIndex(handle)] = EulerAngles(rng.RollRandomFloatInRange(-90.f, 90.f), 0.f, 0.f);
+	}
+
+	// A wall of occluder cubes across the middle of the prop volume, so the props behind and below its top edge are occlusion culled
+	for (int occluderIndex = 0; occluderIndex < scene.m_numOccluders; ++occluderIndex)
+	{
+		int column = occluderIndex % BENCHMARK_OCCLUDER_WALL_WIDTH;
+		int row = (occluderIndex / BENCHMARK_OCCLUDER_WALL_WIDTH) % BENCHMARK_OCCLUDER_WALL_HEIGHT;
+		Vec3 position(12.f, static_cast<float>(column - BENCHMARK_OCCLUDER_WALL_WIDTH / 2), 0.5f + static_cast<float>(row));
+		m_occluderEntities.push_back(SpawnProp(position, MeshShape::CUBE));
+	}
+
+	// Fading debug spheres that stay alive for the whole run, so the pool rewrites their colors every frame
+	for (int primitiveIndex = 0; primitiveIndex < scene.m_numDebugPrimitives; ++primitiveIndex)
+	{
+		Vec3 position(rng.RollRandomFloatInRange(2.f, 50.f), rng.RollRandomFloatInRange(-25.f, 25.f), rng.RollRandomFloatInRange(0.5f, 10.f));
+		m_debugPrimitives.AddWorldSphere(position, 0.2f, 3600.f, Rgba8::WHITE, Rgba8::RED);
+	}
+
+	// Start the interpolation from the new scene rather than blending in from an empty one
+	m_entities.UpdateWorldTransforms();
+	m_entities.m_previousWorldTransforms = m_entities.m_worldTransforms;
+	m_entities.m_previousTransformOrientations = m_entities.m_transformOrientations;
+	MarkSnapshotEntitiesStale(m_entities.GetUpdatedTransformIndexes());
+}
+
+CollisionStats const& Game::GetCollisionStats() const
+{
+	return m_collisionSystem.GetStats();
+}
+
+RenderStats const& Game::GetLastFrameRenderStats() const
+{
+	return m_renderStateTracker.GetLastFrameStats();
+}
+
+double Game::GetLastBuildRenderCommandsSeconds() const
+{
+	return m_lastBuildRenderCommandsSeconds;
+}
+
+size_t Game::GetNumDrawnInstances() const
+{
+	return m_renderCommands.GetNumInstances() + m_renderCommands.GetNumMovingInstances();
+}
+
+size_t Game::GetNumRebakedInstances() const
+{
+	return m_renderCommands.GetNumBakedInstances();
+}
+
+size_t Game::GetNumMovingInstances() const
+{
+	return m_renderCommands.GetNumMovingInstances();
+}
+
+int Game::GetNumOccludedEntities() const
+{
+	return m_numOccludedEntities;
+}
+
+void Game::SetOcclusionCullingEnabled(bool isEnabled)
+{
+	// Picked up by the next captured snapshot, so the render-list job never sees it change mid-build
+	m_isOcclusionCullingEnabled = isEnabled;
+}
+
+int Game::GetNumEntitiesAtLod(int lod) const
+{
+	return m_numEntitiesAtLod[lod];
+}
+
+void Game::SetMeshLodEnabled(bool isEnabled)
+{
+	// Like occlusion culling, takes effect from the next captured snapshot
+	m_isMeshLodEnabled = isEnabled;
+}
+
+bool Game::ExportOcclusionDepthImage(std::string const& filePath) const
+{
+	// Only safe between frames, once the render-list job that draws into the buffer has been waited on
+	return m_occlusionBuffer.ExportDepthImage(filePath);
+}
+
+DebugPrimitivePool& Game::GetDebugPrimitives()
+{
+	return m_debugPrimitives;
+}
+
+bool Game::IsHeadless() const
+{
+	return m_app->IsHeadless();
+}
+
+PlayerInputFrame const& Game::GetPlayerInput() const
+{
+	return m_playerInput;
+}
+
+void Game::StartInputRecording()
+{
+	// A recording only replays the same way from the same starting scene, so it always starts from the first frame
+	GUARANTEE_OR_DIE(!m_isReplayingInput, "Game cannot record input while replaying it");
+	m_inputRecording.Clear();
+	m_isRecordingInput = true;
+}
+
+bool Game::SaveInputRecording(std::string const& filePath) const
+{
+	std::string error;
+	if (!m_inputRecording.SaveToFile(filePath, error))
+	{
+		ERROR_RECOVERABLE(Stringf("Could not save input recording \"%s\": %s", filePath.c_str(), error.c_str()));
+		return false;
+	}
+	DebuggerPrintf("Saved %d frames of input to \"%s\"\n", m_inputRecording.GetNumFrames(), filePath.c_str());
+	return true;
+}
+
+bool Game::StartInputReplay(std::string const& filePath)
+{
+	GUARANTEE_OR_DIE(!m_isRecordingInput, "Game cannot replay input while recording it");
+	std::string error;
+	if (!m_inputRecording.LoadFromFile(filePath, error))
+	{
+		ERROR_RECOVERABLE(Stringf("Could not replay input \"%s\": %s", filePath.c_str(), error.c_str()));
+		return false;
+	}
+	m_isReplayingInput = true;
+	m_replayFrameIndex = 0;
+	return true;
+}
+
+int Game::GetNumReplayFrames() const
+{
+	return m_isReplayingInput ? m_inputRecording.GetNumFrames() : 0;
+}
+
 void Game::UpdateCameras()
 {
 	m_screenCamera.SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y));
 }
 
+void Game::SimulateStep(float stepSeconds)
+{
+	PROFILE_SCOPE("Game::SimulateStep");
+
+	// Brightness change over few seconds
+	m_colorBrightness += 30.f * stepSeconds;
+	float sinColor = fabsf(SinDegrees(m_colorBrightness));
+	unsigned char colorValue = static_cast<unsigned char>(GetClamped(sinColor, 0.f, 1.f) * 255);
+	for (size_t pulseIndex = 0; pulseIndex < m_pulsingEntities.size(); ++pulseIndex)
+	{
+		if (m_entities.IsAlive(m_pulsingEntities[pulseIndex]))
+		{
+			int entityIndex = m_entities.GetIndex(m_pulsingEntities[pulseIndex]);
+			m_entities.m_colors[entityIndex] = Rgba8(colorValue, colorValue, colorValue, 255);
+			MarkSnapshotEntityStale(0, entityIndex);
+			MarkSnapshotEntityStale(1, entityIndex);
+		}
+	}
+
+	UpdateEntities(stepSeconds);
+	MarkSnapshotEntitiesStale(m_entities.GetUpdatedTransformIndexes());
+}
+
+void Game::SetSimulationRate(float simulationHz)
+{
+	if (simulationHz <= 0.f)
+	{
+		return;
+	}
+	m_simulationStepSeconds = 1.f / simulationHz;
+	m_simulationAccumulatorSeconds = 0.0;
+}
+
 void Game::UpdateEntities(float deltaSeconds)
 {
-	for (size_t entityIndex = 0; entityIndex < m_allEntities.size(); ++entityIndex)
+	PROFILE_SCOPE("Game::UpdateEntities");
+
+	// Each range only touches its own entities, so the result does not depend on how the work is split
+	constexpr int ENTITIES_PER_JOB = 4096;
+	g_theJobSystem->ParallelFor(m_entities.GetNumEntities(), ENTITIES_PER_JOB, [this, deltaSeconds](int beginIndex, int endIndex)
+		{
+			m_entities.UpdatePositions(deltaSeconds, beginIndex, endIndex);
+			m_entities.UpdateOrientations(deltaSeconds, beginIndex, endIndex);
+		});
+
+	// Contacts move props before their world transforms are rebuilt, so the grid and the snapshot see resolved positions
+	m_collisionSystem.Update(m_entities, m_meshCache);
+	{
+		PROFILE_SCOPE("EntityStore::UpdateWorldTransforms");
+		m_entities.UpdateWorldTransforms();
+	}
+	{
+		PROFILE_SCOPE("SpatialGrid::Update");
+		m_spatialGrid.Update(m_entities);
+	}
+}
+
+void Game::CaptureFrameSnapshot(int snapshotIndex)
+{
+	FrameSnapshot& snapshot = m_frameSnapshots[snapshotIndex];
+	snapshot.m_worldCamera = m_player->GetPlayerCamera();
+	snapshot.m_viewPosition = m_player->m_position;
+	snapshot.m_viewOrientation = m_player->m_orientation;
+	snapshot.m_viewFrustum = m_player->GetViewFrustum();
+	snapshot.m_isOcclusionCullingEnabled = m_isOcclusionCullingEnabled;
+	snapshot.m_isMeshLodEnabled = m_isMeshLodEnabled;
+
+	// The buffer still holds what it was given at its last capture, so only entities changed since then are copied. Spawned
+	// entities are past its old end; a store that shrank has swapped entities into new indexes, so it is copied whole
+	int numEntities = m_entities.GetNumEntities();
+	int numKeptEntities = snapshot.GetNumEntities() <= numEntities ? snapshot.GetNumEntities() : 0;
+	size_t numSnapshotEntities = static_cast<size_t>(numEntities);
+	snapshot.m_worldTransforms.resize(numSnapshotEntities);
+	snapshot.m_isMoving.resize(numSnapshotEntities);
+	snapshot.m_colors.resize(numSnapshotEntities);
+	snapshot.m_meshIDs.resize(numSnapshotEntities);
+	snapshot.m_textureIDs.resize(numSnapshotEntities);
+	snapshot.m_boundingRadii.resize(numSnapshotEntities);
+	snapshot.m_boundsCentersX.resize(numSnapshotEntities);
+	snapshot.m_boundsCentersY.resize(numSnapshotEntities);
+	snapshot.m_boundsCentersZ.resize(numSnapshotEntities);
+	for (int entityIndex = numKeptEntities; entityIndex < numEntities; ++entityIndex)
+	{
+		CopyEntityToSnapshot(snapshot, entityIndex);
+	}
+
+	std::vector<int>& staleEntities = m_staleSnapshotEntities[snapshotIndex];
+	std::vector<unsigned char>& isEntityStale = m_isSnapshotEntityStale[snapshotIndex];
+	for (int entityIndex : staleEntities)
+	{
+		if (entityIndex < numKeptEntities)
+		{
+			CopyEntityToSnapshot(snapshot, entityIndex);
+		}
+		isEntityStale[entityIndex] = 0;
+	}
+	staleEntities.clear();
+
+	// Blended transforms only hold for this capture, so the buffer copies those entities again the next time it is written
+	BlendMovedTransforms(snapshot);
+	for (int entityIndex : m_entities.GetUpdatedTransformIndexes())
+	{
+		MarkSnapshotEntityStale(snapshotIndex, entityIndex);
+	}
+
+	snapshot.m_occluderIndexes.clear();
+	for (size_t occluderIndex = 0; occluderIndex < m_occluderEntities.size(); ++occluderIndex)
+	{
+		if (m_entities.IsAlive(m_occluderEntities[occluderIndex]))
+		{
+			snapshot.m_occluderIndexes.push_back(m_entities.GetIndex(m_occluderEntities[occluderIndex]));
+		}
+	}
+
+	int numTextures = g_theTextureStreamer->GetNumTextures();
+	snapshot.m_textures.resize(static_cast<size_t>(numTextures));
+	for (int textureID = 0; textureID < numTextures; ++textureID)
+	{
+		snapshot.m_textures[textureID] = g_theTextureStreamer->GetTexture(textureID);
+	}
+}
+
+void Game::CopyEntityToSnapshot(FrameSnapshot& snapshot, int entityIndex) const
+{
+	snapshot.m_worldTransforms[entityIndex] = m_entities.m_worldTransforms[entityIndex];
+	snapshot.m_isMoving[entityIndex] = 0;
+	snapshot.m_colors[entityIndex] = m_entities.m_colors[entityIndex];
+	snapshot.m_meshIDs[entityIndex] = m_entities.m_meshIDs[entityIndex];
+	snapshot.m_textureIDs[entityIndex] = m_entities.m_textureIDs[entityIndex];
+	snapshot.m_boundingRadii[entityIndex] = m_entities.m_boundingRadii[entityIndex];
+	snapshot.m_boundsCentersX[entityIndex] = m_entities.m_boundsCentersX[entityIndex];
+	snapshot.m_boundsCentersY[entityIndex] = m_entities.m_boundsCentersY[entityIndex];
+	snapshot.m_boundsCentersZ[entityIndex] = m_entities.m_boundsCentersZ[entityIndex];
+}
+
+void Game::MarkSnapshotEntityStale(int snapshotIndex, int entityIndex)
+{
+	std::vector<unsigned char>& isEntityStale = m_isSnapshotEntityStale[snapshotIndex];
+	if (entityIndex >= static_cast<int>(isEntityStale.size()))
+	{
+		isEntityStale.resize(static_cast<size_t>(m_entities.GetNumEntities() > entityIndex ? m_entities.GetNumEntities() : entityIndex + 1), 0);
+	}
+	if (isEntityStale[entityIndex] == 0)
+	{
+		isEntityStale[entityIndex] = 1;
+		m_staleSnapshotEntities[snapshotIndex].push_back(entityIndex);
+	}
+}
+
+void Game::MarkSnapshotEntitiesStale(std::vector<int> const& entityIndexes)
+{
+	for (int entityIndex : entityIndexes)
+	{
+		MarkSnapshotEntityStale(0, entityIndex);
+		MarkSnapshotEntityStale(1, entityIndex);
+	}
+}
+
+void Game::BlendMovedTransforms(FrameSnapshot& snapshot)
+{
+	// Blend between the last two simulation steps so props move smoothly at render rates above the step rate; only transforms
+	// rebuilt in the last step differ from their previous value. Roots blend their position and orientation and are rebuilt with
+	// the batched kernel, so a spinning prop stays rigid mid-blend and its bounds sit where it is drawn
+	std::vector<int> const& updatedIndexes = m_entities.GetUpdatedTransformIndexes();
+	float blend = m_simulationBlend;
+	m_blendIndexes.clear();
+	m_blendPositions.clear();
+	m_blendOrientations.clear();
+	for (int entityIndex : updatedIndexes)
 	{
-		if (m_allEntities[entityIndex] != nullptr)
+		snapshot.m_isMoving[entityIndex] = 1;
+		if (!m_entities.IsRoot(entityIndex))
 		{
-			m_allEntities[entityIndex]->Update(deltaSeconds);
+			continue;
 		}
+		float const* previousValues = m_entities.m_previousWorldTransforms[entityIndex].m_values;
+		float const* currentValues = m_entities.m_worldTransforms[entityIndex].m_values;
+		EulerAngles const& previousOrientation = m_entities.m_previousTransformOrientations[entityIndex];
+		EulerAngles const& currentOrientation = m_entities.m_transformOrientations[entityIndex];
+		m_blendIndexes.push_back(entityIndex);
+		m_blendPositions.push_back(Vec3(Interpolate(previousValues[Mat44::Tx], currentValues[Mat44::Tx], blend),
+			Interpolate(previousValues[Mat44::Ty], currentValues[Mat44::Ty], blend), Interpolate(previousValues[Mat44::Tz], currentValues[Mat44::Tz], blend)));
+		m_blendOrientations.push_back(EulerAngles(Interpolate(previousOrientation.m_yawDegrees, currentOrientation.m_yawDegrees, blend),
+			Interpolate(previousOrientation.m_pitchDegrees, currentOrientation.m_pitchDegrees, blend),
+			Interpolate(previousOrientation.m_rollDegrees, currentOrientation.m_rollDegrees, blend)));
 	}
+
+	int numBlended = static_cast<int>(m_blendIndexes.size());
+	m_blendTransforms.resize(static_cast<size_t>(numBlended));
+	ComputeModelToWorldTransforms(numBlended, m_blendPositions.data(), m_blendOrientations.data(), m_blendTransforms.data());
+	for (int blendIndex = 0; blendIndex < numBlended; ++blendIndex)
+	{
+		int entityIndex = m_blendIndexes[blendIndex];
+		snapshot.m_worldTransforms[entityIndex] = m_blendTransforms[blendIndex];
+		snapshot.m_boundsCentersX[entityIndex] = m_blendPositions[blendIndex].x;
+		snapshot.m_boundsCentersY[entityIndex] = m_blendPositions[blendIndex].y;
+		snapshot.m_boundsCentersZ[entityIndex] = m_blendPositions[blendIndex].z;
+	}
+
+	// Children are placed relative to their parent's blended transform; parents come first in the updated list
+	for (int entityIndex : updatedIndexes)
+	{
+		if (m_entities.IsRoot(entityIndex))
+		{
+			continue;
+		}
+		int parentIndex = m_entities.GetIndex(m_entities.GetParent(m_entities.GetHandle(entityIndex)));
+		Mat44 localTransform;
+		ComputeModelToWorldTransforms_Reference(1, &m_entities.m_positions[entityIndex], &m_entities.m_transformOrientations[entityIndex], &localTransform);
+		Mat44 worldTransform = snapshot.m_worldTransforms[parentIndex];
+		worldTransform.Append(localTransform);
+		snapshot.m_worldTransforms[entityIndex] = worldTransform;
+		snapshot.m_boundsCentersX[entityIndex] = worldTransform.m_values[Mat44::Tx];
+		snapshot.m_boundsCentersY[entityIndex] = worldTransform.m_values[Mat44::Ty];
+		snapshot.m_boundsCentersZ[entityIndex] = worldTransform.m_values[Mat44::Tz];
+	}
+}
+
+void Game::UpdateTextureStreaming(FrameSnapshot const& builtSnapshot)
+{
+	PROFILE_SCOPE("Game::UpdateTextureStreaming");
+
+	// Textures on visible props count as used, so the streamer will not evict anything the render list about to be drawn points at
+	int numEntities = builtSnapshot.GetNumEntities();
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex)
+	{
+		if (m_entityVisibility[entityIndex] != 0)
+		{
+			g_theTextureStreamer->MarkUsed(builtSnapshot.m_textureIDs[entityIndex]);
+		}
+	}
+	g_theTextureStreamer->Update();
+}
+
+void Game::BuildRenderCommands(FrameSnapshot const& snapshot)
+{
+	// Runs on a worker, so it may only read the snapshot and write render-side state
+
+	// Only props whose bounding sphere touches the player's view frustum are submitted
+	int numEntities = snapshot.GetNumEntities();
+	m_entityVisibility.resize(static_cast<size_t>(numEntities));
+	m_numVisibleEntities = snapshot.m_viewFrustum.CullSpheres(numEntities, snapshot.m_boundsCentersX.data(), snapshot.m_boundsCentersY.data(),
+		snapshot.m_boundsCentersZ.data(), snapshot.m_boundingRadii.data(), m_entityVisibility.data());
+
+	// Then the occluders in view are drawn into the software depth buffer, and any prop whose bounds are hidden behind them is dropped too
+	m_numOccludedEntities = 0;
+	if (snapshot.m_isOcclusionCullingEnabled && !snapshot.m_occluderIndexes.empty())
+	{
+		PROFILE_SCOPE("Game::OcclusionCull");
+		m_occlusionBuffer.BeginFrame(snapshot.m_viewPosition, snapshot.m_viewOrientation, PLAYER_CAMERA_ASPECT, PLAYER_CAMERA_FOV_DEGREES, PLAYER_CAMERA_NEAR, PLAYER_CAMERA_FAR);
+		for (size_t occluderIndex = 0; occluderIndex < snapshot.m_occluderIndexes.size(); ++occluderIndex)
+		{
+			int entityIndex = snapshot.m_occluderIndexes[occluderIndex];
+			if (m_entityVisibility[entityIndex] != 0)
+			{
+				m_occlusionBuffer.RasterizeMesh(m_meshCache.GetMesh(snapshot.m_meshIDs[entityIndex]), snapshot.m_worldTransforms[entityIndex]);
+			}
+		}
+		m_occlusionBuffer.BuildHierarchicalDepth();
+		m_numOccludedEntities = m_occlusionBuffer.CullOccludedSpheres(numEntities, snapshot.m_boundsCentersX.data(), snapshot.m_boundsCentersY.data(),
+			snapshot.m_boundsCentersZ.data(), snapshot.m_boundingRadii.data(), m_entityVisibility.data());
+		m_numVisibleEntities -= m_numOccludedEntities;
+	}
+
+	// Each visible prop picks a tessellation level from its projected radius; distance rather than view depth is used so turning the camera never changes a level
+	float pixelsPerUnitAtUnitDistance = 0.5f * MESH_LOD_REFERENCE_SCREEN_HEIGHT * Frustum::GetProjectionScale(PLAYER_CAMERA_FOV_DEGREES);
+	m_entityLods.resize(static_cast<size_t>(numEntities), MESH_LOD_UNSET);
+	m_meshCache.GetLodMeshIDs(m_lodMeshIDs);
+	for (int lod = 0; lod < MESH_NUM_LODS; ++lod)
+	{
+		m_numEntitiesAtLod[lod] = 0;
+	}
+
+	// Still props that share a mesh and texture are baked into one batch and drawn together; moving ones share the mesh's buffers instead
+	m_renderCommands.Reset();
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex)
+	{
+		if (m_entityVisibility[entityIndex] == 0)
+		{
+			continue;
+		}
+
+		int lod = 0;
+		if (snapshot.m_isMeshLodEnabled)
+		{
+			Vec3 boundsCenter(snapshot.m_boundsCentersX[entityIndex], snapshot.m_boundsCentersY[entityIndex], snapshot.m_boundsCentersZ[entityIndex]);
+			float distance = fmaxf((boundsCenter - snapshot.m_viewPosition).GetLength(), PLAYER_CAMERA_NEAR);
+			float screenRadiusPixels = snapshot.m_boundingRadii[entityIndex] * pixelsPerUnitAtUnitDistance / distance;
+			int previousLod = m_entityLods[entityIndex] == MESH_LOD_UNSET ? -1 : static_cast<int>(m_entityLods[entityIndex]);
+			lod = ChooseMeshLod(screenRadiusPixels, previousLod);
+			m_entityLods[entityIndex] = static_cast<unsigned char>(lod);
+		}
+		++m_numEntitiesAtLod[lod];
+
+		RenderState renderState;
+		int textureID = snapshot.m_textureIDs[entityIndex];
+		renderState.m_texture = textureID >= 0 ? snapshot.m_textures[textureID] : nullptr;
+		int meshID = m_lodMeshIDs[static_cast<size_t>(snapshot.m_meshIDs[entityIndex]) * MESH_NUM_LODS + lod];
+		if (snapshot.m_isMoving[entityIndex] != 0)
+		{
+			m_renderCommands.AddMovingInstance(entityIndex, meshID, renderState, snapshot.m_worldTransforms[entityIndex], snapshot.m_colors[entityIndex]);
+		}
+		else
+		{
+			m_renderCommands.AddInstance(entityIndex, meshID, renderState, snapshot.m_worldTransforms[entityIndex], snapshot.m_colors[entityIndex]);
+		}
+	}
+
+	m_renderCommands.Build(m_meshCache);
 }
 
 void Game::RenderAttractMode() const
@@ -258,22 +1013,153 @@ void Game::RenderAttractMode() const
 
 void Game::RenderEntities() const
 {
-	for (size_t entityIndex = 0; entityIndex < m_allEntities.size(); ++entityIndex)
+	PROFILE_SCOPE("Game::RenderEntities");
+	m_renderCommands.Submit(m_renderStateTracker);
+}
+
+void Game::RenderGrid() const
+{
+	PROFILE_SCOPE("Game::RenderGrid");
+	m_renderStateTracker.SetModelConstants();
+	m_renderStateTracker.SetBlendMode(BlendMode::OPAQUE);
+	m_renderStateTracker.SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+	m_renderStateTracker.SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
+	m_renderStateTracker.BindTexture(nullptr);
+	FrameSnapshot const& snapshot = m_frameSnapshots[m_renderedSnapshotIndex];
+	m_grid.Render(m_renderStateTracker, snapshot.m_viewPosition, snapshot.m_viewFrustum);
+}
+
+void Game::RenderHud() const
+{
+	PROFILE_SCOPE("Game::RenderHud");
+	g_theRenderer->BeginCamera(m_screenCamera);
+
+	// The debug renderer changed state behind the tracker's back
+	m_renderStateTracker.Invalidate();
+	m_renderStateTracker.SetModelConstants();
+	m_renderStateTracker.SetBlendMode(BlendMode::ALPHA);
+	m_renderStateTracker.SetRasterizerMode(RasterizerMode::SOLID_CULL_NONE);
+	m_renderStateTracker.SetDepthMode(DepthMode::DISABLED);
+	m_renderStateTracker.BindTexture(&m_hudGlyphSheet->GetTexture());
+	m_positionText.Render(m_renderStateTracker);
+	m_timeScaleText.Render(m_renderStateTracker);
+	m_renderStatsText.Render(m_renderStateTracker);
+	m_visibilityStatsText.Render(m_renderStateTracker);
+	if (g_theFrameArena->IsReportVisible())
+	{
+		m_frameArenaText.Render(m_renderStateTracker);
+	}
+	if (g_theProfiler->IsOverlayVisible())
 	{
-		if (m_allEntities[entityIndex] != nullptr)
+		for (int lineIndex = 0; lineIndex < m_numProfileOverlayLines; ++lineIndex)
 		{
-			g_theRenderer->SetModelConstants(m_allEntities[entityIndex]->GetModelToWorldTransform(), m_allEntities[entityIndex]->m_color);
-			m_allEntities[entityIndex]->Render();
+			m_profileOverlayTexts[lineIndex].Render(m_renderStateTracker);
 		}
 	}
+
+	g_theRenderer->EndCamera(m_screenCamera);
 }
 
-void Game::RenderGrid() const
+bool Game::Command_ConvertScene(EventArgs& args)
 {
-	g_theRenderer->SetModelConstants();
-	g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
-	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
-	g_theRenderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
-	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->DrawVertexArray(m_gridVerts);
+	// Bakes a text scene description into the binary format LoadScene maps
+	std::string sourcePath = args.GetValue("src", std::string(DEFAULT_SCENE_SOURCE_PATH));
+	std::string destinationPath = args.GetValue("dst", std::string(DEFAULT_SCENE_PATH));
+	std::string error;
+	if (SceneFile::ConvertTextToBinary(sourcePath, destinationPath, error))
+	{
+		g_theDevConsole->AddLine(Rgba8::GREEN, Stringf("ConvertScene: wrote %s", destinationPath.c_str()));
+	}
+	else
+	{
+		g_theDevConsole->AddLine(Rgba8::RED, Stringf("ConvertScene: %s", error.c_str()));
+	}
+	return true;
+}
+
+bool Game::Command_TestJobSystem(EventArgs& args)
+{
+	// Runs the entity update serially and through the job system on the same data and checks they match bit for bit
+	int numEntities = args.GetValue("count", 100000);
+	int numFrames = args.GetValue("frames", 10);
+	float deltaSeconds = 1.f / 60.f;
+
+	EntityStore serialEntities;
+	serialEntities.Reserve(numEntities);
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex)
+	{
+		float offset = static_cast<float>(entityIndex);
+		EntityHandle handle = serialEntities.CreateEntity(Vec3(offset * 0.01f, -offset * 0.02f, 0.f), Rgba8::WHITE, 0, 1.f);
+		serialEntities.m_angularVelocities[serialEntities.GetIndex(handle)] = EulerAngles(offset * 0.1f, 30.f, -offset * 0.05f);
+	}
+	EntityStore parallelEntities = serialEntities;
+
+	double serialStartTime = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		serialEntities.UpdateOrientations(deltaSeconds, 0, numEntities);
+		serialEntities.UpdateWorldTransforms();
+	}
+	double serialSeconds = GetCurrentTimeSeconds() - serialStartTime;
+
+	double parallelStartTime = GetCurrentTimeSeconds();
+	for (int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+	{
+		g_theJobSystem->ParallelFor(numEntities, 4096, [&parallelEntities, deltaSeconds](int beginIndex, int endIndex)
+			{
+				parallelEntities.UpdateOrientations(deltaSeconds, beginIndex, endIndex);
+			});
+		parallelEntities.UpdateWorldTransforms();
+	}
+	double parallelSeconds = GetCurrentTimeSeconds() - parallelStartTime;
+
+	bool isMatch = memcmp(serialEntities.m_orientations.data(), parallelEntities.m_orientations.data(), sizeof(EulerAngles) * numEntities) == 0
+		&& memcmp(serialEntities.m_worldTransforms.data(), parallelEntities.m_worldTransforms.data(), sizeof(Mat44) * numEntities) == 0
+		&& serialEntities.m_boundsCentersX == parallelEntities.m_boundsCentersX
+		&& serialEntities.m_boundsCentersY == parallelEntities.m_boundsCentersY
+		&& serialEntities.m_boundsCentersZ == parallelEntities.m_boundsCentersZ;
+
+	g_theDevConsole->AddLine(isMatch ? Rgba8::GREEN : Rgba8::RED, Stringf("TestJobSystem: %d entities x %d frames, %d workers, results %s",
+		numEntities, numFrames, g_theJobSystem->GetNumWorkerThreads(), isMatch ? "match" : "DIFFER"));
+	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, Stringf("  serial %.2fms, parallel %.2fms", serialSeconds * 1000.0, parallelSeconds * 1000.0));
+	return true;
+}
+
+bool Game::Command_TestTransformKernels(EventArgs& args)
+{
+	// Times the scalar and SSE transform builders on the same random data and reports how far apart their results are
+	int numTransforms = args.GetValue("count", 100000);
+	int numIterations = args.GetValue("iterations", 20);
+
+	RandomNumberGenerator rng;
+	std::vector<Vec3> positions(static_cast<size_t>(numTransforms));
+	std::vector<EulerAngles> orientations(static_cast<size_t>(numTransforms));
+	for (int transformIndex = 0; transformIndex < numTransforms; ++transformIndex)
+	{
+		positions[transformIndex] = Vec3(rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(0.f, 5.f));
+		orientations[transformIndex] = EulerAngles(rng.RollRandomFloatInRange(-3600.f, 3600.f), rng.RollRandomFloatInRange(-90.f, 90.f), rng.RollRandomFloatInRange(-180.f, 180.f));
+	}
+	std::vector<Mat44> referenceTransforms(static_cast<size_t>(numTransforms));
+	std::vector<Mat44> simdTransforms(static_cast<size_t>(numTransforms));
+
+	double referenceStartTime = GetCurrentTimeSeconds();
+	for (int iteration = 0; iteration < numIterations; ++iteration)
+	{
+		ComputeModelToWorldTransforms_Reference(numTransforms, positions.data(), orientations.data(), referenceTransforms.data());
+	}
+	double referenceSeconds = (GetCurrentTimeSeconds() - referenceStartTime) / static_cast<double>(numIterations);
+
+	double simdStartTime = GetCurrentTimeSeconds();
+	for (int iteration = 0; iteration < numIterations; ++iteration)
+	{
+		ComputeModelToWorldTransforms(numTransforms, positions.data(), orientations.data(), simdTransforms.data());
+	}
+	double simdSeconds = (GetCurrentTimeSeconds() - simdStartTime) / static_cast<double>(numIterations);
+
+	float maxDifference = GetMaxTransformDifference(numTransforms, referenceTransforms.data(), simdTransforms.data());
+	bool isMatch = maxDifference < 1e-4f;
+	g_theDevConsole->AddLine(isMatch ? Rgba8::GREEN : Rgba8::RED, Stringf("TestTransformKernels: %d transforms, max difference %g, %s", numTransforms, maxDifference,
+		isMatch ? "match" : "DIFFER"));
+	g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, Stringf("  scalar %.3fms, sse %.3fms, %.2fx", referenceSeconds * 1000.0, simdSeconds * 1000.0, referenceSeconds / simdSeconds));
+	return true;
 }
@@ -1,17 +1,33 @@
 #pragma once
 #include "Game/GameCommon.h"
 #include "Game/Entity.hpp"
+#include "Game/MeshCache.hpp"
+#include "Game/EntityStore.hpp"
+#include "Game/RenderCommandList.hpp"
+#include "Game/RenderStateTracker.hpp"
+#include "Game/SpatialGrid.hpp"
+#include "Game/CollisionSystem.hpp"
+#include "Game/FrameSnapshot.hpp"
+#include "Game/StaticGrid.hpp"
+#include "Game/DebugPrimitivePool.hpp"
+#include "Game/OcclusionBuffer.hpp"
+#include "Game/HudText.hpp"
+#include "Game/PlayerInput.hpp"
+#include "Game/Benchmark.hpp"
 #include "Engine/Renderer/Camera.h"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/EventSystem.hpp"
 // -----------------------------------------------------------------------------
 class Player;
-class Prop;
-//------------------------------------------------------------------------------
-typedef std::vector<Entity*> EntityList;
+class SceneFile;
+class SpriteSheet;
 // -----------------------------------------------------------------------------
-// -----------------------------------------------------------------------------
-static const int MAX_PROPS = 10;
+constexpr char const* DEFAULT_SCENE_PATH = "Data/Scenes/Default.scene";
+constexpr char const* DEFAULT_SCENE_SOURCE_PATH = "Data/Scenes/Default.scenetxt";
+constexpr float DEFAULT_SIMULATION_HZ = 60.f;
+constexpr int MAX_SIMULATION_STEPS_PER_FRAME = 5;
+constexpr int PROFILE_OVERLAY_MAX_LINES = 48;
 // -----------------------------------------------------------------------------
 class Game
 {
@@ -24,30 +40,130 @@ public:
 	void Update();
 	void UpdateCameras();
 	void UpdateEntities(float deltaSeconds);
+	void SimulateStep(float stepSeconds);
+	void SetSimulationRate(float simulationHz);
+	void CaptureFrameSnapshot(int snapshotIndex);
+	void CopyEntityToSnapshot(FrameSnapshot& snapshot, int entityIndex) const;
+	void MarkSnapshotEntityStale(int snapshotIndex, int entityIndex);
+	void MarkSnapshotEntitiesStale(std::vector<int> const& entityIndexes);
+	void BlendMovedTransforms(FrameSnapshot& snapshot);
+	void BuildRenderCommands(FrameSnapshot const& snapshot);
+	void UpdateTextureStreaming(FrameSnapshot const& builtSnapshot);
 
 	void Render() const;
 	void RenderAttractMode() const;
 	void RenderEntities() const;
 	void RenderGrid() const;
+	void RenderHud() const;
 
 	void Shutdown();
 
 	void InitializeGrid();
+	void InitializeHud();
 	void KeyInputPresses();
+	void UpdatePlayerInput(float deltaSeconds);
 	void AdjustForPauseAndTimeDistortion(float deltaSeconds);
+
+	EntityHandle SpawnProp(Vec3 const& position, MeshShape shape);
+	bool LoadScene(std::string const& filePath);
+	EntityRaycastResult RaycastVsEntities(Vec3 const& start, Vec3 const& forwardNormal, float maxDist) const;
+	bool ResolvePlayerCollision(CollisionCapsule& capsule) const;
+	void SpawnCollisionStressBodies(int numBodies);
+	void SpawnBenchmarkScene(BenchmarkScene const& scene);
+	CollisionStats const& GetCollisionStats() const;
+	RenderStats const& GetLastFrameRenderStats() const;
+	double GetLastBuildRenderCommandsSeconds() const;
+	size_t GetNumDrawnInstances() const;
+	size_t GetNumRebakedInstances() const;
+	size_t GetNumMovingInstances() const;
+	int GetNumOccludedEntities() const;
+	void SetOcclusionCullingEnabled(bool isEnabled);
+	bool ExportOcclusionDepthImage(std::string const& filePath) const;
+	int GetNumEntitiesAtLod(int lod) const;
+	void SetMeshLodEnabled(bool isEnabled);
+	DebugPrimitivePool& GetDebugPrimitives();
+	bool IsHeadless() const;
+
+	PlayerInputFrame const& GetPlayerInput() const;
+	void StartInputRecording();
+	bool SaveInputRecording(std::string const& filePath) const;
+	bool StartInputReplay(std::string const& filePath);
+	int GetNumReplayFrames() const;
+
+	static bool Command_TestJobSystem(EventArgs& args);
+	static bool Command_ConvertScene(EventArgs& args);
+	static bool Command_TestTransformKernels(EventArgs& args);
 	bool		m_isAttractMode = true;
 
 private:
 	Camera		m_screenCamera;
 	Camera      m_gameWorldCamera;
 	Clock		m_gameClock;
+	MeshCache	m_meshCache;
+	std::vector<SceneFile*> m_loadedScenes;	// Kept mapped until the mesh cache that points into them is cleared
 
 	Player* m_player = nullptr;
-	Prop* m_cube = nullptr;
-	Prop* m_identicalCube = nullptr;
-	Prop* m_sphere = nullptr;
+	std::vector<EntityHandle> m_pulsingEntities;
+	std::vector<EntityHandle> m_occluderEntities;
 
-	EntityList m_allEntities;
+	EntityStore m_entities;
+	SpatialGrid m_spatialGrid;
+	CollisionSystem m_collisionSystem;
+	mutable RenderCommandList m_renderCommands;	// Submit uploads the chunks that changed
+	mutable RenderStateTracker m_renderStateTracker;
 	float m_colorBrightness = 0.f;
-	std::vector<Vertex_PCU> m_gridVerts;
+	StaticGrid m_grid;
+	DebugPrimitivePool m_debugPrimitives;
+
+	// Per-frame HUD lines, updated in place instead of re-submitted as debug text every frame
+	SpriteSheet* m_hudGlyphSheet = nullptr;
+	HudText m_positionText;
+	HudText m_timeScaleText;
+	HudText m_renderStatsText;
+	HudText m_visibilityStatsText;
+	HudText m_frameArenaText;
+	HudText m_profileOverlayTexts[PROFILE_OVERLAY_MAX_LINES];
+	int m_numProfileOverlayLines = 0;
+	std::vector<unsigned char> m_entityVisibility;
+	int m_numVisibleEntities = 0;
+
+	// Drawn into on the render-list job only; frustum-visible props behind the occluders are dropped before submission
+	OcclusionBuffer m_occlusionBuffer;
+	bool m_isOcclusionCullingEnabled = true;
+	int m_numOccludedEntities = 0;
+
+	// Level of detail each prop was last drawn at, kept by the render-list job so the hysteresis has a previous level to hold
+	std::vector<unsigned char> m_entityLods;
+	std::vector<int> m_lodMeshIDs;
+	bool m_isMeshLodEnabled = true;
+	int m_numEntitiesAtLod[MESH_NUM_LODS] = {};
+
+	// Props simulate in fixed steps; the snapshot blends the last two steps by how far into the next one the frame is
+	float m_simulationStepSeconds = 1.f / DEFAULT_SIMULATION_HZ;
+	double m_simulationAccumulatorSeconds = 0.0;
+	float m_simulationBlend = 1.f;
+	int m_numSimulationStepsThisFrame = 0;
+
+	// Scratch for rebuilding the blended transforms of props that moved in the last step, kept to reuse capacity
+	std::vector<int> m_blendIndexes;
+	std::vector<Vec3> m_blendPositions;
+	std::vector<EulerAngles> m_blendOrientations;
+	std::vector<Mat44> m_blendTransforms;
+
+	// The render list for the previous frame's snapshot is built on a worker while the current frame simulates
+	FrameSnapshot m_frameSnapshots[2];
+	int m_pendingSnapshotIndex = 0;
+	int m_renderedSnapshotIndex = 0;
+	double m_lastBuildRenderCommandsSeconds = 0.0;	// Written by the build job, read once the frame has waited for it
+
+	// Entities each snapshot buffer holds an out-of-date copy of, so a capture only copies what changed since that buffer was last written
+	std::vector<int> m_staleSnapshotEntities[2];
+	std::vector<unsigned char> m_isSnapshotEntityStale[2];
+
+	// What the player and game react to this frame, captured live or taken from the recording being replayed
+	PlayerInputFrame m_playerInput;
+	PlayerInputRecording m_inputRecording;
+	bool m_isRecordingInput = false;
+	bool m_isReplayingInput = false;
+	int m_replayFrameIndex = 0;
 };
\ No newline at end of file
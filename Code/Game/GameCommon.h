@@ -6,6 +6,10 @@ class Renderer;
 class InputSystem;
 class AudioSystem;
 class Window;
+class JobSystem;
+class Profiler;
+class TextureStreamer;
+class FrameArena;
 struct Vec2;
 struct Rgba8;
 
@@ -22,6 +26,10 @@ extern RandomNumberGenerator* g_rng;
 extern InputSystem* g_theInput;
 extern AudioSystem* g_theAudio;
 extern Window* g_theWindow;
+extern JobSystem* g_theJobSystem;
+extern Profiler* g_theProfiler;
+extern TextureStreamer* g_theTextureStreamer;
+extern FrameArena* g_theFrameArena;
 
 
 void DebugDrawRing(Vec2 const& center, float radius, float thickness, Rgba8 const& color);
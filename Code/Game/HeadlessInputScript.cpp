@@ -0,0 +1,66 @@
+#include "Game/HeadlessInputScript.hpp"
+#include "Engine/Input/InputSystem.h"
+#include <algorithm>
+
+void HeadlessInputScript::AddKeyEvent(int frameIndex, unsigned char keyCode, bool isPressed)
+{
+	ScriptedKeyEvent keyEvent;
+	keyEvent.m_frameIndex = frameIndex;
+	keyEvent.m_keyCode = keyCode;
+	keyEvent.m_isPressed = isPressed;
+	m_events.push_back(keyEvent);
+	m_isSorted = false;
+}
+
+void HeadlessInputScript::AddKeyTap(int frameIndex, unsigned char keyCode)
+{
+	AddKeyEvent(frameIndex, keyCode, true);
+	AddKeyEvent(frameIndex + 1, keyCode, false);
+}
+
+void HeadlessInputScript::AddKeyHold(int firstFrameIndex, int numFrames, unsigned char keyCode)
+{
+	AddKeyEvent(firstFrameIndex, keyCode, true);
+	AddKeyEvent(firstFrameIndex + numFrames, keyCode, false);
+}
+
+void HeadlessInputScript::ApplyFrame(int frameIndex, InputSystem& input)
+{
+	if (!m_isSorted)
+	{
+		// Stable so a press and release added for the same frame keep their order
+		std::stable_sort(m_events.begin(), m_events.end(), [](ScriptedKeyEvent const& a, ScriptedKeyEvent const& b) { return a.m_frameIndex < b.m_frameIndex; });
+		m_isSorted = true;
+		m_nextEventIndex = 0;
+	}
+
+	int numEvents = static_cast<int>(m_events.size());
+	while (m_nextEventIndex < numEvents && m_events[m_nextEventIndex].m_frameIndex <= frameIndex)
+	{
+		ScriptedKeyEvent const& keyEvent = m_events[m_nextEventIndex];
+		if (keyEvent.m_isPressed)
+		{
+			input.HandleKeyPressed(keyEvent.m_keyCode);
+		}
+		else
+		{
+			input.HandleKeyReleased(keyEvent.m_keyCode);
+		}
+		++m_nextEventIndex;
+	}
+}
+
+HeadlessInputScript HeadlessInputScript::MakeDefaultFlythrough()
+{
+	// Leave attract mode, then fly forward past the props with some strafing, boosting and climbing
+	HeadlessInputScript script;
+	script.AddKeyTap(0, ' ');
+	script.AddKeyHold(30, 300, 'W');
+	script.AddKeyHold(120, 60, 'A');
+	script.AddKeyHold(200, 60, KEYCODE_SHIFT);
+	script.AddKeyHold(280, 40, 'C');
+	script.AddKeyHold(340, 60, 'D');
+	script.AddKeyTap(420, 'H');
+	script.AddKeyHold(440, 120, 'S');
+	return script;
+}
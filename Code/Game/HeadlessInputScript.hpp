@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+// -----------------------------------------------------------------------------
+class InputSystem;
+// -----------------------------------------------------------------------------
+struct ScriptedKeyEvent
+{
+	int m_frameIndex = 0;
+	unsigned char m_keyCode = 0;
+	bool m_isPressed = true;
+};
+// -----------------------------------------------------------------------------
+// A fixed list of key presses and releases keyed by frame number, fed straight
+// into the InputSystem so headless runs are repeatable without a window.
+// -----------------------------------------------------------------------------
+class HeadlessInputScript
+{
+public:
+	void AddKeyEvent(int frameIndex, unsigned char keyCode, bool isPressed);
+	void AddKeyTap(int frameIndex, unsigned char keyCode);
+	void AddKeyHold(int firstFrameIndex, int numFrames, unsigned char keyCode);
+	void ApplyFrame(int frameIndex, InputSystem& input);
+
+	static HeadlessInputScript MakeDefaultFlythrough();
+
+private:
+	std::vector<ScriptedKeyEvent> m_events;
+	bool m_isSorted = true;
+	int m_nextEventIndex = 0;
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "Game/HeapAllocationCounter.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+// Zero-initialized before any constructor runs, so allocations made during static initialization are counted too
+static std::atomic<uint64_t> s_numHeapAllocations{ 0 };
+static std::atomic<uint64_t> s_numHeapAllocatedBytes{ 0 };
+
+static void* CountedAllocate(size_t numBytes)
+{
+	s_numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	s_numHeapAllocatedBytes.fetch_add(numBytes, std::memory_order_relaxed);
+	void* memory = malloc(numBytes != 0 ? numBytes : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+uint64_t GetNumHeapAllocations()
+{
+	return s_numHeapAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t GetNumHeapAllocatedBytes()
+{
+	return s_numHeapAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+// Replacements for the global allocation functions; the nothrow forms forward to these by default
+void* operator new(size_t numBytes)
+{
+	return CountedAllocate(numBytes);
+}
+
+void* operator new[](size_t numBytes)
+{
+	return CountedAllocate(numBytes);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t numBytes) noexcept
+{
+	UNUSED(numBytes);
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t numBytes) noexcept
+{
+	UNUSED(numBytes);
+	free(memory);
+}
\ No newline at end of file
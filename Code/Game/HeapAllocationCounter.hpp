@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+// -----------------------------------------------------------------------------
+// Totals for every allocation made through the global operator new on any
+// thread, engine code included. The counters only ever go up, so callers take
+// the difference across the span they are measuring. Memory from the frame
+// arena and other direct malloc calls is not counted.
+// -----------------------------------------------------------------------------
+uint64_t GetNumHeapAllocations();
+uint64_t GetNumHeapAllocatedBytes();
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "Game/HudText.hpp"
+#include "Game/RenderStateTracker.hpp"
+#include "Engine/Renderer/SpriteSheet.hpp"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+HudText::HudText()
+{
+}
+
+HudText::~HudText()
+{
+}
+
+void HudText::Initialize(SpriteSheet const* glyphSheet, AABB2 const& box, float cellHeight, Vec2 const& alignment, Rgba8 const& color)
+{
+	m_glyphSheet = glyphSheet;
+	m_box = box;
+	m_cellHeight = cellHeight;
+	m_alignment = alignment;
+	m_color = color;
+	m_numChars = 0;
+	m_text[0] = '\0';
+}
+
+void HudText::SetText(char const* text)
+{
+	int numChars = static_cast<int>(strnlen(text, HUD_TEXT_MAX_CHARS));
+
+	// A line too long for the widget ends in "..." so the cut is visible on screen
+	bool isTruncated = numChars == HUD_TEXT_MAX_CHARS && text[HUD_TEXT_MAX_CHARS] != '\0';
+
+	// The font is fixed width, so the line only moves when its length changes and it is not left aligned
+	Vec2 boxDimensions = m_box.m_maxs - m_box.m_mins;
+	Vec2 textDimensions(m_cellHeight * static_cast<float>(numChars), m_cellHeight);
+	Vec2 textMins = m_box.m_mins + Vec2((boxDimensions.x - textDimensions.x) * m_alignment.x, (boxDimensions.y - textDimensions.y) * m_alignment.y);
+	bool didMove = textMins != m_textMins;
+	m_textMins = textMins;
+
+	for (int charIndex = 0; charIndex < numChars; ++charIndex)
+	{
+		char glyph = isTruncated && charIndex >= numChars - 3 ? '.' : text[charIndex];
+		if (didMove || charIndex >= m_numChars || m_text[charIndex] != glyph)
+		{
+			m_text[charIndex] = glyph;
+			TessellateChar(charIndex);
+		}
+	}
+	m_text[numChars] = '\0';
+	m_numChars = numChars;
+}
+
+void HudText::Printf(char const* format, ...)
+{
+	// One spare character, so SetText can tell a line that fits from one that was cut off
+	char text[HUD_TEXT_MAX_CHARS + 2];
+	va_list variableArgumentList;
+	va_start(variableArgumentList, format);
+	int numChars = vsnprintf(text, sizeof(text), format, variableArgumentList);
+	va_end(variableArgumentList);
+	if (numChars < 0)
+	{
+		text[0] = '\0';
+	}
+	SetText(text);
+}
+
+void HudText::Render(RenderStateTracker& renderStateTracker) const
+{
+	if (m_numChars == 0)
+	{
+		return;
+	}
+	renderStateTracker.DrawVertexArray(m_numChars * HUD_TEXT_VERTS_PER_CHAR, m_vertexes);
+}
+
+void HudText::TessellateChar(int charIndex)
+{
+	AABB2 uvs = m_glyphSheet->GetSpriteUVs(static_cast<unsigned char>(m_text[charIndex]));
+	Vec2 mins(m_textMins.x + m_cellHeight * static_cast<float>(charIndex), m_textMins.y);
+	Vec2 maxs(mins.x + m_cellHeight, mins.y + m_cellHeight);
+
+	Vertex_PCU* vertexes = &m_vertexes[charIndex * HUD_TEXT_VERTS_PER_CHAR];
+	vertexes[0] = Vertex_PCU(Vec3(mins.x, mins.y, 0.f), m_color, Vec2(uvs.m_mins.x, uvs.m_mins.y));
+	vertexes[1] = Vertex_PCU(Vec3(maxs.x, mins.y, 0.f), m_color, Vec2(uvs.m_maxs.x, uvs.m_mins.y));
+	vertexes[2] = Vertex_PCU(Vec3(maxs.x, maxs.y, 0.f), m_color, Vec2(uvs.m_maxs.x, uvs.m_maxs.y));
+	vertexes[3] = Vertex_PCU(Vec3(mins.x, mins.y, 0.f), m_color, Vec2(uvs.m_mins.x, uvs.m_mins.y));
+	vertexes[4] = Vertex_PCU(Vec3(maxs.x, maxs.y, 0.f), m_color, Vec2(uvs.m_maxs.x, uvs.m_maxs.y));
+	vertexes[5] = Vertex_PCU(Vec3(mins.x, maxs.y, 0.f), m_color, Vec2(uvs.m_mins.x, uvs.m_maxs.y));
+}
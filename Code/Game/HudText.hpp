@@ -0,0 +1,47 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/Vec2.hpp"
+// -----------------------------------------------------------------------------
+class RenderStateTracker;
+class SpriteSheet;
+// -----------------------------------------------------------------------------
+constexpr int HUD_TEXT_MAX_CHARS = 127;
+constexpr int HUD_TEXT_VERTS_PER_CHAR = 6;
+// -----------------------------------------------------------------------------
+// One line of screen text that persists across frames. The text and its glyph
+// quads live in fixed-size arrays, so updating it never touches the heap, and
+// only characters that differ from the last frame are re-tessellated. Placement
+// matches DebugAddScreenText: the line is aligned inside a box by a 0-1 factor.
+// Text longer than HUD_TEXT_MAX_CHARS is cut and ends in "...".
+// -----------------------------------------------------------------------------
+class HudText
+{
+public:
+	HudText();
+	~HudText();
+
+	void Initialize(SpriteSheet const* glyphSheet, AABB2 const& box, float cellHeight, Vec2 const& alignment, Rgba8 const& color = Rgba8::WHITE);
+	void SetText(char const* text);
+	void Printf(char const* format, ...);
+	void Render(RenderStateTracker& renderStateTracker) const;
+
+	int GetNumChars() const { return m_numChars; }
+	char const* GetText() const { return m_text; }
+
+private:
+	void TessellateChar(int charIndex);
+
+private:
+	SpriteSheet const* m_glyphSheet = nullptr;
+	AABB2 m_box;
+	float m_cellHeight = 10.f;
+	Vec2 m_alignment;
+	Rgba8 m_color = Rgba8::WHITE;
+	Vec2 m_textMins;
+
+	int m_numChars = 0;
+	char m_text[HUD_TEXT_MAX_CHARS + 1] = {};
+	Vertex_PCU m_vertexes[HUD_TEXT_MAX_CHARS * HUD_TEXT_VERTS_PER_CHAR];
+};
\ No newline at end of file
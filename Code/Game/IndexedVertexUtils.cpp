@@ -0,0 +1,472 @@
+#include "Game/IndexedVertexUtils.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <math.h>
+#include <string.h>
+#include <unordered_map>
+
+void AddVertsForIndexedQuad3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& bottomLeft, Vec3 const& bottomRight,
+	Vec3 const& topRight, Vec3 const& topLeft, Rgba8 const& color, AABB2 const& UVs)
+{
+	unsigned int firstVertexIndex = static_cast<unsigned int>(verts.size());
+	verts.push_back(Vertex_PCU(bottomLeft, color, Vec2(UVs.m_mins.x, UVs.m_mins.y)));
+	verts.push_back(Vertex_PCU(bottomRight, color, Vec2(UVs.m_maxs.x, UVs.m_mins.y)));
+	verts.push_back(Vertex_PCU(topRight, color, Vec2(UVs.m_maxs.x, UVs.m_maxs.y)));
+	verts.push_back(Vertex_PCU(topLeft, color, Vec2(UVs.m_mins.x, UVs.m_maxs.y)));
+
+	indexes.push_back(firstVertexIndex + 0);
+	indexes.push_back(firstVertexIndex + 1);
+	indexes.push_back(firstVertexIndex + 2);
+	indexes.push_back(firstVertexIndex + 0);
+	indexes.push_back(firstVertexIndex + 2);
+	indexes.push_back(firstVertexIndex + 3);
+}
+
+void AddVertsForIndexedAABB3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, AABB3 const& bounds, Rgba8 const& color, AABB2 const& UVs)
+{
+	// Four corners per face so every face keeps its own UVs
+	Vec3 const& mins = bounds.m_mins;
+	Vec3 const& maxs = bounds.m_maxs;
+	AddVertsForIndexedQuad3D(verts, indexes, Vec3(maxs.x, mins.y, mins.z), Vec3(maxs.x, maxs.y, mins.z), Vec3(maxs.x, maxs.y, maxs.z), Vec3(maxs.x, mins.y, maxs.z), color, UVs);
+	AddVertsForIndexedQuad3D(verts, indexes, Vec3(mins.x, maxs.y, mins.z), Vec3(mins.x, mins.y, mins.z), Vec3(mins.x, mins.y, maxs.z), Vec3(mins.x, maxs.y, maxs.z), color, UVs);
+	AddVertsForIndexedQuad3D(verts, indexes, Vec3(maxs.x, maxs.y, mins.z), Vec3(mins.x, maxs.y, mins.z), Vec3(mins.x, maxs.y, maxs.z), Vec3(maxs.x, maxs.y, maxs.z), color, UVs);
+	AddVertsForIndexedQuad3D(verts, indexes, Vec3(mins.x, mins.y, mins.z), Vec3(maxs.x, mins.y, mins.z), Vec3(maxs.x, mins.y, maxs.z), Vec3(mins.x, mins.y, maxs.z), color, UVs);
+	AddVertsForIndexedQuad3D(verts, indexes, Vec3(maxs.x, maxs.y, maxs.z), Vec3(mins.x, maxs.y, maxs.z), Vec3(mins.x, mins.y, maxs.z), Vec3(maxs.x, mins.y, maxs.z), color, UVs);
+	AddVertsForIndexedQuad3D(verts, indexes, Vec3(mins.x, maxs.y, mins.z), Vec3(maxs.x, maxs.y, mins.z), Vec3(maxs.x, mins.y, mins.z), Vec3(mins.x, mins.y, mins.z), color, UVs);
+}
+
+void AddVertsForIndexedSphere3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& center, float radius, Rgba8 const& color,
+	AABB2 const& UVs, int numSlices, int numStacks)
+{
+	// A (numSlices + 1) x (numStacks + 1) lattice; the seam column is repeated so U can wrap from 1 back to 0
+	unsigned int firstVertexIndex = static_cast<unsigned int>(verts.size());
+	for (int stackIndex = 0; stackIndex <= numStacks; ++stackIndex)
+	{
+		float stackFraction = static_cast<float>(stackIndex) / static_cast<float>(numStacks);
+		float latitudeDegrees = -90.f + 180.f * stackFraction;
+		for (int sliceIndex = 0; sliceIndex <= numSlices; ++sliceIndex)
+		{
+			float sliceFraction = static_cast<float>(sliceIndex) / static_cast<float>(numSlices);
+			float longitudeDegrees = 360.f * sliceFraction;
+			Vec3 direction(CosDegrees(latitudeDegrees) * CosDegrees(longitudeDegrees), CosDegrees(latitudeDegrees) * SinDegrees(longitudeDegrees), SinDegrees(latitudeDegrees));
+			Vec2 uv(Interpolate(UVs.m_mins.x, UVs.m_maxs.x, sliceFraction), Interpolate(UVs.m_mins.y, UVs.m_maxs.y, stackFraction));
+			verts.push_back(Vertex_PCU(center + direction * radius, color, uv));
+		}
+	}
+
+	// The pole rows collapse to a point, so each of their quads only needs the one triangle that has area
+	unsigned int numVertexesPerStack = static_cast<unsigned int>(numSlices + 1);
+	for (int stackIndex = 0; stackIndex < numStacks; ++stackIndex)
+	{
+		for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+		{
+			unsigned int bottomLeft = firstVertexIndex + static_cast<unsigned int>(stackIndex) * numVertexesPerStack + static_cast<unsigned int>(sliceIndex);
+			unsigned int bottomRight = bottomLeft + 1;
+			unsigned int topLeft = bottomLeft + numVertexesPerStack;
+			unsigned int topRight = topLeft + 1;
+			if (stackIndex != 0)
+			{
+				indexes.push_back(bottomLeft);
+				indexes.push_back(bottomRight);
+				indexes.push_back(topRight);
+			}
+			if (stackIndex != numStacks - 1)
+			{
+				indexes.push_back(bottomLeft);
+				indexes.push_back(topRight);
+				indexes.push_back(topLeft);
+			}
+		}
+	}
+}
+
+struct VertexBytesHash
+{
+	size_t operator()(Vertex_PCU const& vertex) const
+	{
+		// FNV-1a over the raw bytes, matching the byte compare in VertexBytesEqual
+		unsigned char const* bytes = reinterpret_cast<unsigned char const*>(&vertex);
+		size_t hash = 2166136261u;
+		for (size_t byteIndex = 0; byteIndex < sizeof(Vertex_PCU); ++byteIndex)
+		{
+			hash = (hash ^ bytes[byteIndex]) * 16777619u;
+		}
+		return hash;
+	}
+};
+
+struct VertexBytesEqual
+{
+	bool operator()(Vertex_PCU const& vertexA, Vertex_PCU const& vertexB) const
+	{
+		return memcmp(&vertexA, &vertexB, sizeof(Vertex_PCU)) == 0;
+	}
+};
+
+static void GetPerpendicularBasis(Vec3 const& axis, Vec3& out_iBasis, Vec3& out_jBasis)
+{
+	// Any unit i perpendicular to the axis, with j chosen so that i x j points along the axis
+	Vec3 reference = fabsf(axis.z) < 0.99f ? Vec3::ZAXE : Vec3::XAXE;
+	out_iBasis = CrossProduct3D(axis, reference).GetNormalized();
+	out_jBasis = CrossProduct3D(axis, out_iBasis);
+}
+
+static void AddVertsForIndexedDisc3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& center, Vec3 const& iBasis, Vec3 const& jBasis,
+	float radius, Rgba8 const& color, AABB2 const& UVs, int numSlices, bool isFacingAlongAxis)
+{
+	// A fan around its own center vertex, with UVs laid out as a circle inscribed in the UV box
+	unsigned int centerVertexIndex = static_cast<unsigned int>(verts.size());
+	verts.push_back(Vertex_PCU(center, color, Vec2(Interpolate(UVs.m_mins.x, UVs.m_maxs.x, 0.5f), Interpolate(UVs.m_mins.y, UVs.m_maxs.y, 0.5f))));
+	for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+	{
+		float degrees = 360.f * static_cast<float>(sliceIndex) / static_cast<float>(numSlices);
+		float cosine = CosDegrees(degrees);
+		float sine = SinDegrees(degrees);
+		Vec2 uv(Interpolate(UVs.m_mins.x, UVs.m_maxs.x, 0.5f + 0.5f * cosine), Interpolate(UVs.m_mins.y, UVs.m_maxs.y, 0.5f + 0.5f * sine));
+		verts.push_back(Vertex_PCU(center + (iBasis * cosine + jBasis * sine) * radius, color, uv));
+	}
+
+	for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+	{
+		unsigned int current = centerVertexIndex + 1 + static_cast<unsigned int>(sliceIndex);
+		unsigned int next = centerVertexIndex + 1 + static_cast<unsigned int>((sliceIndex + 1) % numSlices);
+		indexes.push_back(centerVertexIndex);
+		indexes.push_back(isFacingAlongAxis ? current : next);
+		indexes.push_back(isFacingAlongAxis ? next : current);
+	}
+}
+
+void AddVertsForIndexedCylinder3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius,
+	Rgba8 const& color, AABB2 const& UVs, int numSlices)
+{
+	Vec3 axis = (end - start).GetNormalized();
+	Vec3 iBasis;
+	Vec3 jBasis;
+	GetPerpendicularBasis(axis, iBasis, jBasis);
+
+	// Two rings of numSlices + 1 vertexes for the side, repeating the seam like the sphere does, then a flat cap at each end
+	unsigned int firstVertexIndex = static_cast<unsigned int>(verts.size());
+	for (int ringIndex = 0; ringIndex < 2; ++ringIndex)
+	{
+		Vec3 const& ringCenter = ringIndex == 0 ? start : end;
+		float v = ringIndex == 0 ? UVs.m_mins.y : UVs.m_maxs.y;
+		for (int sliceIndex = 0; sliceIndex <= numSlices; ++sliceIndex)
+		{
+			float sliceFraction = static_cast<float>(sliceIndex) / static_cast<float>(numSlices);
+			float degrees = 360.f * sliceFraction;
+			Vec3 direction = iBasis * CosDegrees(degrees) + jBasis * SinDegrees(degrees);
+			verts.push_back(Vertex_PCU(ringCenter + direction * radius, color, Vec2(Interpolate(UVs.m_mins.x, UVs.m_maxs.x, sliceFraction), v)));
+		}
+	}
+
+	unsigned int numVertexesPerRing = static_cast<unsigned int>(numSlices + 1);
+	for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+	{
+		unsigned int bottomLeft = firstVertexIndex + static_cast<unsigned int>(sliceIndex);
+		unsigned int bottomRight = bottomLeft + 1;
+		unsigned int topLeft = bottomLeft + numVertexesPerRing;
+		unsigned int topRight = topLeft + 1;
+		indexes.push_back(bottomLeft);
+		indexes.push_back(bottomRight);
+		indexes.push_back(topRight);
+		indexes.push_back(bottomLeft);
+		indexes.push_back(topRight);
+		indexes.push_back(topLeft);
+	}
+
+	AddVertsForIndexedDisc3D(verts, indexes, start, iBasis, jBasis, radius, color, UVs, numSlices, false);
+	AddVertsForIndexedDisc3D(verts, indexes, end, iBasis, jBasis, radius, color, UVs, numSlices, true);
+}
+
+void AddVertsForIndexedCone3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius,
+	Rgba8 const& color, AABB2 const& UVs, int numSlices)
+{
+	// The base ring sits at start and the tip at end; each slice gets its own tip vertex so U stays continuous up the side
+	Vec3 axis = (end - start).GetNormalized();
+	Vec3 iBasis;
+	Vec3 jBasis;
+	GetPerpendicularBasis(axis, iBasis, jBasis);
+
+	unsigned int firstVertexIndex = static_cast<unsigned int>(verts.size());
+	for (int sliceIndex = 0; sliceIndex <= numSlices; ++sliceIndex)
+	{
+		float sliceFraction = static_cast<float>(sliceIndex) / static_cast<float>(numSlices);
+		float degrees = 360.f * sliceFraction;
+		Vec3 direction = iBasis * CosDegrees(degrees) + jBasis * SinDegrees(degrees);
+		verts.push_back(Vertex_PCU(start + direction * radius, color, Vec2(Interpolate(UVs.m_mins.x, UVs.m_maxs.x, sliceFraction), UVs.m_mins.y)));
+	}
+	for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+	{
+		float tipFraction = (static_cast<float>(sliceIndex) + 0.5f) / static_cast<float>(numSlices);
+		verts.push_back(Vertex_PCU(end, color, Vec2(Interpolate(UVs.m_mins.x, UVs.m_maxs.x, tipFraction), UVs.m_maxs.y)));
+	}
+
+	unsigned int firstTipIndex = firstVertexIndex + static_cast<unsigned int>(numSlices + 1);
+	for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+	{
+		indexes.push_back(firstVertexIndex + static_cast<unsigned int>(sliceIndex));
+		indexes.push_back(firstVertexIndex + static_cast<unsigned int>(sliceIndex) + 1);
+		indexes.push_back(firstTipIndex + static_cast<unsigned int>(sliceIndex));
+	}
+
+	AddVertsForIndexedDisc3D(verts, indexes, start, iBasis, jBasis, radius, color, UVs, numSlices, false);
+}
+
+void AddVertsForIndexedArrow3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius,
+	Rgba8 const& color, int numSlices)
+{
+	// The head takes the last 30% of the length and is twice as wide as the shaft
+	Vec3 headStart = start + (end - start) * 0.7f;
+	AddVertsForIndexedCylinder3D(verts, indexes, start, headStart, radius, color, AABB2(Vec2::ZERO, Vec2::ONE), numSlices);
+	AddVertsForIndexedCone3D(verts, indexes, headStart, end, radius * 2.f, color, AABB2(Vec2::ZERO, Vec2::ONE), numSlices);
+}
+
+void DeduplicateVertexes(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes)
+{
+	// Only bit-identical vertexes merge, so seams with different UVs or colors stay split
+	std::unordered_map<Vertex_PCU, unsigned int, VertexBytesHash, VertexBytesEqual> uniqueIndexes;
+	uniqueIndexes.reserve(verts.size());
+	std::vector<unsigned int> remap(verts.size());
+	std::vector<Vertex_PCU> uniqueVerts;
+	uniqueVerts.reserve(verts.size());
+	for (size_t vertIndex = 0; vertIndex < verts.size(); ++vertIndex)
+	{
+		auto found = uniqueIndexes.find(verts[vertIndex]);
+		if (found != uniqueIndexes.end())
+		{
+			remap[vertIndex] = found->second;
+			continue;
+		}
+		unsigned int uniqueIndex = static_cast<unsigned int>(uniqueVerts.size());
+		uniqueIndexes[verts[vertIndex]] = uniqueIndex;
+		uniqueVerts.push_back(verts[vertIndex]);
+		remap[vertIndex] = uniqueIndex;
+	}
+
+	for (size_t indexIndex = 0; indexIndex < indexes.size(); ++indexIndex)
+	{
+		indexes[indexIndex] = remap[indexes[indexIndex]];
+	}
+	verts.swap(uniqueVerts);
+}
+
+static float GetVertexCacheScore(int cachePosition, int numRemainingTriangles)
+{
+	// Forsyth's linear-speed vertex cache optimization scoring
+	if (numRemainingTriangles == 0)
+	{
+		return -1.f;
+	}
+
+	float score = 0.f;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			// Vertexes of the triangle just emitted are penalized a little so strips do not turn back on themselves
+			score = 0.75f;
+		}
+		else
+		{
+			float scaler = 1.f / static_cast<float>(VERTEX_CACHE_SIZE - 3);
+			score = powf(1.f - static_cast<float>(cachePosition - 3) * scaler, 1.5f);
+		}
+	}
+
+	// Finish off vertexes with few triangles left so they can leave the cache for good
+	score += 2.f / sqrtf(static_cast<float>(numRemainingTriangles));
+	return score;
+}
+
+void OptimizeVertexCacheOrder(std::vector<unsigned int>& indexes, int numVertexes)
+{
+	int numTriangles = static_cast<int>(indexes.size()) / 3;
+	if (numTriangles == 0)
+	{
+		return;
+	}
+
+	// Which triangles use each vertex, as offsets into one shared array
+	std::vector<int> vertexTriangleCounts(static_cast<size_t>(numVertexes), 0);
+	for (size_t indexIndex = 0; indexIndex < indexes.size(); ++indexIndex)
+	{
+		++vertexTriangleCounts[indexes[indexIndex]];
+	}
+	std::vector<int> vertexTriangleOffsets(static_cast<size_t>(numVertexes) + 1, 0);
+	for (int vertIndex = 0; vertIndex < numVertexes; ++vertIndex)
+	{
+		vertexTriangleOffsets[vertIndex + 1] = vertexTriangleOffsets[vertIndex] + vertexTriangleCounts[vertIndex];
+	}
+	std::vector<int> vertexTriangles(indexes.size());
+	std::vector<int> vertexRemainingTriangles(static_cast<size_t>(numVertexes), 0);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			unsigned int vertIndex = indexes[triangleIndex * 3 + cornerIndex];
+			vertexTriangles[vertexTriangleOffsets[vertIndex] + vertexRemainingTriangles[vertIndex]] = triangleIndex;
+			++vertexRemainingTriangles[vertIndex];
+		}
+	}
+
+	std::vector<int> vertexCachePositions(static_cast<size_t>(numVertexes), -1);
+	std::vector<float> vertexScores(static_cast<size_t>(numVertexes));
+	for (int vertIndex = 0; vertIndex < numVertexes; ++vertIndex)
+	{
+		vertexScores[vertIndex] = GetVertexCacheScore(-1, vertexRemainingTriangles[vertIndex]);
+	}
+	std::vector<float> triangleScores(static_cast<size_t>(numTriangles));
+	std::vector<bool> isTriangleEmitted(static_cast<size_t>(numTriangles), false);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		triangleScores[triangleIndex] = vertexScores[indexes[triangleIndex * 3]] + vertexScores[indexes[triangleIndex * 3 + 1]] + vertexScores[indexes[triangleIndex * 3 + 2]];
+	}
+
+	std::vector<unsigned int> optimizedIndexes;
+	optimizedIndexes.reserve(indexes.size());
+	std::vector<int> cache;
+	std::vector<int> nextCache;
+	cache.reserve(VERTEX_CACHE_SIZE + 3);
+	nextCache.reserve(VERTEX_CACHE_SIZE + 3);
+	int bestTriangle = -1;
+	int nextUnemittedTriangle = 0;
+	for (int emittedCount = 0; emittedCount < numTriangles; ++emittedCount)
+	{
+		// Nothing useful in the cache, start again from the best-scoring remaining triangle
+		if (bestTriangle == -1)
+		{
+			float bestScore = -1.f;
+			for (int triangleIndex = nextUnemittedTriangle; triangleIndex < numTriangles; ++triangleIndex)
+			{
+				if (!isTriangleEmitted[triangleIndex] && triangleScores[triangleIndex] > bestScore)
+				{
+					bestScore = triangleScores[triangleIndex];
+					bestTriangle = triangleIndex;
+				}
+			}
+		}
+
+		isTriangleEmitted[bestTriangle] = true;
+		while (nextUnemittedTriangle < numTriangles && isTriangleEmitted[nextUnemittedTriangle])
+		{
+			++nextUnemittedTriangle;
+		}
+
+		// Emit the triangle, move its vertexes to the front of the cache and drop it from their lists
+		nextCache.clear();
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			int vertIndex = static_cast<int>(indexes[bestTriangle * 3 + cornerIndex]);
+			optimizedIndexes.push_back(static_cast<unsigned int>(vertIndex));
+			nextCache.push_back(vertIndex);
+
+			int* triangles = &vertexTriangles[vertexTriangleOffsets[vertIndex]];
+			int& numRemaining = vertexRemainingTriangles[vertIndex];
+			for (int listIndex = 0; listIndex < numRemaining; ++listIndex)
+			{
+				if (triangles[listIndex] == bestTriangle)
+				{
+					triangles[listIndex] = triangles[numRemaining - 1];
+					--numRemaining;
+					break;
+				}
+			}
+		}
+		for (size_t cacheIndex = 0; cacheIndex < cache.size(); ++cacheIndex)
+		{
+			int vertIndex = cache[cacheIndex];
+			if (vertIndex != nextCache[0] && vertIndex != nextCache[1] && vertIndex != nextCache[2])
+			{
+				nextCache.push_back(vertIndex);
+			}
+		}
+		cache.swap(nextCache);
+
+		// Rescore everything that was in the cache, including what just fell out of it
+		for (size_t cacheIndex = 0; cacheIndex < cache.size(); ++cacheIndex)
+		{
+			int vertIndex = cache[cacheIndex];
+			int cachePosition = cacheIndex < VERTEX_CACHE_SIZE ? static_cast<int>(cacheIndex) : -1;
+			vertexCachePositions[vertIndex] = cachePosition;
+			vertexScores[vertIndex] = GetVertexCacheScore(cachePosition, vertexRemainingTriangles[vertIndex]);
+		}
+		bestTriangle = -1;
+		float bestScore = -1.f;
+		for (size_t cacheIndex = 0; cacheIndex < cache.size(); ++cacheIndex)
+		{
+			int vertIndex = cache[cacheIndex];
+			int const* triangles = &vertexTriangles[vertexTriangleOffsets[vertIndex]];
+			for (int listIndex = 0; listIndex < vertexRemainingTriangles[vertIndex]; ++listIndex)
+			{
+				int triangleIndex = triangles[listIndex];
+				float score = vertexScores[indexes[triangleIndex * 3]] + vertexScores[indexes[triangleIndex * 3 + 1]] + vertexScores[indexes[triangleIndex * 3 + 2]];
+				triangleScores[triangleIndex] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = triangleIndex;
+				}
+			}
+		}
+		if (cache.size() > VERTEX_CACHE_SIZE)
+		{
+			cache.resize(VERTEX_CACHE_SIZE);
+		}
+	}
+
+	indexes.swap(optimizedIndexes);
+}
+
+void OptimizeVertexFetchOrder(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes)
+{
+	// Vertexes are stored in the order the index buffer first touches them; unreferenced ones are dropped
+	unsigned int const UNASSIGNED = 0xFFFFFFFF;
+	std::vector<unsigned int> remap(verts.size(), UNASSIGNED);
+	std::vector<Vertex_PCU> orderedVerts;
+	orderedVerts.reserve(verts.size());
+	for (size_t indexIndex = 0; indexIndex < indexes.size(); ++indexIndex)
+	{
+		unsigned int& newIndex = remap[indexes[indexIndex]];
+		if (newIndex == UNASSIGNED)
+		{
+			newIndex = static_cast<unsigned int>(orderedVerts.size());
+			orderedVerts.push_back(verts[indexes[indexIndex]]);
+		}
+		indexes[indexIndex] = newIndex;
+	}
+	verts.swap(orderedVerts);
+}
+
+float GetAverageCacheMissRatio(std::vector<unsigned int> const& indexes, int cacheSize)
+{
+	// Misses per triangle through a FIFO cache, 3.0 is the worst case and about 0.5-0.7 is good
+	int numTriangles = static_cast<int>(indexes.size()) / 3;
+	if (numTriangles == 0)
+	{
+		return 0.f;
+	}
+
+	std::vector<unsigned int> cache;
+	int numMisses = 0;
+	for (size_t indexIndex = 0; indexIndex < indexes.size(); ++indexIndex)
+	{
+		bool isInCache = false;
+		for (size_t cacheIndex = 0; cacheIndex < cache.size(); ++cacheIndex)
+		{
+			if (cache[cacheIndex] == indexes[indexIndex])
+			{
+				isInCache = true;
+				break;
+			}
+		}
+		if (!isInCache)
+		{
+			++numMisses;
+			cache.push_back(indexes[indexIndex]);
+			if (static_cast<int>(cache.size()) > cacheSize)
+			{
+				cache.erase(cache.begin());
+			}
+		}
+	}
+	return static_cast<float>(numMisses) / static_cast<float>(numTriangles);
+}
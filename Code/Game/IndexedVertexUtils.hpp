@@ -0,0 +1,32 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Vec3.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int VERTEX_CACHE_SIZE = 32;
+// -----------------------------------------------------------------------------
+// Indexed counterparts of the VertexUtils builders. Shared corners are emitted
+// once and referenced by index instead of being repeated per triangle.
+// -----------------------------------------------------------------------------
+void AddVertsForIndexedQuad3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& bottomLeft, Vec3 const& bottomRight,
+	Vec3 const& topRight, Vec3 const& topLeft, Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2(Vec2::ZERO, Vec2::ONE));
+void AddVertsForIndexedAABB3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, AABB3 const& bounds, Rgba8 const& color = Rgba8::WHITE,
+	AABB2 const& UVs = AABB2(Vec2::ZERO, Vec2::ONE));
+void AddVertsForIndexedSphere3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& center, float radius, Rgba8 const& color = Rgba8::WHITE,
+	AABB2 const& UVs = AABB2(Vec2::ZERO, Vec2::ONE), int numSlices = 32, int numStacks = 16);
+void AddVertsForIndexedCylinder3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius,
+	Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2(Vec2::ZERO, Vec2::ONE), int numSlices = 32);
+void AddVertsForIndexedCone3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius,
+	Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2(Vec2::ZERO, Vec2::ONE), int numSlices = 32);
+void AddVertsForIndexedArrow3D(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius,
+	Rgba8 const& color = Rgba8::WHITE, int numSlices = 32);
+// -----------------------------------------------------------------------------
+// Mesh optimizer passes, meant to run once when a mesh is built
+// -----------------------------------------------------------------------------
+void DeduplicateVertexes(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes);
+void OptimizeVertexCacheOrder(std::vector<unsigned int>& indexes, int numVertexes);
+void OptimizeVertexFetchOrder(std::vector<Vertex_PCU>& verts, std::vector<unsigned int>& indexes);
+float GetAverageCacheMissRatio(std::vector<unsigned int> const& indexes, int cacheSize = VERTEX_CACHE_SIZE);
\ No newline at end of file
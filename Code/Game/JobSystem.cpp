@@ -0,0 +1,371 @@
+#include "Game/JobSystem.hpp"
+#include "Game/Profiler.hpp"
+
+// Index of the queue owned by the current thread; the main thread uses the last queue
+static thread_local int s_threadQueueIndex = -1;
+
+JobSystem::JobSystem(JobSystemConfig const& config)
+	: m_config(config)
+	, m_numQueuedJobs(0)
+	, m_numQueuedBackgroundJobs(0)
+	, m_numRunningBackgroundJobs(0)
+	, m_isQuitting(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+}
+
+void JobSystem::Startup()
+{
+	int numWorkerThreads = m_config.m_numWorkerThreads;
+	if (numWorkerThreads < 0)
+	{
+		numWorkerThreads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+		if (numWorkerThreads < 0)
+		{
+			numWorkerThreads = 0;
+		}
+	}
+
+	size_t queueCapacity = 1;
+	while (queueCapacity < static_cast<size_t>(m_config.m_jobQueueCapacity))
+	{
+		queueCapacity *= 2;
+	}
+	for (int queueIndex = 0; queueIndex < numWorkerThreads + 1; ++queueIndex)
+	{
+		m_queues.push_back(new JobQueue());
+		m_queues.back()->Allocate(queueCapacity);
+	}
+	m_submittedJobs.Allocate(queueCapacity);
+	m_backgroundJobs.Allocate(queueCapacity);
+	s_threadQueueIndex = numWorkerThreads;
+	m_maxRunningBackgroundJobs = numWorkerThreads > 1 ? numWorkerThreads - 1 : 1;
+
+	m_isQuitting = false;
+	for (int workerIndex = 0; workerIndex < numWorkerThreads; ++workerIndex)
+	{
+		m_workerThreads.emplace_back(&JobSystem::WorkerThreadMain, this, workerIndex);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t workerIndex = 0; workerIndex < m_workerThreads.size(); ++workerIndex)
+	{
+		m_workerThreads[workerIndex].join();
+	}
+	m_workerThreads.clear();
+
+	for (size_t queueIndex = 0; queueIndex < m_queues.size(); ++queueIndex)
+	{
+		delete m_queues[queueIndex];
+	}
+	m_queues.clear();
+	s_threadQueueIndex = -1;
+}
+
+void JobSystem::ParallelFor(int numIndexes, int grainSize, ParallelForFunction const& rangeFunction)
+{
+	if (numIndexes <= 0)
+	{
+		return;
+	}
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	// Not worth splitting, or called from a thread the job system does not know about
+	if (m_workerThreads.empty() || numIndexes <= grainSize || s_threadQueueIndex < 0)
+	{
+		rangeFunction(0, numIndexes);
+		return;
+	}
+
+	int numJobs = (numIndexes + grainSize - 1) / grainSize;
+	std::atomic<int> numJobsRemaining(numJobs);
+
+	// Deal ranges out round-robin, starting with the calling thread's own queue
+	int numQueues = static_cast<int>(m_queues.size());
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		Job job;
+		job.m_rangeFunction = &rangeFunction;
+		job.m_beginIndex = jobIndex * grainSize;
+		job.m_endIndex = job.m_beginIndex + grainSize < numIndexes ? job.m_beginIndex + grainSize : numIndexes;
+		job.m_numJobsRemaining = &numJobsRemaining;
+		if (!PushJob(*m_queues[(s_threadQueueIndex + jobIndex) % numQueues], job))
+		{
+			rangeFunction(job.m_beginIndex, job.m_endIndex);
+			numJobsRemaining.fetch_sub(1, std::memory_order_release);
+		}
+	}
+	m_wakeCondition.notify_all();
+
+	// Help out until every range of this call has finished
+	while (numJobsRemaining.load(std::memory_order_acquire) > 0)
+	{
+		if (!TryRunOneJob(s_threadQueueIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::SubmitJob(JobFunction const& jobFunction, JobCounter& counter, JobPriority priority)
+{
+	if (m_workerThreads.empty() || s_threadQueueIndex < 0)
+	{
+		jobFunction();
+		return;
+	}
+
+	Job job;
+	job.m_jobFunction = jobFunction;
+	job.m_numJobsRemaining = &counter.m_numJobsRemaining;
+	job.m_isBackground = priority == JobPriority::BACKGROUND;
+	counter.m_numJobsRemaining.fetch_add(1, std::memory_order_relaxed);
+
+	// Not on any thread's own queue, so TryRunOneJob never steals it; only a worker with nothing else to do picks it up
+	if (!PushJob(job.m_isBackground ? m_backgroundJobs : m_submittedJobs, job))
+	{
+		jobFunction();
+		counter.m_numJobsRemaining.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+	m_wakeCondition.notify_one();
+}
+
+void JobSystem::WaitForCounter(JobCounter const& counter)
+{
+	// Other queued work is left to the workers; a job of this counter that none has started yet is run here rather than waited on
+	while (!counter.IsDone())
+	{
+		if (!TryRunSubmittedJob(m_submittedJobs, &counter) && !TryRunSubmittedJob(m_backgroundJobs, &counter))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+int JobSystem::GetNumWorkerThreads() const
+{
+	return static_cast<int>(m_workerThreads.size());
+}
+
+void JobSystem::WorkerThreadMain(int queueIndex)
+{
+	s_threadQueueIndex = queueIndex;
+	while (!m_isQuitting)
+	{
+		// ParallelFor ranges first, since whoever queued them is blocked until they finish
+		if (TryRunOneJob(queueIndex) || TryRunSubmittedJob(m_submittedJobs, nullptr) || TryRunBackgroundJob())
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> wakeLock(m_wakeMutex);
+		m_wakeCondition.wait(wakeLock, [this]() { return m_isQuitting || HasJobsForIdleWorker(); });
+	}
+}
+
+bool JobSystem::TryRunOneJob(int queueIndex)
+{
+	Job job;
+	bool foundJob = false;
+
+	// Newest job from our own queue first, it is most likely still in cache
+	{
+		JobQueue& ownQueue = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> queueLock(ownQueue.m_mutex);
+		foundJob = ownQueue.PopBack(job);
+	}
+
+	// Otherwise steal the oldest job from someone else
+	int numQueues = static_cast<int>(m_queues.size());
+	for (int offset = 1; offset < numQueues && !foundJob; ++offset)
+	{
+		JobQueue& victimQueue = *m_queues[(queueIndex + offset) % numQueues];
+		std::lock_guard<std::mutex> queueLock(victimQueue.m_mutex);
+		foundJob = victimQueue.PopFront(job);
+	}
+
+	if (!foundJob)
+	{
+		return false;
+	}
+
+	RunJob(job);
+	return true;
+}
+
+bool JobSystem::TryRunSubmittedJob(JobQueue& queue, JobCounter const* counter)
+{
+	Job job;
+	bool foundJob = false;
+	{
+		std::lock_guard<std::mutex> queueLock(queue.m_mutex);
+		foundJob = queue.TakeJobForCounter(counter, job);
+	}
+
+	if (!foundJob)
+	{
+		return false;
+	}
+
+	RunJob(job);
+	return true;
+}
+
+bool JobSystem::TryRunBackgroundJob()
+{
+	// Claimed before looking, so two workers cannot both take the last background slot
+	if (m_numRunningBackgroundJobs.fetch_add(1) >= m_maxRunningBackgroundJobs)
+	{
+		--m_numRunningBackgroundJobs;
+		return false;
+	}
+	bool didRunJob = TryRunSubmittedJob(m_backgroundJobs, nullptr);
+
+	// A worker may be asleep on background work this one was holding the slot for
+	{
+		std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+		--m_numRunningBackgroundJobs;
+	}
+	if (didRunJob)
+	{
+		m_wakeCondition.notify_one();
+	}
+	return didRunJob;
+}
+
+bool JobSystem::HasJobsForIdleWorker() const
+{
+	// Background jobs only count while a worker is allowed to start one
+	int numBackgroundJobs = m_numQueuedBackgroundJobs.load();
+	if (m_numQueuedJobs.load() > numBackgroundJobs)
+	{
+		return true;
+	}
+	return numBackgroundJobs > 0 && m_numRunningBackgroundJobs.load() < m_maxRunningBackgroundJobs;
+}
+
+void JobSystem::RunJob(Job& job)
+{
+	if (job.m_isBackground)
+	{
+		--m_numQueuedBackgroundJobs;
+	}
+	--m_numQueuedJobs;
+	PROFILE_SCOPE("JobSystem::Job");
+	if (job.m_rangeFunction != nullptr)
+	{
+		(*job.m_rangeFunction)(job.m_beginIndex, job.m_endIndex);
+	}
+	else
+	{
+		job.m_jobFunction();
+	}
+	job.m_numJobsRemaining->fetch_sub(1, std::memory_order_release);
+}
+
+bool JobSystem::PushJob(JobQueue& queue, Job const& job)
+{
+	{
+		std::lock_guard<std::mutex> queueLock(queue.m_mutex);
+		if (!queue.PushBack(job))
+		{
+			return false;
+		}
+	}
+
+	// Bumped under the wake mutex so a worker cannot miss it between its check and its wait
+	std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+	++m_numQueuedJobs;
+	if (job.m_isBackground)
+	{
+		++m_numQueuedBackgroundJobs;
+	}
+	return true;
+}
+
+void JobSystem::JobQueue::Allocate(size_t capacity)
+{
+	m_slots.clear();
+	m_slots.resize(capacity);
+	m_firstSlot = 0;
+	m_numJobs = 0;
+}
+
+bool JobSystem::JobQueue::PushBack(Job const& job)
+{
+	// Small job lambdas fit in std::function's inline storage, so the copy does not allocate either
+	if (m_numJobs == m_slots.size())
+	{
+		return false;
+	}
+	m_slots[(m_firstSlot + m_numJobs) & (m_slots.size() - 1)] = job;
+	++m_numJobs;
+	return true;
+}
+
+bool JobSystem::JobQueue::PopBack(Job& out_job)
+{
+	if (m_numJobs == 0)
+	{
+		return false;
+	}
+	--m_numJobs;
+	Job& slotJob = m_slots[(m_firstSlot + m_numJobs) & (m_slots.size() - 1)];
+	out_job = std::move(slotJob);
+	slotJob.m_jobFunction = nullptr;
+	return true;
+}
+
+bool JobSystem::JobQueue::PopFront(Job& out_job)
+{
+	if (m_numJobs == 0)
+	{
+		return false;
+	}
+	Job& slotJob = m_slots[m_firstSlot];
+	out_job = std::move(slotJob);
+	slotJob.m_jobFunction = nullptr;
+	m_firstSlot = (m_firstSlot + 1) & (m_slots.size() - 1);
+	--m_numJobs;
+	return true;
+}
+
+bool JobSystem::JobQueue::TakeJobForCounter(JobCounter const* counter, Job& out_job)
+{
+	// Oldest first; a null counter matches any job
+	size_t slotMask = m_slots.size() - 1;
+	for (size_t jobIndex = 0; jobIndex < m_numJobs; ++jobIndex)
+	{
+		Job& slotJob = m_slots[(m_firstSlot + jobIndex) & slotMask];
+		if (counter != nullptr && slotJob.m_numJobsRemaining != &counter->m_numJobsRemaining)
+		{
+			continue;
+		}
+
+		// Later jobs move up one slot to close the gap, keeping the ring in submission order
+		out_job = std::move(slotJob);
+		for (size_t laterIndex = jobIndex + 1; laterIndex < m_numJobs; ++laterIndex)
+		{
+			m_slots[(m_firstSlot + laterIndex - 1) & slotMask] = std::move(m_slots[(m_firstSlot + laterIndex) & slotMask]);
+		}
+		--m_numJobs;
+		m_slots[(m_firstSlot + m_numJobs) & slotMask].m_jobFunction = nullptr;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+// -----------------------------------------------------------------------------
+typedef std::function<void(int beginIndex, int endIndex)> ParallelForFunction;
+typedef std::function<void()> JobFunction;
+// -----------------------------------------------------------------------------
+struct JobCounter
+{
+	std::atomic<int> m_numJobsRemaining{ 0 };
+
+	bool IsDone() const { return m_numJobsRemaining.load(std::memory_order_acquire) == 0; }
+};
+// -----------------------------------------------------------------------------
+enum class JobPriority
+{
+	FRAME,			// Waited on later in the same frame, like the render list build
+	BACKGROUND,		// File reads and decoding with no deadline; at least one worker is always left for FRAME jobs
+};
+// -----------------------------------------------------------------------------
+struct JobSystemConfig
+{
+	int m_numWorkerThreads = -1;	// -1 uses one worker per hardware thread, minus the main thread
+	int m_jobQueueCapacity = 1024;	// Per queue, rounded up to a power of two; a job pushed onto a full queue runs inline instead
+};
+// -----------------------------------------------------------------------------
+// Small work-stealing job system. Every worker (and the main thread, while it
+// waits inside ParallelFor) owns a queue; a thread pops from the back of its own
+// queue and steals from the front of the others when it runs dry. ParallelFor
+// hands each index range to exactly one job, so work that only writes to its
+// own indexes produces the same result regardless of thread count or order.
+// Jobs from SubmitJob go to separate queues, one per priority, that only idle
+// workers take from, so they overlap with the submitting thread instead of
+// being picked up by its ParallelFor waits; WaitForCounter only runs jobs of
+// the counter it waits on.
+// -----------------------------------------------------------------------------
+class JobSystem
+{
+public:
+	JobSystem(JobSystemConfig const& config);
+	~JobSystem();
+
+	void Startup();
+	void Shutdown();
+
+	void ParallelFor(int numIndexes, int grainSize, ParallelForFunction const& rangeFunction);
+	void SubmitJob(JobFunction const& jobFunction, JobCounter& counter, JobPriority priority = JobPriority::FRAME);
+	void WaitForCounter(JobCounter const& counter);
+	int  GetNumWorkerThreads() const;
+
+private:
+	struct Job
+	{
+		ParallelForFunction const* m_rangeFunction = nullptr;
+		JobFunction m_jobFunction;
+		int m_beginIndex = 0;
+		int m_endIndex = 0;
+		std::atomic<int>* m_numJobsRemaining = nullptr;
+		bool m_isBackground = false;
+	};
+
+	// Fixed-capacity ring allocated at Startup, so queueing a job never touches the heap
+	struct JobQueue
+	{
+		std::mutex m_mutex;
+		std::vector<Job> m_slots;
+		size_t m_firstSlot = 0;		// Oldest job, the one stolen first
+		size_t m_numJobs = 0;
+
+		void Allocate(size_t capacity);
+		bool PushBack(Job const& job);
+		bool PopBack(Job& out_job);
+		bool PopFront(Job& out_job);
+		bool TakeJobForCounter(JobCounter const* counter, Job& out_job);
+	};
+
+	void WorkerThreadMain(int queueIndex);
+	bool TryRunOneJob(int queueIndex);
+	bool TryRunSubmittedJob(JobQueue& queue, JobCounter const* counter);
+	bool TryRunBackgroundJob();
+	bool HasJobsForIdleWorker() const;
+	void RunJob(Job& job);
+	bool PushJob(JobQueue& queue, Job const& job);
+
+private:
+	JobSystemConfig m_config;
+	std::vector<std::thread> m_workerThreads;
+	std::vector<JobQueue*> m_queues;
+	JobQueue m_submittedJobs;
+	JobQueue m_backgroundJobs;
+	int m_maxRunningBackgroundJobs = 0;
+
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+	std::atomic<int> m_numQueuedJobs;
+	std::atomic<int> m_numQueuedBackgroundJobs;
+	std::atomic<int> m_numRunningBackgroundJobs;
+	std::atomic<bool> m_isQuitting;
+};
\ No newline at end of file
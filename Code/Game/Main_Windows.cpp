@@ -13,20 +13,32 @@ extern App* g_theApp;				// Created and owned by Main_Windows.cpp
 //-----------------------------------------------------------------------------------------------
 int WINAPI WinMain(HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int)
 {
-	UNUSED(commandLineString);
 	UNUSED(applicationInstanceHandle);
 
 	g_theApp = new App();
+	g_theApp->ParseCommandLine(commandLineString);
 	g_theApp->Startup();
 
 	// Program main loop; keep running frames until it's time to quit
-	g_theApp->RunMainLoop();
+	if (g_theApp->IsBenchmark())
+	{
+		g_theApp->RunBenchmark();
+	}
+	else if (g_theApp->IsHeadless())
+	{
+		g_theApp->RunHeadless();
+	}
+	else
+	{
+		g_theApp->RunMainLoop();
+	}
 
 	g_theApp->Shutdown();
+	int exitCode = g_theApp->GetExitCode();
 	delete g_theApp;
 	g_theApp = nullptr;
 
-	return 0;
+	return exitCode;
 }
 
 
@@ -0,0 +1,116 @@
+#include "Game/MappedFile.hpp"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+bool MappedFile::Open(std::string const& filePath)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_fileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_mappingHandle = mappingHandle;
+
+	m_data = static_cast<unsigned char const*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+	m_size = 0;
+}
+#else
+bool MappedFile::Open(std::string const& filePath)
+{
+	Close();
+
+	int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close(fileDescriptor);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file, so the descriptor is not needed once it exists
+	void* data = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	close(fileDescriptor);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	m_data = static_cast<unsigned char const*>(data);
+	m_size = static_cast<size_t>(fileStatus.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+		m_data = nullptr;
+	}
+	m_size = 0;
+}
+#endif
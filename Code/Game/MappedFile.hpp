@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+// -----------------------------------------------------------------------------
+// Read-only memory mapping of a whole file. The bytes stay valid until Close,
+// and pages are only read from disk when they are first touched. Windows maps
+// through a file mapping object, everything else through mmap.
+// -----------------------------------------------------------------------------
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(std::string const& filePath);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	unsigned char const* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	MappedFile(MappedFile const& copy) = delete;
+	MappedFile& operator=(MappedFile const& copy) = delete;
+
+private:
+#if defined(_WIN32)
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+	unsigned char const* m_data = nullptr;
+	size_t m_size = 0;
+};
\ No newline at end of file
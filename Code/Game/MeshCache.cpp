@@ -0,0 +1,311 @@
+#include "Game/MeshCache.hpp"
+#include "Game/IndexedVertexUtils.hpp"
+#include "Engine/Core/VertexUtils.h"
+#include "Engine/Core/EngineCommon.h"
+#include <math.h>
+
+//#define MESH_CACHE_LOG_OPTIMIZER_STATS	// (If uncommented) Prints each built mesh's vertex and index counts and post-transform cache miss ratio
+
+int ChooseMeshLod(float screenRadiusPixels, int currentLod)
+{
+	// Without a previous level there is nothing to hold on to, so the plain thresholds decide
+	float hysteresis = MESH_LOD_HYSTERESIS;
+	if (currentLod < 0 || currentLod >= MESH_NUM_LODS)
+	{
+		currentLod = MESH_NUM_LODS - 1;
+		hysteresis = 0.f;
+	}
+
+	int lod = currentLod;
+	while (lod > 0 && screenRadiusPixels >= MESH_LOD_MIN_SCREEN_RADII[lod - 1] * (1.f + hysteresis))
+	{
+		--lod;
+	}
+	while (lod < MESH_NUM_LODS - 1 && screenRadiusPixels < MESH_LOD_MIN_SCREEN_RADII[lod] * (1.f - hysteresis))
+	{
+		++lod;
+	}
+	return lod;
+}
+
+bool MeshKey::operator==(MeshKey const& compare) const
+{
+	return m_shape == compare.m_shape && m_numSlices == compare.m_numSlices && m_numStacks == compare.m_numStacks;
+}
+
+unsigned int Mesh::GetIndex(size_t indexIndex) const
+{
+	if (m_indexFormat == MeshIndexFormat::UINT16)
+	{
+		return static_cast<uint16_t const*>(m_indexes)[indexIndex];
+	}
+	return static_cast<uint32_t const*>(m_indexes)[indexIndex];
+}
+
+MeshKey MeshKey::MakeFullDetail(MeshShape shape)
+{
+	MeshKey key;
+	key.m_shape = shape;
+	switch (shape)
+	{
+		case MeshShape::SPHERE:		key.m_numSlices = SPHERE_NUM_SLICES; key.m_numStacks = SPHERE_NUM_STACKS;	break;
+		case MeshShape::CYLINDER:	key.m_numSlices = CYLINDER_NUM_SLICES;	break;
+		case MeshShape::ARROW:		key.m_numSlices = ARROW_NUM_SLICES;		break;
+		default:															break;
+	}
+	return key;
+}
+
+MeshCache::MeshCache()
+{
+}
+
+MeshCache::~MeshCache()
+{
+	Clear();
+}
+
+int MeshCache::CreateOrGetMeshID(MeshKey const& key)
+{
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	int existingMeshID = FindMeshID(key);
+	if (existingMeshID != -1)
+	{
+		return existingMeshID;
+	}
+
+	m_loadedMeshes.push_back(CreateMesh(key));
+	int meshID = static_cast<int>(m_loadedMeshes.size()) - 1;
+	CreateLodMeshes(meshID);
+	return meshID;
+}
+
+int MeshCache::CreateOrGetMeshIDFromData(MeshKey const& key, Vertex_PCU const* vertexes, size_t numVertexes, void const* indexes, MeshIndexFormat indexFormat,
+	size_t numIndexes)
+{
+	// Data baked by the scene converter is already optimized and is used in place; the caller keeps it valid until Clear
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	int existingMeshID = FindMeshID(key);
+	if (existingMeshID != -1)
+	{
+		return existingMeshID;
+	}
+
+	Mesh* mesh = new Mesh();
+	mesh->m_key = key;
+	mesh->m_vertexes = vertexes;
+	mesh->m_indexes = indexes;
+	mesh->m_numVertexes = numVertexes;
+	mesh->m_numIndexes = numIndexes;
+	mesh->m_indexFormat = indexFormat;
+	ComputeMeshBounds(*mesh);
+	m_loadedMeshes.push_back(mesh);
+	int meshID = static_cast<int>(m_loadedMeshes.size()) - 1;
+	CreateLodMeshes(meshID);
+	return meshID;
+}
+
+int MeshCache::GetMeshIDForKey(MeshKey const& key) const
+{
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	return FindMeshID(key);
+}
+
+int MeshCache::FindMeshID(MeshKey const& key) const
+{
+	for (size_t meshIndex = 0; meshIndex < m_loadedMeshes.size(); ++meshIndex)
+	{
+		if (m_loadedMeshes[meshIndex]->m_key == key)
+		{
+			return static_cast<int>(meshIndex);
+		}
+	}
+	return -1;
+}
+
+Mesh const& MeshCache::GetMesh(int meshID) const
+{
+	// Meshes are never moved or freed before Clear, so the reference outlives the lock
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	GUARANTEE_OR_DIE(meshID >= 0 && meshID < static_cast<int>(m_loadedMeshes.size()), "MeshCache::GetMesh called with an invalid mesh ID");
+	return *m_loadedMeshes[meshID];
+}
+
+void MeshCache::GetLodMeshIDs(std::vector<int>& out_lodMeshIDs) const
+{
+	// Every chain in one pass, MESH_NUM_LODS entries per mesh ID, so a caller choosing levels for many props takes the lock once
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	out_lodMeshIDs.resize(m_loadedMeshes.size() * MESH_NUM_LODS);
+	for (size_t meshIndex = 0; meshIndex < m_loadedMeshes.size(); ++meshIndex)
+	{
+		for (int lod = 0; lod < MESH_NUM_LODS; ++lod)
+		{
+			out_lodMeshIDs[meshIndex * MESH_NUM_LODS + lod] = m_loadedMeshes[meshIndex]->m_lodMeshIDs[lod];
+		}
+	}
+}
+
+int MeshCache::GetNumMeshes() const
+{
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	return static_cast<int>(m_loadedMeshes.size());
+}
+
+void MeshCache::Clear()
+{
+	std::lock_guard<std::mutex> meshesLock(m_meshesMutex);
+	for (size_t meshIndex = 0; meshIndex < m_loadedMeshes.size(); ++meshIndex)
+	{
+		delete m_loadedMeshes[meshIndex];
+	}
+	m_loadedMeshes.clear();
+}
+
+Mesh* MeshCache::CreateMesh(MeshKey const& key) const
+{
+	Mesh* mesh = new Mesh();
+	mesh->m_key = key;
+
+	std::vector<Vertex_PCU> vertexes;
+	std::vector<unsigned int> indexes;
+	switch (key.m_shape)
+	{
+		case MeshShape::CUBE:
+		{
+			// +X
+			AddVertsForIndexedQuad3D(vertexes, indexes, Vec3(0.5f, -0.5f, -0.5f), Vec3(0.5f, 0.5f, -0.5f), Vec3(0.5f, 0.5f, 0.5f), Vec3(0.5f, -0.5f, 0.5f), Rgba8::RED);
+
+			// -X
+			AddVertsForIndexedQuad3D(vertexes, indexes, Vec3(-0.5f, 0.5f, -0.5f), Vec3(-0.5f, -0.5f, -0.5f), Vec3(-0.5f, -0.5f, 0.5f), Vec3(-0.5f, 0.5f, 0.5f), Rgba8::CYAN);
+
+			// +Y
+			AddVertsForIndexedQuad3D(vertexes, indexes, Vec3(0.5f, 0.5f, -0.5f), Vec3(-0.5f, 0.5f, -0.5f), Vec3(-0.5f, 0.5f, 0.5f), Vec3(0.5f, 0.5f, 0.5f), Rgba8::GREEN);
+
+			// -Y
+			AddVertsForIndexedQuad3D(vertexes, indexes, Vec3(-0.5f, -0.5f, -0.5f), Vec3(0.5f, -0.5f, -0.5f), Vec3(0.5f, -0.5f, 0.5f), Vec3(-0.5f, -0.5f, 0.5f), Rgba8::MAGENTA);
+
+			// +Z
+			AddVertsForIndexedQuad3D(vertexes, indexes, Vec3(0.5f, 0.5f, 0.5f), Vec3(-0.5f, 0.5f, 0.5f), Vec3(-0.5f, -0.5f, 0.5f), Vec3(0.5f, -0.5f, 0.5f), Rgba8::BLUE);
+
+			// -Z
+			AddVertsForIndexedQuad3D(vertexes, indexes, Vec3(-0.5f, 0.5f, -0.5f), Vec3(0.5f, 0.5f, -0.5f), Vec3(0.5f, -0.5f, -0.5f), Vec3(-0.5f, -0.5f, -0.5f), Rgba8::YELLOW);
+			break;
+		}
+		case MeshShape::SPHERE:
+		{
+			AddVertsForIndexedSphere3D(vertexes, indexes, Vec3(0.f, 0.f, 0.f), 1.f, Rgba8::WHITE, AABB2(Vec2::ZERO, Vec2::ONE), key.m_numSlices, key.m_numStacks);
+			break;
+		}
+		case MeshShape::CYLINDER:
+		{
+			// Fills the same unit box as the cube, standing on the z axis
+			AddVertsForIndexedCylinder3D(vertexes, indexes, Vec3(0.f, 0.f, -0.5f), Vec3(0.f, 0.f, 0.5f), 0.5f, Rgba8::WHITE, AABB2(Vec2::ZERO, Vec2::ONE), key.m_numSlices);
+			break;
+		}
+		case MeshShape::ARROW:
+		{
+			// One unit long and pointing forward along x, centered on the origin
+			AddVertsForIndexedArrow3D(vertexes, indexes, Vec3(-0.5f, 0.f, 0.f), Vec3(0.5f, 0.f, 0.f), 0.08f, Rgba8::WHITE, key.m_numSlices);
+			break;
+		}
+		default:
+		{
+			ERROR_AND_DIE("MeshCache::CreateMesh called with an unknown MeshShape");
+		}
+	}
+
+	// Built once per mesh, so the optimizer passes cost nothing at draw time
+	DeduplicateVertexes(vertexes, indexes);
+	OptimizeVertexCacheOrder(indexes, static_cast<int>(vertexes.size()));
+	OptimizeVertexFetchOrder(vertexes, indexes);
+#if defined(MESH_CACHE_LOG_OPTIMIZER_STATS)
+	DebuggerPrintf("MeshCache: mesh %d has %d vertexes, %d indexes, ACMR %.3f\n", static_cast<int>(key.m_shape), static_cast<int>(vertexes.size()),
+		static_cast<int>(indexes.size()), GetAverageCacheMissRatio(indexes));
+#endif
+
+	SetOwnedMeshData(*mesh, vertexes, indexes);
+	ComputeMeshBounds(*mesh);
+	return mesh;
+}
+
+void MeshCache::SetOwnedMeshData(Mesh& mesh, std::vector<Vertex_PCU>& vertexes, std::vector<unsigned int> const& indexes) const
+{
+	mesh.m_ownedVertexes.swap(vertexes);
+	mesh.m_vertexes = mesh.m_ownedVertexes.data();
+	mesh.m_numVertexes = mesh.m_ownedVertexes.size();
+	mesh.m_numIndexes = indexes.size();
+	if (mesh.m_numVertexes <= MESH_MAX_UINT16_VERTEXES)
+	{
+		mesh.m_ownedShortIndexes.resize(indexes.size());
+		for (size_t index = 0; index < indexes.size(); ++index)
+		{
+			mesh.m_ownedShortIndexes[index] = static_cast<uint16_t>(indexes[index]);
+		}
+		mesh.m_indexes = mesh.m_ownedShortIndexes.data();
+		mesh.m_indexFormat = MeshIndexFormat::UINT16;
+	}
+	else
+	{
+		mesh.m_ownedIndexes.assign(indexes.begin(), indexes.end());
+		mesh.m_indexes = mesh.m_ownedIndexes.data();
+		mesh.m_indexFormat = MeshIndexFormat::UINT32;
+	}
+}
+
+void MeshCache::CreateLodMeshes(int meshID)
+{
+	// Called with the meshes lock held; coarser copies of the procedural shapes are built up front so no level is ever created mid-frame
+	Mesh* mesh = m_loadedMeshes[meshID];
+	MeshKey lodKey = mesh->m_key;
+	mesh->m_lodMeshIDs[0] = meshID;
+	for (int lod = 1; lod < MESH_NUM_LODS; ++lod)
+	{
+		int lodMeshID = mesh->m_lodMeshIDs[lod - 1];
+		if (lodKey.m_shape != MeshShape::CUBE)
+		{
+			lodKey.m_numSlices = lodKey.m_numSlices / 2 > MESH_LOD_MIN_SLICES ? lodKey.m_numSlices / 2 : MESH_LOD_MIN_SLICES;
+			if (lodKey.m_shape == MeshShape::SPHERE)
+			{
+				lodKey.m_numStacks = lodKey.m_numStacks / 2 > MESH_LOD_MIN_STACKS ? lodKey.m_numStacks / 2 : MESH_LOD_MIN_STACKS;
+			}
+			if (!(lodKey == m_loadedMeshes[lodMeshID]->m_key))
+			{
+				lodMeshID = FindMeshID(lodKey);
+				if (lodMeshID == -1)
+				{
+					// A coarser mesh is its own lowest level and keeps pointing at itself for the rest of the chain
+					Mesh* lodMesh = CreateMesh(lodKey);
+					m_loadedMeshes.push_back(lodMesh);
+					lodMeshID = static_cast<int>(m_loadedMeshes.size()) - 1;
+					for (int lodLevel = 0; lodLevel < MESH_NUM_LODS; ++lodLevel)
+					{
+						lodMesh->m_lodMeshIDs[lodLevel] = lodMeshID;
+					}
+				}
+			}
+		}
+		mesh->m_lodMeshIDs[lod] = lodMeshID;
+	}
+}
+
+void MeshCache::ComputeMeshBounds(Mesh& mesh) const
+{
+	// Local-space bounds, used for culling and spatial queries
+	if (mesh.m_numVertexes == 0)
+	{
+		return;
+	}
+
+	Vec3 mins = mesh.m_vertexes[0].m_position;
+	Vec3 maxs = mins;
+	float maxLengthSquared = 0.f;
+	for (size_t vertIndex = 0; vertIndex < mesh.m_numVertexes; ++vertIndex)
+	{
+		Vec3 const& position = mesh.m_vertexes[vertIndex].m_position;
+		mins = Vec3(fminf(mins.x, position.x), fminf(mins.y, position.y), fminf(mins.z, position.z));
+		maxs = Vec3(fmaxf(maxs.x, position.x), fmaxf(maxs.y, position.y), fmaxf(maxs.z, position.z));
+		maxLengthSquared = fmaxf(maxLengthSquared, position.GetLengthSquared());
+	}
+	mesh.m_bounds = AABB3(mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
+	mesh.m_boundingRadius = sqrtf(maxLengthSquared);
+}
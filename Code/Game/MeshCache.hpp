@@ -0,0 +1,105 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Math/AABB3.hpp"
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class MeshShape
+{
+	CUBE,
+	SPHERE,
+	CYLINDER,
+	ARROW,
+	COUNT
+};
+// -----------------------------------------------------------------------------
+constexpr int SPHERE_NUM_SLICES = 32;
+constexpr int SPHERE_NUM_STACKS = 16;
+constexpr int CYLINDER_NUM_SLICES = 32;
+constexpr int ARROW_NUM_SLICES = 32;
+constexpr size_t MESH_MAX_UINT16_VERTEXES = 0x10000;
+// -----------------------------------------------------------------------------
+// Procedural shapes get coarser copies that halve the slices and stacks per
+// level, down to a floor that still reads as the shape. Levels are picked per
+// prop from its projected radius in pixels at a reference screen height; a prop
+// only moves to a finer level once it is MESH_LOD_HYSTERESIS past the threshold
+// and only moves back once it is that far below it, so props sitting right at a
+// threshold do not flicker between levels.
+// -----------------------------------------------------------------------------
+constexpr int MESH_NUM_LODS = 4;
+constexpr int MESH_LOD_MIN_SLICES = 6;
+constexpr int MESH_LOD_MIN_STACKS = 3;
+constexpr float MESH_LOD_REFERENCE_SCREEN_HEIGHT = 1080.f;
+constexpr float MESH_LOD_HYSTERESIS = 0.15f;
+constexpr float MESH_LOD_MIN_SCREEN_RADII[MESH_NUM_LODS] = { 48.f, 14.f, 7.f, 0.f };	// Keeps the silhouette within about a pixel of the full mesh
+constexpr unsigned char MESH_LOD_UNSET = 0xFF;
+
+int ChooseMeshLod(float screenRadiusPixels, int currentLod);
+// -----------------------------------------------------------------------------
+struct MeshKey
+{
+	MeshShape m_shape = MeshShape::CUBE;
+	int m_numSlices = 0;
+	int m_numStacks = 0;
+
+	bool operator==(MeshKey const& compare) const;
+
+	static MeshKey MakeFullDetail(MeshShape shape);
+};
+// -----------------------------------------------------------------------------
+enum class MeshIndexFormat : unsigned char
+{
+	UINT16,		// Any mesh with at most MESH_MAX_UINT16_VERTEXES vertexes
+	UINT32,
+};
+// -----------------------------------------------------------------------------
+// Mesh data is read through pointers so it can live in the cache's own storage
+// or anywhere else that outlives the mesh. Indexes are stored in 16 bits
+// whenever the vertex count allows, halving their memory and read bandwidth.
+// -----------------------------------------------------------------------------
+struct Mesh
+{
+	MeshKey m_key;
+	Vertex_PCU const* m_vertexes = nullptr;		// Unique vertexes, in the order the indexes first use them
+	size_t m_numVertexes = 0;
+	void const* m_indexes = nullptr;			// Triangle list in m_indexFormat, ordered for the post-transform vertex cache
+	size_t m_numIndexes = 0;
+	MeshIndexFormat m_indexFormat = MeshIndexFormat::UINT16;
+	AABB3 m_bounds;
+	float m_boundingRadius = 0.f;
+	int m_lodMeshIDs[MESH_NUM_LODS] = { -1, -1, -1, -1 };	// Level 0 is this mesh; shapes without coarser levels repeat it
+
+	std::vector<Vertex_PCU> m_ownedVertexes;	// Backing storage for procedural meshes; empty for meshes that point into a mapped scene file
+	std::vector<uint16_t> m_ownedShortIndexes;
+	std::vector<uint32_t> m_ownedIndexes;
+
+	unsigned int GetIndex(size_t indexIndex) const;
+};
+// -----------------------------------------------------------------------------
+class MeshCache
+{
+public:
+	MeshCache();
+	~MeshCache();
+
+	int CreateOrGetMeshID(MeshKey const& key);
+	int CreateOrGetMeshIDFromData(MeshKey const& key, Vertex_PCU const* vertexes, size_t numVertexes, void const* indexes, MeshIndexFormat indexFormat, size_t numIndexes);
+	int GetMeshIDForKey(MeshKey const& key) const;
+	Mesh const& GetMesh(int meshID) const;
+	void GetLodMeshIDs(std::vector<int>& out_lodMeshIDs) const;
+	int GetNumMeshes() const;
+	void Clear();
+
+private:
+	Mesh* CreateMesh(MeshKey const& key) const;
+	void SetOwnedMeshData(Mesh& mesh, std::vector<Vertex_PCU>& vertexes, std::vector<unsigned int> const& indexes) const;
+	void CreateLodMeshes(int meshID);
+	void ComputeMeshBounds(Mesh& mesh) const;
+	int  FindMeshID(MeshKey const& key) const;
+
+private:
+	// Meshes are looked up from the render-list job while the simulation may be creating new ones
+	mutable std::mutex m_meshesMutex;
+	std::vector<Mesh*> m_loadedMeshes;
+};
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "Game/OcclusionBuffer.hpp"
+#include "Game/MeshCache.hpp"
+#include "Game/Frustum.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <emmintrin.h>
+#include <float.h>
+#include <fstream>
+#include <math.h>
+
+constexpr float OCCLUSION_MIN_TRIANGLE_AREA = 1e-6f;	// Twice the screen area in pixels; anything smaller covers no pixel center
+
+OcclusionBuffer::OcclusionBuffer()
+{
+	for (int level = 0; level < OCCLUSION_NUM_DEPTH_LEVELS; ++level)
+	{
+		m_depthLevels[level].resize(static_cast<size_t>((OCCLUSION_BUFFER_WIDTH >> level) * (OCCLUSION_BUFFER_HEIGHT >> level)), 0.f);
+	}
+}
+
+OcclusionBuffer::~OcclusionBuffer()
+{
+}
+
+void OcclusionBuffer::BeginFrame(Vec3 const& position, EulerAngles const& orientation, float aspect, float fovDegrees, float nearZ, float farZ)
+{
+	Mat44 orientationMatrix = orientation.GetAsMatrix_IFwd_JLeft_KUp();
+	m_viewPosition = position;
+	m_viewForward = orientationMatrix.GetIBasis3D();
+	m_viewRight = orientationMatrix.GetJBasis3D() * -1.f;
+	m_viewUp = orientationMatrix.GetKBasis3D();
+	m_nearZ = nearZ;
+	m_farZ = farZ;
+
+	float projectionScale = Frustum::GetProjectionScale(fovDegrees);
+	m_screenScaleX = 0.5f * static_cast<float>(OCCLUSION_BUFFER_WIDTH) * projectionScale / aspect;
+	m_screenScaleY = 0.5f * static_cast<float>(OCCLUSION_BUFFER_HEIGHT) * projectionScale;
+
+	// Zero reciprocal depth is infinitely far, so an empty buffer occludes nothing
+	std::vector<float>& depth = m_depthLevels[0];
+	depth.assign(depth.size(), 0.f);
+	m_numRasterizedTriangles = 0;
+}
+
+void OcclusionBuffer::RasterizeMesh(Mesh const& mesh, Mat44 const& modelToWorldTransform)
+{
+	// Fold the model-to-world transform and the view basis into one 3x4 transform, so each vertex takes nine multiply-adds
+	Vec3 iBasis = modelToWorldTransform.GetIBasis3D();
+	Vec3 jBasis = modelToWorldTransform.GetJBasis3D();
+	Vec3 kBasis = modelToWorldTransform.GetKBasis3D();
+	Vec3 translation = modelToWorldTransform.GetTranslation3D() - m_viewPosition;
+	Vec3 const viewAxes[3] = { m_viewRight, m_viewUp, m_viewForward };
+	float modelToView[3][4];
+	for (int row = 0; row < 3; ++row)
+	{
+		modelToView[row][0] = DotProduct3D(viewAxes[row], iBasis);
+		modelToView[row][1] = DotProduct3D(viewAxes[row], jBasis);
+		modelToView[row][2] = DotProduct3D(viewAxes[row], kBasis);
+		modelToView[row][3] = DotProduct3D(viewAxes[row], translation);
+	}
+
+	size_t numVertexes = mesh.m_numVertexes;
+	m_viewVertexes.resize(numVertexes);
+	for (size_t vertexIndex = 0; vertexIndex < numVertexes; ++vertexIndex)
+	{
+		Vec3 const& modelPosition = mesh.m_vertexes[vertexIndex].m_position;
+		float viewValues[3];
+		for (int row = 0; row < 3; ++row)
+		{
+			viewValues[row] = modelToView[row][0] * modelPosition.x + modelToView[row][1] * modelPosition.y + modelToView[row][2] * modelPosition.z + modelToView[row][3];
+		}
+		m_viewVertexes[vertexIndex] = Vec3(viewValues[0], viewValues[1], viewValues[2]);
+	}
+
+	for (size_t index = 0; index + 2 < mesh.m_numIndexes; index += 3)
+	{
+		RasterizeClippedTriangle(m_viewVertexes[mesh.GetIndex(index)], m_viewVertexes[mesh.GetIndex(index + 1)], m_viewVertexes[mesh.GetIndex(index + 2)]);
+	}
+}
+
+void OcclusionBuffer::BuildHierarchicalDepth()
+{
+	// Each texel keeps the farthest (smallest) reciprocal depth of the four below it
+	for (int level = 1; level < OCCLUSION_NUM_DEPTH_LEVELS; ++level)
+	{
+		std::vector<float> const& source = m_depthLevels[level - 1];
+		std::vector<float>& destination = m_depthLevels[level];
+		int sourceWidth = OCCLUSION_BUFFER_WIDTH >> (level - 1);
+		int width = OCCLUSION_BUFFER_WIDTH >> level;
+		int height = OCCLUSION_BUFFER_HEIGHT >> level;
+		for (int y = 0; y < height; ++y)
+		{
+			float const* sourceRow0 = &source[static_cast<size_t>(2 * y * sourceWidth)];
+			float const* sourceRow1 = sourceRow0 + sourceWidth;
+			for (int x = 0; x < width; ++x)
+			{
+				float top = fminf(sourceRow0[2 * x], sourceRow0[2 * x + 1]);
+				float bottom = fminf(sourceRow1[2 * x], sourceRow1[2 * x + 1]);
+				destination[static_cast<size_t>(y * width + x)] = fminf(top, bottom);
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::IsSphereOccluded(Vec3 const& center, float radius) const
+{
+	Vec3 displacement = center - m_viewPosition;
+	float viewX = DotProduct3D(displacement, m_viewRight);
+	float viewY = DotProduct3D(displacement, m_viewUp);
+	float viewZ = DotProduct3D(displacement, m_viewForward);
+	float nearestZ = viewZ - radius;
+	if (nearestZ <= m_nearZ)
+	{
+		return false;
+	}
+
+	// Screen extents of the sphere's bounding box, dividing each side by whichever depth pushes it outward
+	float farthestZ = viewZ + radius;
+	float minX = (viewX - radius) / (viewX - radius >= 0.f ? farthestZ : nearestZ);
+	float maxX = (viewX + radius) / (viewX + radius >= 0.f ? nearestZ : farthestZ);
+	float minY = (viewY - radius) / (viewY - radius >= 0.f ? farthestZ : nearestZ);
+	float maxY = (viewY + radius) / (viewY + radius >= 0.f ? nearestZ : farthestZ);
+
+	float const halfWidth = 0.5f * static_cast<float>(OCCLUSION_BUFFER_WIDTH);
+	float const halfHeight = 0.5f * static_cast<float>(OCCLUSION_BUFFER_HEIGHT);
+	float left = GetClamped(halfWidth + minX * m_screenScaleX, -1.f, static_cast<float>(OCCLUSION_BUFFER_WIDTH));
+	float right = GetClamped(halfWidth + maxX * m_screenScaleX, -1.f, static_cast<float>(OCCLUSION_BUFFER_WIDTH));
+	float top = GetClamped(halfHeight - maxY * m_screenScaleY, -1.f, static_cast<float>(OCCLUSION_BUFFER_HEIGHT));
+	float bottom = GetClamped(halfHeight - minY * m_screenScaleY, -1.f, static_cast<float>(OCCLUSION_BUFFER_HEIGHT));
+
+	int minPixelX = static_cast<int>(floorf(left)) - 1;
+	int maxPixelX = static_cast<int>(floorf(right)) + 1;
+	int minPixelY = static_cast<int>(floorf(top)) - 1;
+	int maxPixelY = static_cast<int>(floorf(bottom)) + 1;
+	if (maxPixelX < 0 || maxPixelY < 0 || minPixelX >= OCCLUSION_BUFFER_WIDTH || minPixelY >= OCCLUSION_BUFFER_HEIGHT)
+	{
+		return false;
+	}
+	minPixelX = minPixelX < 0 ? 0 : minPixelX;
+	minPixelY = minPixelY < 0 ? 0 : minPixelY;
+	maxPixelX = maxPixelX >= OCCLUSION_BUFFER_WIDTH ? OCCLUSION_BUFFER_WIDTH - 1 : maxPixelX;
+	maxPixelY = maxPixelY >= OCCLUSION_BUFFER_HEIGHT ? OCCLUSION_BUFFER_HEIGHT - 1 : maxPixelY;
+
+	// The first level where the rectangle spans at most two texels each way, so the test reads four values at most
+	int level = 0;
+	while (level < OCCLUSION_NUM_DEPTH_LEVELS - 1 && ((maxPixelX >> level) - (minPixelX >> level) > 1 || (maxPixelY >> level) - (minPixelY >> level) > 1))
+	{
+		++level;
+	}
+
+	std::vector<float> const& depth = m_depthLevels[level];
+	int width = OCCLUSION_BUFFER_WIDTH >> level;
+	float farthestOccluderDepth = FLT_MAX;
+	for (int y = minPixelY >> level; y <= (maxPixelY >> level); ++y)
+	{
+		for (int x = minPixelX >> level; x <= (maxPixelX >> level); ++x)
+		{
+			farthestOccluderDepth = fminf(farthestOccluderDepth, depth[static_cast<size_t>(y * width + x)]);
+		}
+	}
+	return farthestOccluderDepth > 1.f / nearestZ;
+}
+
+int OcclusionBuffer::CullOccludedSpheres(int numSpheres, float const* centersX, float const* centersY, float const* centersZ, float const* radii, unsigned char* inout_isVisible) const
+{
+	int numOccluded = 0;
+	for (int sphereIndex = 0; sphereIndex < numSpheres; ++sphereIndex)
+	{
+		if (inout_isVisible[sphereIndex] != 0 && IsSphereOccluded(Vec3(centersX[sphereIndex], centersY[sphereIndex], centersZ[sphereIndex]), radii[sphereIndex]))
+		{
+			inout_isVisible[sphereIndex] = 0;
+			++numOccluded;
+		}
+	}
+	return numOccluded;
+}
+
+float OcclusionBuffer::GetInverseDepth(int x, int y) const
+{
+	return m_depthLevels[0][static_cast<size_t>(y * OCCLUSION_BUFFER_WIDTH + x)];
+}
+
+bool OcclusionBuffer::ExportDepthImage(std::string const& filePath) const
+{
+	std::ofstream imageFile(filePath, std::ios::binary);
+	if (!imageFile.is_open())
+	{
+		return false;
+	}
+
+	// Binary PGM, white at the near plane fading to black at the far plane, black where nothing was drawn
+	imageFile << "P5\n" << OCCLUSION_BUFFER_WIDTH << " " << OCCLUSION_BUFFER_HEIGHT << "\n255\n";
+	std::vector<unsigned char> pixels(m_depthLevels[0].size());
+	for (size_t pixelIndex = 0; pixelIndex < pixels.size(); ++pixelIndex)
+	{
+		float inverseDepth = m_depthLevels[0][pixelIndex];
+		float brightness = inverseDepth > 0.f ? 1.f - GetClamped((1.f / inverseDepth - m_nearZ) / (m_farZ - m_nearZ), 0.f, 1.f) : 0.f;
+		pixels[pixelIndex] = static_cast<unsigned char>(brightness * 255.f + 0.5f);
+	}
+	imageFile.write(reinterpret_cast<char const*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+	return imageFile.good();
+}
+
+OcclusionBuffer::ScreenVertex OcclusionBuffer::ProjectToScreen(Vec3 const& viewPosition) const
+{
+	ScreenVertex vertex;
+	vertex.m_inverseDepth = 1.f / viewPosition.z;
+	vertex.m_x = 0.5f * static_cast<float>(OCCLUSION_BUFFER_WIDTH) + viewPosition.x * vertex.m_inverseDepth * m_screenScaleX;
+	vertex.m_y = 0.5f * static_cast<float>(OCCLUSION_BUFFER_HEIGHT) - viewPosition.y * vertex.m_inverseDepth * m_screenScaleY;
+	return vertex;
+}
+
+void OcclusionBuffer::RasterizeClippedTriangle(Vec3 const& viewA, Vec3 const& viewB, Vec3 const& viewC)
+{
+	if (viewA.z >= m_nearZ && viewB.z >= m_nearZ && viewC.z >= m_nearZ)
+	{
+		RasterizeTriangle(ProjectToScreen(viewA), ProjectToScreen(viewB), ProjectToScreen(viewC));
+		return;
+	}
+
+	// Clip against the near plane; a triangle with one corner cut off becomes a quad, drawn as a fan of two triangles
+	Vec3 const corners[3] = { viewA, viewB, viewC };
+	Vec3 clipped[4];
+	int numClipped = 0;
+	for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+	{
+		Vec3 const& current = corners[cornerIndex];
+		Vec3 const& next = corners[(cornerIndex + 1) % 3];
+		bool isCurrentInside = current.z >= m_nearZ;
+		bool isNextInside = next.z >= m_nearZ;
+		if (isCurrentInside)
+		{
+			clipped[numClipped++] = current;
+		}
+		if (isCurrentInside != isNextInside)
+		{
+			float fraction = (m_nearZ - current.z) / (next.z - current.z);
+			clipped[numClipped++] = current + (next - current) * fraction;
+		}
+	}
+
+	for (int fanIndex = 1; fanIndex + 1 < numClipped; ++fanIndex)
+	{
+		RasterizeTriangle(ProjectToScreen(clipped[0]), ProjectToScreen(clipped[fanIndex]), ProjectToScreen(clipped[fanIndex + 1]));
+	}
+}
+
+void OcclusionBuffer::RasterizeTriangle(ScreenVertex const& a, ScreenVertex const& b, ScreenVertex const& c)
+{
+	// Twice the signed area; swapping two corners puts both windings in the same order
+	float area = (b.m_x - a.m_x) * (c.m_y - a.m_y) - (b.m_y - a.m_y) * (c.m_x - a.m_x);
+	ScreenVertex const* cornerB = &b;
+	ScreenVertex const* cornerC = &c;
+	if (area < 0.f)
+	{
+		cornerB = &c;
+		cornerC = &b;
+		area = -area;
+	}
+	if (area < OCCLUSION_MIN_TRIANGLE_AREA)
+	{
+		return;
+	}
+
+	float minX = fminf(a.m_x, fminf(b.m_x, c.m_x));
+	float maxX = fmaxf(a.m_x, fmaxf(b.m_x, c.m_x));
+	float minY = fminf(a.m_y, fminf(b.m_y, c.m_y));
+	float maxY = fmaxf(a.m_y, fmaxf(b.m_y, c.m_y));
+	if (maxX < 0.f || maxY < 0.f || minX >= static_cast<float>(OCCLUSION_BUFFER_WIDTH) || minY >= static_cast<float>(OCCLUSION_BUFFER_HEIGHT))
+	{
+		return;
+	}
+	int firstX = minX > 0.f ? static_cast<int>(minX) & ~3 : 0;
+	int lastX = maxX < static_cast<float>(OCCLUSION_BUFFER_WIDTH - 1) ? static_cast<int>(maxX) : OCCLUSION_BUFFER_WIDTH - 1;
+	int firstY = minY > 0.f ? static_cast<int>(minY) : 0;
+	int lastY = maxY < static_cast<float>(OCCLUSION_BUFFER_HEIGHT - 1) ? static_cast<int>(maxY) : OCCLUSION_BUFFER_HEIGHT - 1;
+
+	// Edge functions e(x, y) = stepX * x + stepY * y + offset, each zero on one edge and positive inside
+	ScreenVertex const* edgeStarts[3] = { &a, cornerB, cornerC };
+	ScreenVertex const* edgeEnds[3] = { cornerB, cornerC, &a };
+	float edgeStepX[3];
+	float edgeStepY[3];
+	float edgeOffset[3];
+	for (int edgeIndex = 0; edgeIndex < 3; ++edgeIndex)
+	{
+		ScreenVertex const& start = *edgeStarts[edgeIndex];
+		ScreenVertex const& end = *edgeEnds[edgeIndex];
+		edgeStepX[edgeIndex] = start.m_y - end.m_y;
+		edgeStepY[edgeIndex] = end.m_x - start.m_x;
+		edgeOffset[edgeIndex] = -(edgeStepX[edgeIndex] * start.m_x + edgeStepY[edgeIndex] * start.m_y);
+	}
+
+	// Reciprocal depth as a plane over the screen, weighting each corner by the edge function of the edge opposite it
+	float inverseArea = 1.f / area;
+	float depthStepX = (edgeStepX[1] * a.m_inverseDepth + edgeStepX[2] * cornerB->m_inverseDepth + edgeStepX[0] * cornerC->m_inverseDepth) * inverseArea;
+	float depthStepY = (edgeStepY[1] * a.m_inverseDepth + edgeStepY[2] * cornerB->m_inverseDepth + edgeStepY[0] * cornerC->m_inverseDepth) * inverseArea;
+	float depthOffset = (edgeOffset[1] * a.m_inverseDepth + edgeOffset[2] * cornerB->m_inverseDepth + edgeOffset[0] * cornerC->m_inverseDepth) * inverseArea;
+
+	// Four pixel centers per step along each row
+	__m128 const laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	__m128 const zero = _mm_setzero_ps();
+	__m128 edge0StepX4 = _mm_set1_ps(4.f * edgeStepX[0]);
+	__m128 edge1StepX4 = _mm_set1_ps(4.f * edgeStepX[1]);
+	__m128 edge2StepX4 = _mm_set1_ps(4.f * edgeStepX[2]);
+	__m128 depthStepX4 = _mm_set1_ps(4.f * depthStepX);
+	__m128 startX = _mm_add_ps(_mm_set1_ps(static_cast<float>(firstX)), laneOffsets);
+
+	float* depthBuffer = m_depthLevels[0].data();
+	for (int y = firstY; y <= lastY; ++y)
+	{
+		float pixelY = static_cast<float>(y) + 0.5f;
+		__m128 edge0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeStepX[0]), startX), _mm_set1_ps(edgeStepY[0] * pixelY + edgeOffset[0]));
+		__m128 edge1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeStepX[1]), startX), _mm_set1_ps(edgeStepY[1] * pixelY + edgeOffset[1]));
+		__m128 edge2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeStepX[2]), startX), _mm_set1_ps(edgeStepY[2] * pixelY + edgeOffset[2]));
+		__m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthStepX), startX), _mm_set1_ps(depthStepY * pixelY + depthOffset));
+
+		float* depthRow = depthBuffer + y * OCCLUSION_BUFFER_WIDTH;
+		for (int x = firstX; x <= lastX; x += 4)
+		{
+			__m128 isInside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+			if (_mm_movemask_ps(isInside) != 0)
+			{
+				// Keep the nearer of the stored and new depth, only where the pixel center is inside the triangle
+				__m128 storedDepth = _mm_loadu_ps(depthRow + x);
+				__m128 nearerDepth = _mm_max_ps(storedDepth, depth);
+				_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(isInside, nearerDepth), _mm_andnot_ps(isInside, storedDepth)));
+			}
+			edge0 = _mm_add_ps(edge0, edge0StepX4);
+			edge1 = _mm_add_ps(edge1, edge1StepX4);
+			edge2 = _mm_add_ps(edge2, edge2StepX4);
+			depth = _mm_add_ps(depth, depthStepX4);
+		}
+	}
+	++m_numRasterizedTriangles;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+struct Mesh;
+// -----------------------------------------------------------------------------
+constexpr int OCCLUSION_BUFFER_WIDTH = 256;		// Same 2:1 aspect as the player camera; a multiple of four for the SIMD rows
+constexpr int OCCLUSION_BUFFER_HEIGHT = 128;
+constexpr int OCCLUSION_NUM_DEPTH_LEVELS = 8;	// Full resolution down to 2x1
+// -----------------------------------------------------------------------------
+// Low-resolution software depth buffer for occlusion culling. Occluder meshes
+// are clipped against the near plane and rasterized four pixels at a time with
+// SSE, storing reciprocal view depth so it interpolates linearly across the
+// screen and larger values are closer. Both windings are drawn, so occluders do
+// not depend on the mesh's winding order. After rasterization a hierarchical-Z
+// pyramid keeps the farthest depth of each 2x2 block per level, and a bounding
+// sphere is occluded when the farthest occluder depth over its screen rectangle
+// is still in front of the sphere's nearest point. The test rectangle is grown
+// by one pixel, since occluder pixels are covered by their centers only.
+// -----------------------------------------------------------------------------
+class OcclusionBuffer
+{
+public:
+	OcclusionBuffer();
+	~OcclusionBuffer();
+
+	void BeginFrame(Vec3 const& position, EulerAngles const& orientation, float aspect, float fovDegrees, float nearZ, float farZ);
+	void RasterizeMesh(Mesh const& mesh, Mat44 const& modelToWorldTransform);
+	void BuildHierarchicalDepth();
+
+	bool IsSphereOccluded(Vec3 const& center, float radius) const;
+	int  CullOccludedSpheres(int numSpheres, float const* centersX, float const* centersY, float const* centersZ, float const* radii, unsigned char* inout_isVisible) const;
+
+	int  GetNumRasterizedTriangles() const { return m_numRasterizedTriangles; }
+	float GetInverseDepth(int x, int y) const;
+	bool ExportDepthImage(std::string const& filePath) const;
+
+private:
+	struct ScreenVertex
+	{
+		float m_x = 0.f;			// Pixels from the left edge
+		float m_y = 0.f;			// Pixels from the top edge
+		float m_inverseDepth = 0.f;
+	};
+
+	ScreenVertex ProjectToScreen(Vec3 const& viewPosition) const;
+	void RasterizeClippedTriangle(Vec3 const& viewA, Vec3 const& viewB, Vec3 const& viewC);
+	void RasterizeTriangle(ScreenVertex const& a, ScreenVertex const& b, ScreenVertex const& c);
+
+private:
+	// View basis with x to the right, y up and z forward
+	Vec3 m_viewPosition;
+	Vec3 m_viewRight;
+	Vec3 m_viewUp;
+	Vec3 m_viewForward;
+	float m_nearZ = 0.1f;
+	float m_farZ = 100.f;
+	float m_screenScaleX = 1.f;		// Pixels per unit of x / z
+	float m_screenScaleY = 1.f;
+
+	// Level 0 is the rasterized buffer; level n is half the size of level n - 1 in each axis
+	std::vector<float> m_depthLevels[OCCLUSION_NUM_DEPTH_LEVELS];
+	int m_numRasterizedTriangles = 0;
+
+	// View-space mesh vertexes, kept to reuse capacity
+	std::vector<Vec3> m_viewVertexes;
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Game/Player.hpp"
+#include "Game/Game.h"
+#include "Game/Profiler.hpp"
 #include "Engine/Core/EngineCommon.h"
-#include "Engine/Input/InputSystem.h"
 #include "Engine/Math/MathUtils.h"
 #include <Engine/Core/DevConsole.hpp>
 #include <Engine/Core/DebugRender.hpp>
@@ -20,15 +21,30 @@ Player::~Player()
 
 void Player::Update(float deltaSeconds)
 {
+	PROFILE_SCOPE("Player::Update");
+
 	CameraKeyPresses(deltaSeconds);
 	CameraControllerPresses(deltaSeconds);
 
+	// Push the player back out of the ground and any props it moved into
+	CollisionCapsule capsule = GetCollisionCapsule();
+	if (m_game->ResolvePlayerCollision(capsule))
+	{
+		m_position = capsule.m_end;
+	}
+
+	// Debug draws need the debug render system, which headless runs do not start
+	if (!m_game->IsHeadless())
+	{
+		DebugKeyPresses();
+	}
+
 	m_orientation.m_pitchDegrees = GetClamped(m_orientation.m_pitchDegrees, -85.f, 85.f);
 	m_orientation.m_rollDegrees = GetClamped(m_orientation.m_rollDegrees, -45.f, 45.f);
 
 	m_playerCamera.SetPositionAndOrientation(m_position, m_orientation);
 
-	m_playerCamera.SetPerspectiveView(2.f, 60.f, 0.1f, 100.f);
+	m_playerCamera.SetPerspectiveView(PLAYER_CAMERA_ASPECT, PLAYER_CAMERA_FOV_DEGREES, PLAYER_CAMERA_NEAR, PLAYER_CAMERA_FAR);
 }
 
 void Player::Render() const
@@ -45,93 +61,130 @@ Camera Player::GetPlayerCamera() const
 	return m_playerCamera;
 }
 
+Frustum Player::GetViewFrustum() const
+{
+	// Built from the same values handed to m_playerCamera so it always matches what is drawn
+	return Frustum::MakePerspective(m_position, m_orientation, PLAYER_CAMERA_ASPECT, PLAYER_CAMERA_FOV_DEGREES, PLAYER_CAMERA_NEAR, PLAYER_CAMERA_FAR);
+}
+
+CollisionCapsule Player::GetCollisionCapsule() const
+{
+	CollisionCapsule capsule;
+	capsule.m_end = m_position;
+	capsule.m_start = m_position - Vec3::ZAXE * (PLAYER_CAPSULE_HEIGHT - 2.f * PLAYER_CAPSULE_RADIUS);
+	capsule.m_radius = PLAYER_CAPSULE_RADIUS;
+	return capsule;
+}
+
 void Player::CameraKeyPresses(float deltaSeconds)
 {
+	PlayerInputFrame const& input = m_game->GetPlayerInput();
+
 	// Yaw and Pitch with mouse
-	m_orientation.m_yawDegrees += 0.08f * g_theInput->GetCursorClientDelta().x;
-	m_orientation.m_pitchDegrees -= 0.08f * g_theInput->GetCursorClientDelta().y;
+	m_orientation.m_yawDegrees += 0.08f * input.m_cursorDelta.x;
+	m_orientation.m_pitchDegrees -= 0.08f * input.m_cursorDelta.y;
 
 	float movementSpeed = 2.f;
 	// Increase speed by a factor of 10
-	if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+	if (input.IsButtonDown(PLAYER_INPUT_SPRINT))
 	{
 		movementSpeed *= 10.f;
 	}
 
 	// Rolling
-	if (g_theInput->IsKeyDown('Q'))
+	if (input.IsButtonDown(PLAYER_INPUT_ROLL_LEFT))
 	{
 		m_orientation.m_rollDegrees += -90.f * deltaSeconds;
 	}
-	if (g_theInput->IsKeyDown('E'))
+	if (input.IsButtonDown(PLAYER_INPUT_ROLL_RIGHT))
 	{
 		m_orientation.m_rollDegrees += 90.f * deltaSeconds;
 	}
 
+	// Orientation is final for this frame, so the basis is built once for all the movement keys
+	Mat44 orientationMatrix = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
+	Vec3 forward = orientationMatrix.GetIBasis3D();
+	Vec3 left = orientationMatrix.GetJBasis3D();
+
 	// Move left or right
-	if (g_theInput->IsKeyDown('A'))
+	if (input.IsButtonDown(PLAYER_INPUT_LEFT))
 	{
-		m_position += movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetJBasis3D() * deltaSeconds;
+		m_position += movementSpeed * left * deltaSeconds;
 	}
-	if (g_theInput->IsKeyDown('D'))
+	if (input.IsButtonDown(PLAYER_INPUT_RIGHT))
 	{
-		m_position += -movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetJBasis3D() * deltaSeconds;
+		m_position += -movementSpeed * left * deltaSeconds;
 	}
 
 	// Move Forward and Backward
-	if (g_theInput->IsKeyDown('W'))
+	if (input.IsButtonDown(PLAYER_INPUT_FORWARD))
 	{
-		m_position += movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D() * deltaSeconds;
+		m_position += movementSpeed * forward * deltaSeconds;
 	}
-	if (g_theInput->IsKeyDown('S'))
+	if (input.IsButtonDown(PLAYER_INPUT_BACK))
 	{
-		m_position += -movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D() * deltaSeconds;
+		m_position += -movementSpeed * forward * deltaSeconds;
 	}
 
 	// Move Up and Down
-	if (g_theInput->IsKeyDown('Z'))
+	if (input.IsButtonDown(PLAYER_INPUT_DOWN))
 	{
 		m_position += -movementSpeed * Vec3::ZAXE * deltaSeconds;
 	}
-	if (g_theInput->IsKeyDown('C'))
+	if (input.IsButtonDown(PLAYER_INPUT_UP))
 	{
 		m_position += movementSpeed * Vec3::ZAXE * deltaSeconds;
 	}
 
 	// Reset position and orientation to zero
-	if (g_theInput->WasKeyJustPressed('H'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_RESET))
 	{
 		m_position = Vec3::ZERO;
 		m_orientation = EulerAngles(0.f, 0.f, 0.f);
 	}
+}
+
+void Player::DebugKeyPresses()
+{
+	PlayerInputFrame const& input = m_game->GetPlayerInput();
 
 	// Spawn Line/Cylinder
-	if (g_theInput->WasKeyJustPressed('1'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_DEBUG_1))
 	{
 		float lineRadius = 0.0625f;
 		Vec3 lineLength = m_position + GetForwardNormal() * 10.f;
+
+		// Stop the line at the first prop it hits
+		Vec3 rayDisplacement = lineLength - m_position;
+		float rayLength = rayDisplacement.GetLength();
+		EntityRaycastResult rayResult = m_game->RaycastVsEntities(m_position, rayDisplacement / rayLength, rayLength);
+		if (rayResult.m_didImpact)
+		{
+			lineLength = rayResult.m_impactPos;
+			m_game->GetDebugPrimitives().AddWorldSphere(rayResult.m_impactPos, lineRadius * 2.f, 10.f, Rgba8::RED, Rgba8::RED, DebugRenderMode::X_RAY);
+		}
 		DebugAddWorldCylinder(m_position, lineLength, lineRadius, 10.f, Rgba8::YELLOW, Rgba8::YELLOW, DebugRenderMode::X_RAY);
 	}
-	// Spawn point/sphere
-	if (g_theInput->IsKeyDown('2'))
+	// Spawn point/sphere every frame while held; the pool batches them and caps how many stay alive
+	if (input.IsButtonDown(PLAYER_INPUT_DEBUG_2))
 	{
 		float pointRadius = 0.2f;
 		Vec3 spawnPosition = Vec3(m_position.x, m_position.y, 0.f);
-		DebugAddWorldSphere(spawnPosition, pointRadius, 60.f, Rgba8(150, 75, 0), Rgba8(150, 75, 0));
+		m_game->GetDebugPrimitives().AddWorldSphere(spawnPosition, pointRadius, 60.f, Rgba8(150, 75, 0), Rgba8(150, 75, 0));
 	}
 	// Spawn wire sphere
-	if (g_theInput->WasKeyJustPressed('3'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_DEBUG_3))
 	{
 		Vec3 spawnPosition = m_position + GetForwardNormal();
-		DebugAddWorldWireSphere(spawnPosition, 1.f, 5.f, Rgba8::GREEN, Rgba8::RED);
+		m_game->GetDebugPrimitives().AddWorldSphere(spawnPosition, 1.f, 5.f, Rgba8::GREEN, Rgba8::RED, DebugRenderMode::USE_DEPTH, true);
 	}
 	// Spawn a world basis
-	if (g_theInput->WasKeyJustPressed('4'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_DEBUG_4))
 	{
 		DebugAddWorldBasis(GetModelToWorldTransform(), 20.f);
 	}
 	// Spawn full opposing billboard text
-	if (g_theInput->WasKeyJustPressed('5'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_DEBUG_5))
 	{
 		std::string posAndOrientationText = Stringf("Position: %0.1f %0.1f %0.1f, Orientation: %0.1f, %0.1f, %0.1f,",
 			m_position.x, m_position.y, m_position.z, m_orientation.m_yawDegrees, m_orientation.m_pitchDegrees, m_orientation.m_rollDegrees);
@@ -141,12 +194,12 @@ void Player::CameraKeyPresses(float deltaSeconds)
 		DebugAddWorldBillboardText(posAndOrientationText, spawnPosition, textSize, Vec2::ONEHALF, 10.f, Rgba8::WHITE, Rgba8::RED);
 	}
 	// Spawn wire cylinder
-	if (g_theInput->WasKeyJustPressed('6'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_DEBUG_6))
 	{
 		DebugAddWorldWireCylinder(m_position, m_position + Vec3::ZAXE, 0.5f, 10.f, Rgba8::WHITE, Rgba8::RED);
 	}
 	// Spawn message
-	if (g_theInput->WasKeyJustPressed('7'))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_DEBUG_7))
 	{
 		std::string orientationText = Stringf("Orientation: %0.1f, %0.1f, %0.1f,", m_orientation.m_yawDegrees, m_orientation.m_pitchDegrees, m_orientation.m_rollDegrees);
 		DebugAddMessage(orientationText, 5.f);
@@ -155,44 +208,45 @@ void Player::CameraKeyPresses(float deltaSeconds)
 
 void Player::CameraControllerPresses(float deltaSeconds)
 {
-	XboxController const& controller = g_theInput->GetController(0);
+	PlayerInputFrame const& input = m_game->GetPlayerInput();
 	float movementSpeed = 2.f;
 
 	// Increase speed by a factor of 10
-	if (controller.IsButtonDown(XBOX_BUTTON_A))
+	if (input.IsButtonDown(PLAYER_INPUT_PAD_SPRINT))
 	{
 		movementSpeed *= 10.f;
 	}
 
 	// Rolling
-	if (controller.GetLeftTrigger())
+	if (input.m_leftTrigger != 0.f)
 	{
 		m_orientation.m_rollDegrees = -90.f * deltaSeconds;
 	}
-	if (controller.GetRightTrigger())
+	if (input.m_rightTrigger != 0.f)
 	{
 		m_orientation.m_rollDegrees = 90.f * deltaSeconds;
 	}
 
 	//// Move left, right, forward, and backward
-	if (controller.GetLeftStick().GetMagnitude() > 0.f)
+	if (input.m_leftStick != Vec2::ZERO)
 	{
-		m_position += (-movementSpeed * controller.GetLeftStick().GetPosition().x * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetJBasis3D() * deltaSeconds);
-		m_position += (movementSpeed * controller.GetLeftStick().GetPosition().y * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D() * deltaSeconds);
+		Mat44 orientationMatrix = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
+		m_position += (-movementSpeed * input.m_leftStick.x * orientationMatrix.GetJBasis3D() * deltaSeconds);
+		m_position += (movementSpeed * input.m_leftStick.y * orientationMatrix.GetIBasis3D() * deltaSeconds);
 	}
 
 	//// Move Up and Down
-	if (controller.IsButtonDown(XBOX_BUTTON_LSHOULDER))
+	if (input.IsButtonDown(PLAYER_INPUT_PAD_DOWN))
 	{
 		m_position += -movementSpeed * Vec3::ZAXE * deltaSeconds;
 	}
-	if (controller.IsButtonDown(XBOX_BUTTON_RSHOULDER))
+	if (input.IsButtonDown(PLAYER_INPUT_PAD_UP))
 	{
 		m_position += movementSpeed * Vec3::ZAXE * deltaSeconds;
 	}
 
 	//// Reset position and orientation to zero
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_START))
+	if (input.WasButtonJustPressed(PLAYER_INPUT_PAD_RESET))
 	{
 		m_position = Vec3::ZERO;
 		m_orientation = EulerAngles(0.f, 0.f, 0.f);
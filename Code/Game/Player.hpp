@@ -1,7 +1,16 @@
 #pragma once
 #include "Game/Entity.hpp"
+#include "Game/Frustum.hpp"
+#include "Game/CollisionSystem.hpp"
 #include "Engine/Renderer/Camera.h"
 // -----------------------------------------------------------------------------
+constexpr float PLAYER_CAMERA_ASPECT = 2.f;
+constexpr float PLAYER_CAMERA_FOV_DEGREES = 60.f;
+constexpr float PLAYER_CAMERA_NEAR = 0.1f;
+constexpr float PLAYER_CAMERA_FAR = 100.f;
+constexpr float PLAYER_CAPSULE_RADIUS = 0.2f;
+constexpr float PLAYER_CAPSULE_HEIGHT = 0.5f;	// Bottom to top, with the eye at the center of the top cap
+// -----------------------------------------------------------------------------
 class Player : public Entity
 {
 public:
@@ -13,9 +22,12 @@ public:
 	Vec3 GetForwardNormal() const;
 
 	Camera GetPlayerCamera() const;
+	Frustum GetViewFrustum() const;
+	CollisionCapsule GetCollisionCapsule() const;
 
 private:
 	void CameraKeyPresses(float deltaSeconds);
 	void CameraControllerPresses(float deltaSeconds);
+	void DebugKeyPresses();
 	Camera m_playerCamera;
 };
\ No newline at end of file
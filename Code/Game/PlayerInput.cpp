@@ -0,0 +1,291 @@
+#include "Game/PlayerInput.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/InputSystem.h"
+#include <fstream>
+#include <iterator>
+#include <string.h>
+
+struct PlayerInputFileHeader
+{
+	uint32_t m_magic = PLAYER_INPUT_FILE_MAGIC;
+	uint32_t m_version = PLAYER_INPUT_FILE_VERSION;
+	uint32_t m_numFrames = 0;
+};
+
+// Which optional fields follow the delta time of a frame record
+enum PlayerInputFrameField : unsigned char
+{
+	FRAME_FIELD_CURSOR_DELTA	= 1 << 0,
+	FRAME_FIELD_LEFT_STICK		= 1 << 1,
+	FRAME_FIELD_TRIGGERS		= 1 << 2,
+	FRAME_FIELD_BUTTONS_DOWN	= 1 << 3,
+	FRAME_FIELD_BUTTONS_PRESSED	= 1 << 4,
+};
+
+struct KeyButtonBinding
+{
+	unsigned char m_keyCode;
+	PlayerInputButton m_button;
+};
+
+static KeyButtonBinding const KEY_BUTTON_BINDINGS[] =
+{
+	{ 'W', PLAYER_INPUT_FORWARD },
+	{ 'S', PLAYER_INPUT_BACK },
+	{ 'A', PLAYER_INPUT_LEFT },
+	{ 'D', PLAYER_INPUT_RIGHT },
+	{ 'Z', PLAYER_INPUT_DOWN },
+	{ 'C', PLAYER_INPUT_UP },
+	{ 'Q', PLAYER_INPUT_ROLL_LEFT },
+	{ 'E', PLAYER_INPUT_ROLL_RIGHT },
+	{ KEYCODE_SHIFT, PLAYER_INPUT_SPRINT },
+	{ 'H', PLAYER_INPUT_RESET },
+	{ '1', PLAYER_INPUT_DEBUG_1 },
+	{ '2', PLAYER_INPUT_DEBUG_2 },
+	{ '3', PLAYER_INPUT_DEBUG_3 },
+	{ '4', PLAYER_INPUT_DEBUG_4 },
+	{ '5', PLAYER_INPUT_DEBUG_5 },
+	{ '6', PLAYER_INPUT_DEBUG_6 },
+	{ '7', PLAYER_INPUT_DEBUG_7 },
+	{ ' ', PLAYER_INPUT_START },
+	{ KEYCODE_ESC, PLAYER_INPUT_ATTRACT },
+};
+
+struct ControllerButtonBinding
+{
+	XboxButtonID m_controllerButton;
+	PlayerInputButton m_button;
+};
+
+static ControllerButtonBinding const CONTROLLER_BUTTON_BINDINGS[] =
+{
+	{ XBOX_BUTTON_A, PLAYER_INPUT_PAD_SPRINT },
+	{ XBOX_BUTTON_LSHOULDER, PLAYER_INPUT_PAD_DOWN },
+	{ XBOX_BUTTON_RSHOULDER, PLAYER_INPUT_PAD_UP },
+	{ XBOX_BUTTON_START, PLAYER_INPUT_PAD_RESET },
+};
+
+static void AppendBytes(std::vector<unsigned char>& fileBytes, void const* data, size_t numBytes)
+{
+	unsigned char const* bytes = static_cast<unsigned char const*>(data);
+	fileBytes.insert(fileBytes.end(), bytes, bytes + numBytes);
+}
+
+static bool ReadBytes(std::vector<unsigned char> const& fileBytes, size_t& readOffset, void* out_data, size_t numBytes)
+{
+	if (readOffset + numBytes > fileBytes.size())
+	{
+		return false;
+	}
+	memcpy(out_data, fileBytes.data() + readOffset, numBytes);
+	readOffset += numBytes;
+	return true;
+}
+
+PlayerInputFrame PlayerInputFrame::CaptureLive(InputSystem& input, float deltaSeconds)
+{
+	PlayerInputFrame frame;
+	frame.m_deltaSeconds = deltaSeconds;
+	frame.m_cursorDelta = input.GetCursorClientDelta();
+
+	for (KeyButtonBinding const& binding : KEY_BUTTON_BINDINGS)
+	{
+		if (input.IsKeyDown(binding.m_keyCode))
+		{
+			frame.m_buttonsDown |= binding.m_button;
+		}
+		if (input.WasKeyJustPressed(binding.m_keyCode))
+		{
+			frame.m_buttonsPressed |= binding.m_button;
+		}
+	}
+
+	XboxController const& controller = input.GetController(0);
+	frame.m_leftTrigger = controller.GetLeftTrigger();
+	frame.m_rightTrigger = controller.GetRightTrigger();
+	if (controller.GetLeftStick().GetMagnitude() > 0.f)
+	{
+		frame.m_leftStick = controller.GetLeftStick().GetPosition();
+	}
+	for (ControllerButtonBinding const& binding : CONTROLLER_BUTTON_BINDINGS)
+	{
+		if (controller.IsButtonDown(binding.m_controllerButton))
+		{
+			frame.m_buttonsDown |= binding.m_button;
+		}
+		if (controller.WasButtonJustPressed(binding.m_controllerButton))
+		{
+			frame.m_buttonsPressed |= binding.m_button;
+		}
+	}
+	return frame;
+}
+
+void PlayerInputRecording::AppendFrame(PlayerInputFrame const& frame)
+{
+	m_frames.push_back(frame);
+}
+
+void PlayerInputRecording::Clear()
+{
+	m_frames.clear();
+}
+
+int PlayerInputRecording::GetNumFrames() const
+{
+	return static_cast<int>(m_frames.size());
+}
+
+PlayerInputFrame const& PlayerInputRecording::GetFrame(int frameIndex) const
+{
+	return m_frames[frameIndex];
+}
+
+bool PlayerInputRecording::SaveToFile(std::string const& filePath, std::string& out_error) const
+{
+	PlayerInputFileHeader header;
+	header.m_numFrames = static_cast<uint32_t>(m_frames.size());
+
+	std::vector<unsigned char> fileBytes;
+	fileBytes.reserve(sizeof(header) + m_frames.size() * (1 + sizeof(float)));
+	AppendBytes(fileBytes, &header, sizeof(header));
+
+	uint32_t previousButtonsDown = 0;
+	for (PlayerInputFrame const& frame : m_frames)
+	{
+		unsigned char fields = 0;
+		if (frame.m_cursorDelta != Vec2::ZERO)
+		{
+			fields |= FRAME_FIELD_CURSOR_DELTA;
+		}
+		if (frame.m_leftStick != Vec2::ZERO)
+		{
+			fields |= FRAME_FIELD_LEFT_STICK;
+		}
+		if (frame.m_leftTrigger != 0.f || frame.m_rightTrigger != 0.f)
+		{
+			fields |= FRAME_FIELD_TRIGGERS;
+		}
+		if (frame.m_buttonsDown != previousButtonsDown)
+		{
+			fields |= FRAME_FIELD_BUTTONS_DOWN;
+		}
+		if (frame.m_buttonsPressed != 0)
+		{
+			fields |= FRAME_FIELD_BUTTONS_PRESSED;
+		}
+		previousButtonsDown = frame.m_buttonsDown;
+
+		AppendBytes(fileBytes, &fields, sizeof(fields));
+		AppendBytes(fileBytes, &frame.m_deltaSeconds, sizeof(frame.m_deltaSeconds));
+		if (fields & FRAME_FIELD_CURSOR_DELTA)
+		{
+			AppendBytes(fileBytes, &frame.m_cursorDelta.x, sizeof(float));
+			AppendBytes(fileBytes, &frame.m_cursorDelta.y, sizeof(float));
+		}
+		if (fields & FRAME_FIELD_LEFT_STICK)
+		{
+			AppendBytes(fileBytes, &frame.m_leftStick.x, sizeof(float));
+			AppendBytes(fileBytes, &frame.m_leftStick.y, sizeof(float));
+		}
+		if (fields & FRAME_FIELD_TRIGGERS)
+		{
+			AppendBytes(fileBytes, &frame.m_leftTrigger, sizeof(float));
+			AppendBytes(fileBytes, &frame.m_rightTrigger, sizeof(float));
+		}
+		if (fields & FRAME_FIELD_BUTTONS_DOWN)
+		{
+			AppendBytes(fileBytes, &frame.m_buttonsDown, sizeof(uint32_t));
+		}
+		if (fields & FRAME_FIELD_BUTTONS_PRESSED)
+		{
+			AppendBytes(fileBytes, &frame.m_buttonsPressed, sizeof(uint32_t));
+		}
+	}
+
+	std::ofstream inputFile(filePath, std::ios::binary);
+	if (!inputFile.is_open())
+	{
+		out_error = Stringf("could not write \"%s\"", filePath.c_str());
+		return false;
+	}
+	inputFile.write(reinterpret_cast<char const*>(fileBytes.data()), static_cast<std::streamsize>(fileBytes.size()));
+	return inputFile.good();
+}
+
+bool PlayerInputRecording::LoadFromFile(std::string const& filePath, std::string& out_error)
+{
+	m_frames.clear();
+
+	std::ifstream inputFile(filePath, std::ios::binary);
+	if (!inputFile.is_open())
+	{
+		out_error = Stringf("could not open \"%s\"", filePath.c_str());
+		return false;
+	}
+	std::vector<unsigned char> fileBytes((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+
+	size_t readOffset = 0;
+	PlayerInputFileHeader header;
+	if (!ReadBytes(fileBytes, readOffset, &header, sizeof(header)) || header.m_magic != PLAYER_INPUT_FILE_MAGIC)
+	{
+		out_error = Stringf("\"%s\" is not an input recording", filePath.c_str());
+		return false;
+	}
+	if (header.m_version != PLAYER_INPUT_FILE_VERSION)
+	{
+		out_error = Stringf("input recording version %u, expected %u", header.m_version, PLAYER_INPUT_FILE_VERSION);
+		return false;
+	}
+
+	// Every frame takes at least its flags and delta time, which bounds the count before reserving
+	size_t const minFrameBytes = 1 + sizeof(float);
+	if (static_cast<size_t>(header.m_numFrames) > (fileBytes.size() - readOffset) / minFrameBytes)
+	{
+		out_error = Stringf("input recording claims %u frames but is only %zu bytes", header.m_numFrames, fileBytes.size());
+		return false;
+	}
+	m_frames.reserve(header.m_numFrames);
+
+	uint32_t buttonsDown = 0;
+	for (uint32_t frameIndex = 0; frameIndex < header.m_numFrames; ++frameIndex)
+	{
+		PlayerInputFrame frame;
+		unsigned char fields = 0;
+		bool isValid = ReadBytes(fileBytes, readOffset, &fields, sizeof(fields))
+			&& ReadBytes(fileBytes, readOffset, &frame.m_deltaSeconds, sizeof(float));
+		if (isValid && (fields & FRAME_FIELD_CURSOR_DELTA))
+		{
+			isValid = ReadBytes(fileBytes, readOffset, &frame.m_cursorDelta.x, sizeof(float))
+				&& ReadBytes(fileBytes, readOffset, &frame.m_cursorDelta.y, sizeof(float));
+		}
+		if (isValid && (fields & FRAME_FIELD_LEFT_STICK))
+		{
+			isValid = ReadBytes(fileBytes, readOffset, &frame.m_leftStick.x, sizeof(float))
+				&& ReadBytes(fileBytes, readOffset, &frame.m_leftStick.y, sizeof(float));
+		}
+		if (isValid && (fields & FRAME_FIELD_TRIGGERS))
+		{
+			isValid = ReadBytes(fileBytes, readOffset, &frame.m_leftTrigger, sizeof(float))
+				&& ReadBytes(fileBytes, readOffset, &frame.m_rightTrigger, sizeof(float));
+		}
+		if (isValid && (fields & FRAME_FIELD_BUTTONS_DOWN))
+		{
+			isValid = ReadBytes(fileBytes, readOffset, &buttonsDown, sizeof(uint32_t));
+		}
+		if (isValid && (fields & FRAME_FIELD_BUTTONS_PRESSED))
+		{
+			isValid = ReadBytes(fileBytes, readOffset, &frame.m_buttonsPressed, sizeof(uint32_t));
+		}
+		if (!isValid)
+		{
+			out_error = Stringf("input recording is truncated at frame %u", frameIndex);
+			m_frames.clear();
+			return false;
+		}
+		frame.m_buttonsDown = buttonsDown;
+		m_frames.push_back(frame);
+	}
+	return true;
+}
\ No newline at end of file
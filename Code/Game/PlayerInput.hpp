@@ -0,0 +1,79 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+class InputSystem;
+// -----------------------------------------------------------------------------
+constexpr uint32_t PLAYER_INPUT_FILE_MAGIC = 0x52494750;	// "PGIR"
+constexpr uint32_t PLAYER_INPUT_FILE_VERSION = 1;
+// -----------------------------------------------------------------------------
+// One bit per key or button the game reacts to. Keys that only drive the app
+// itself (quit, pause, the dev console) stay on live input and are not here.
+// -----------------------------------------------------------------------------
+enum PlayerInputButton : uint32_t
+{
+	PLAYER_INPUT_FORWARD			= 1u << 0,	// W
+	PLAYER_INPUT_BACK				= 1u << 1,	// S
+	PLAYER_INPUT_LEFT				= 1u << 2,	// A
+	PLAYER_INPUT_RIGHT				= 1u << 3,	// D
+	PLAYER_INPUT_DOWN				= 1u << 4,	// Z
+	PLAYER_INPUT_UP					= 1u << 5,	// C
+	PLAYER_INPUT_ROLL_LEFT			= 1u << 6,	// Q
+	PLAYER_INPUT_ROLL_RIGHT			= 1u << 7,	// E
+	PLAYER_INPUT_SPRINT				= 1u << 8,	// Shift
+	PLAYER_INPUT_RESET				= 1u << 9,	// H
+	PLAYER_INPUT_DEBUG_1			= 1u << 10,	// 1 through 7, consecutive so they can be indexed
+	PLAYER_INPUT_DEBUG_2			= 1u << 11,
+	PLAYER_INPUT_DEBUG_3			= 1u << 12,
+	PLAYER_INPUT_DEBUG_4			= 1u << 13,
+	PLAYER_INPUT_DEBUG_5			= 1u << 14,
+	PLAYER_INPUT_DEBUG_6			= 1u << 15,
+	PLAYER_INPUT_DEBUG_7			= 1u << 16,
+	PLAYER_INPUT_START				= 1u << 17,	// Space
+	PLAYER_INPUT_ATTRACT			= 1u << 18,	// Escape
+	PLAYER_INPUT_PAD_SPRINT			= 1u << 19,	// Controller A
+	PLAYER_INPUT_PAD_DOWN			= 1u << 20,	// Controller left shoulder
+	PLAYER_INPUT_PAD_UP				= 1u << 21,	// Controller right shoulder
+	PLAYER_INPUT_PAD_RESET			= 1u << 22,	// Controller start
+};
+// -----------------------------------------------------------------------------
+// Everything the player and game read from input in one frame, along with the
+// game clock delta the frame ran with. Live frames are captured from the
+// InputSystem; replayed frames come from a PlayerInputRecording.
+// -----------------------------------------------------------------------------
+struct PlayerInputFrame
+{
+	float m_deltaSeconds = 0.f;
+	Vec2 m_cursorDelta;
+	Vec2 m_leftStick;
+	float m_leftTrigger = 0.f;
+	float m_rightTrigger = 0.f;
+	uint32_t m_buttonsDown = 0;
+	uint32_t m_buttonsPressed = 0;	// Went down this frame
+
+	bool IsButtonDown(PlayerInputButton button) const { return (m_buttonsDown & button) != 0; }
+	bool WasButtonJustPressed(PlayerInputButton button) const { return (m_buttonsPressed & button) != 0; }
+
+	static PlayerInputFrame CaptureLive(InputSystem& input, float deltaSeconds);
+};
+// -----------------------------------------------------------------------------
+// A sequence of input frames and its file form. Each frame is written as a byte
+// of flags for the fields that follow, then the delta time, then only the
+// fields that are nonzero; held buttons are only written when they change.
+// -----------------------------------------------------------------------------
+class PlayerInputRecording
+{
+public:
+	void AppendFrame(PlayerInputFrame const& frame);
+	void Clear();
+	int GetNumFrames() const;
+	PlayerInputFrame const& GetFrame(int frameIndex) const;
+
+	bool SaveToFile(std::string const& filePath, std::string& out_error) const;
+	bool LoadFromFile(std::string const& filePath, std::string& out_error);
+
+private:
+	std::vector<PlayerInputFrame> m_frames;
+};
\ No newline at end of file
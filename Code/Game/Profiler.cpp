@@ -0,0 +1,300 @@
+#include "Game/Profiler.hpp"
+#include "Game/GameCommon.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <fstream>
+
+// The buffer this thread records into, and the profiler it belongs to in case the profiler is recreated
+static thread_local void* s_threadBuffer = nullptr;
+static thread_local Profiler const* s_threadBufferOwner = nullptr;
+
+Profiler::Profiler(ProfilerConfig const& config)
+	: m_config(config)
+{
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::Startup()
+{
+	m_startSeconds = GetCurrentTimeSeconds();
+	m_frameStartSeconds = m_startSeconds;
+	m_lastFrameStartSeconds = m_startSeconds;
+
+	// Register the main thread first so it is always thread 0 in reports and traces
+	GetOrCreateThreadBuffer();
+
+	SubscribeEventCallbackFunction("ProfileReport", Command_ProfileReport);
+	SubscribeEventCallbackFunction("ProfileOverlay", Command_ProfileOverlay);
+	SubscribeEventCallbackFunction("ProfileExport", Command_ProfileExport);
+}
+
+void Profiler::Shutdown()
+{
+	std::lock_guard<std::mutex> buffersLock(m_threadBuffersMutex);
+	for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size(); ++bufferIndex)
+	{
+		delete m_threadBuffers[bufferIndex];
+	}
+	m_threadBuffers.clear();
+}
+
+void Profiler::BeginFrame()
+{
+	m_lastFrameStartSeconds = m_frameStartSeconds;
+	m_frameStartSeconds = GetCurrentTimeSeconds();
+}
+
+int Profiler::BeginZone()
+{
+	ThreadBuffer* buffer = GetOrCreateThreadBuffer();
+	return buffer->m_depth++;
+}
+
+void Profiler::EndZone(char const* zoneName, double beginSeconds, int depth)
+{
+	double endSeconds = GetCurrentTimeSeconds();
+	ThreadBuffer* buffer = GetOrCreateThreadBuffer();
+	buffer->m_depth = depth;
+
+	// Only this thread writes the buffer, the release store publishes the event to readers
+	unsigned int eventIndex = buffer->m_numEventsWritten.load(std::memory_order_relaxed);
+	ProfileEvent& event = buffer->m_events[eventIndex % PROFILER_EVENTS_PER_THREAD];
+	event.m_name = zoneName;
+	event.m_beginSeconds = beginSeconds;
+	event.m_endSeconds = endSeconds;
+	event.m_depth = depth;
+	buffer->m_numEventsWritten.store(eventIndex + 1, std::memory_order_release);
+}
+
+void Profiler::GetLastFrameRows(FrameVector<ProfileReportRow>& out_rows) const
+{
+	struct ReportRow
+	{
+		char const* m_name = nullptr;
+		int m_parentRowIndex = -1;
+		int m_depth = 0;
+		int m_numCalls = 0;
+		double m_totalSeconds = 0.0;
+	};
+
+	std::lock_guard<std::mutex> buffersLock(m_threadBuffersMutex);
+	FrameVector<ProfileEvent> events;
+	FrameVector<ReportRow> rows;
+	FrameVector<int> rowStack;
+	for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size(); ++bufferIndex)
+	{
+		events.clear();
+		CopyEventsInRange(*m_threadBuffers[bufferIndex], m_lastFrameStartSeconds, m_frameStartSeconds, events);
+		if (events.empty())
+		{
+			continue;
+		}
+
+		// Parents start before their children, so walking in start order always finds the parent row first
+		std::sort(events.begin(), events.end(), [](ProfileEvent const& a, ProfileEvent const& b)
+			{
+				return a.m_beginSeconds < b.m_beginSeconds || (a.m_beginSeconds == b.m_beginSeconds && a.m_depth < b.m_depth);
+			});
+
+		// Zones with the same name under the same parent are merged into one row
+		rows.clear();
+		rowStack.clear();
+		for (size_t eventIndex = 0; eventIndex < events.size(); ++eventIndex)
+		{
+			ProfileEvent const& event = events[eventIndex];
+			int depth = std::min(event.m_depth, static_cast<int>(rowStack.size()));
+			int parentRowIndex = depth > 0 ? rowStack[depth - 1] : -1;
+
+			int rowIndex = -1;
+			for (int existingRowIndex = 0; existingRowIndex < static_cast<int>(rows.size()); ++existingRowIndex)
+			{
+				if (rows[existingRowIndex].m_parentRowIndex == parentRowIndex && rows[existingRowIndex].m_name == event.m_name)
+				{
+					rowIndex = existingRowIndex;
+					break;
+				}
+			}
+			if (rowIndex == -1)
+			{
+				ReportRow row;
+				row.m_name = event.m_name;
+				row.m_parentRowIndex = parentRowIndex;
+				row.m_depth = depth;
+				rows.push_back(row);
+				rowIndex = static_cast<int>(rows.size()) - 1;
+			}
+			rows[rowIndex].m_numCalls += 1;
+			rows[rowIndex].m_totalSeconds += event.m_endSeconds - event.m_beginSeconds;
+
+			rowStack.resize(static_cast<size_t>(depth));
+			rowStack.push_back(rowIndex);
+		}
+
+		// Depth first, so every row is reported directly under its parent
+		int threadID = m_threadBuffers[bufferIndex]->m_threadID;
+		ProfileReportRow threadRow;
+		threadRow.m_threadID = threadID;
+		out_rows.push_back(threadRow);
+		rowStack.clear();
+		for (int rowIndex = static_cast<int>(rows.size()) - 1; rowIndex >= 0; --rowIndex)
+		{
+			if (rows[rowIndex].m_parentRowIndex == -1)
+			{
+				rowStack.push_back(rowIndex);
+			}
+		}
+		while (!rowStack.empty())
+		{
+			ReportRow const& row = rows[rowStack.back()];
+			int rowIndex = rowStack.back();
+			rowStack.pop_back();
+			ProfileReportRow zoneRow;
+			zoneRow.m_name = row.m_name;
+			zoneRow.m_threadID = threadID;
+			zoneRow.m_depth = row.m_depth;
+			zoneRow.m_numCalls = row.m_numCalls;
+			zoneRow.m_totalSeconds = row.m_totalSeconds;
+			out_rows.push_back(zoneRow);
+			for (int childRowIndex = static_cast<int>(rows.size()) - 1; childRowIndex > rowIndex; --childRowIndex)
+			{
+				if (rows[childRowIndex].m_parentRowIndex == rowIndex)
+				{
+					rowStack.push_back(childRowIndex);
+				}
+			}
+		}
+	}
+}
+
+void Profiler::GetLastFrameReport(std::vector<std::string>& out_lines) const
+{
+	out_lines.push_back(Stringf("Last frame: %.3fms", GetLastFrameSeconds() * 1000.0));
+
+	FrameVector<ProfileReportRow> rows;
+	GetLastFrameRows(rows);
+	for (size_t rowIndex = 0; rowIndex < rows.size(); ++rowIndex)
+	{
+		ProfileReportRow const& row = rows[rowIndex];
+		if (row.m_name == nullptr)
+		{
+			out_lines.push_back(Stringf("Thread %d", row.m_threadID));
+		}
+		else
+		{
+			out_lines.push_back(Stringf("%*s%-28s %8.3fms %4dx", 2 + row.m_depth * 2, "", row.m_name, row.m_totalSeconds * 1000.0, row.m_numCalls));
+		}
+	}
+}
+
+bool Profiler::ExportChromeTrace(std::string const& filePath) const
+{
+	std::ofstream traceFile(filePath);
+	if (!traceFile.is_open())
+	{
+		return false;
+	}
+
+	// Complete ("X") events in microseconds, one tid per recording thread
+	traceFile << "{\"traceEvents\":[\n";
+	bool isFirstEvent = true;
+	std::lock_guard<std::mutex> buffersLock(m_threadBuffersMutex);
+	FrameVector<ProfileEvent> events;
+	for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size(); ++bufferIndex)
+	{
+		events.clear();
+		CopyEventsInRange(*m_threadBuffers[bufferIndex], m_startSeconds, GetCurrentTimeSeconds(), events);
+		for (size_t eventIndex = 0; eventIndex < events.size(); ++eventIndex)
+		{
+			ProfileEvent const& event = events[eventIndex];
+			double beginMicroseconds = (event.m_beginSeconds - m_startSeconds) * 1000000.0;
+			double durationMicroseconds = (event.m_endSeconds - event.m_beginSeconds) * 1000000.0;
+			traceFile << (isFirstEvent ? "" : ",\n") << Stringf("{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}",
+				event.m_name, beginMicroseconds, durationMicroseconds, m_threadBuffers[bufferIndex]->m_threadID);
+			isFirstEvent = false;
+		}
+	}
+	traceFile << "\n]}\n";
+	return true;
+}
+
+Profiler::ThreadBuffer* Profiler::GetOrCreateThreadBuffer()
+{
+	if (s_threadBufferOwner == this)
+	{
+		return static_cast<ThreadBuffer*>(s_threadBuffer);
+	}
+
+	ThreadBuffer* buffer = new ThreadBuffer();
+	{
+		std::lock_guard<std::mutex> buffersLock(m_threadBuffersMutex);
+		buffer->m_threadID = static_cast<int>(m_threadBuffers.size());
+		m_threadBuffers.push_back(buffer);
+	}
+	s_threadBuffer = buffer;
+	s_threadBufferOwner = this;
+	return buffer;
+}
+
+void Profiler::CopyEventsInRange(ThreadBuffer const& buffer, double startSeconds, double endSeconds, FrameVector<ProfileEvent>& out_events) const
+{
+	unsigned int numEventsWritten = buffer.m_numEventsWritten.load(std::memory_order_acquire);
+	unsigned int firstEventIndex = numEventsWritten > PROFILER_EVENTS_PER_THREAD ? numEventsWritten - PROFILER_EVENTS_PER_THREAD : 0;
+	for (unsigned int eventIndex = firstEventIndex; eventIndex < numEventsWritten; ++eventIndex)
+	{
+		ProfileEvent const& event = buffer.m_events[eventIndex % PROFILER_EVENTS_PER_THREAD];
+		if (event.m_beginSeconds >= startSeconds && event.m_endSeconds <= endSeconds)
+		{
+			out_events.push_back(event);
+		}
+	}
+}
+
+bool Profiler::Command_ProfileReport(EventArgs& args)
+{
+	UNUSED(args);
+	std::vector<std::string> reportLines;
+	g_theProfiler->GetLastFrameReport(reportLines);
+	for (size_t lineIndex = 0; lineIndex < reportLines.size(); ++lineIndex)
+	{
+		g_theDevConsole->AddLine(Rgba8::LIGHTYELLOW, reportLines[lineIndex]);
+	}
+	return true;
+}
+
+bool Profiler::Command_ProfileOverlay(EventArgs& args)
+{
+	UNUSED(args);
+	g_theProfiler->m_isOverlayVisible = !g_theProfiler->m_isOverlayVisible;
+	return true;
+}
+
+bool Profiler::Command_ProfileExport(EventArgs& args)
+{
+	std::string filePath = args.GetValue("path", std::string("ProfileTrace.json"));
+	bool didExport = g_theProfiler->ExportChromeTrace(filePath);
+	g_theDevConsole->AddLine(didExport ? Rgba8::GREEN : Rgba8::RED, Stringf("ProfileExport: %s %s", didExport ? "wrote" : "could not write", filePath.c_str()));
+	return true;
+}
+
+ProfileScope::ProfileScope(char const* zoneName)
+	: m_zoneName(zoneName)
+{
+	if (g_theProfiler != nullptr && g_theProfiler->IsEnabled())
+	{
+		m_depth = g_theProfiler->BeginZone();
+		m_beginSeconds = GetCurrentTimeSeconds();
+	}
+}
+
+ProfileScope::~ProfileScope()
+{
+	if (m_depth >= 0 && g_theProfiler != nullptr)
+	{
+		g_theProfiler->EndZone(m_zoneName, m_beginSeconds, m_depth);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "Game/FrameArena.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+#define PROFILE_SCOPE_JOIN_INNER(a, b) a##b
+#define PROFILE_SCOPE_JOIN(a, b) PROFILE_SCOPE_JOIN_INNER(a, b)
+#define PROFILE_SCOPE(zoneName) ProfileScope PROFILE_SCOPE_JOIN(profileScope_, __LINE__)(zoneName)
+// -----------------------------------------------------------------------------
+constexpr int PROFILER_EVENTS_PER_THREAD = 16384;
+// -----------------------------------------------------------------------------
+struct ProfileEvent
+{
+	char const* m_name = nullptr;	// Must be a string literal, only the pointer is kept
+	double m_beginSeconds = 0.0;
+	double m_endSeconds = 0.0;
+	int m_depth = 0;
+};
+// -----------------------------------------------------------------------------
+// One line of a frame report, either the header that starts a thread's zones
+// or the merged total of every zone with the same name under the same parent.
+// -----------------------------------------------------------------------------
+struct ProfileReportRow
+{
+	char const* m_name = nullptr;	// Null for a thread header row
+	int m_threadID = 0;
+	int m_depth = 0;
+	int m_numCalls = 0;
+	double m_totalSeconds = 0.0;
+};
+// -----------------------------------------------------------------------------
+struct ProfilerConfig
+{
+	bool m_isEnabled = true;
+};
+// -----------------------------------------------------------------------------
+// Hierarchical zone timer. Each thread records finished zones into its own ring
+// buffer, so recording never takes a lock; only the first zone on a new thread
+// registers that thread's buffer. Reports and trace exports read the rings
+// while threads keep writing, so a zone that wraps during a read can be torn.
+// -----------------------------------------------------------------------------
+class Profiler
+{
+public:
+	Profiler(ProfilerConfig const& config);
+	~Profiler();
+
+	void Startup();
+	void Shutdown();
+	void BeginFrame();
+
+	bool IsEnabled() const { return m_config.m_isEnabled; }
+	bool IsOverlayVisible() const { return m_isOverlayVisible; }
+	int  BeginZone();
+	void EndZone(char const* zoneName, double beginSeconds, int depth);
+
+	double GetLastFrameSeconds() const { return m_frameStartSeconds - m_lastFrameStartSeconds; }
+	void GetLastFrameRows(FrameVector<ProfileReportRow>& out_rows) const;
+	void GetLastFrameReport(std::vector<std::string>& out_lines) const;
+	bool ExportChromeTrace(std::string const& filePath) const;
+
+	static bool Command_ProfileReport(EventArgs& args);
+	static bool Command_ProfileOverlay(EventArgs& args);
+	static bool Command_ProfileExport(EventArgs& args);
+
+private:
+	struct ThreadBuffer
+	{
+		int m_threadID = 0;
+		int m_depth = 0;
+		std::atomic<unsigned int> m_numEventsWritten{ 0 };
+		ProfileEvent m_events[PROFILER_EVENTS_PER_THREAD];
+	};
+
+	ThreadBuffer* GetOrCreateThreadBuffer();
+	void CopyEventsInRange(ThreadBuffer const& buffer, double startSeconds, double endSeconds, FrameVector<ProfileEvent>& out_events) const;
+
+private:
+	ProfilerConfig m_config;
+	bool m_isOverlayVisible = false;
+	double m_startSeconds = 0.0;
+	double m_frameStartSeconds = 0.0;
+	double m_lastFrameStartSeconds = 0.0;
+
+	mutable std::mutex m_threadBuffersMutex;
+	std::vector<ThreadBuffer*> m_threadBuffers;
+};
+// -----------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+	explicit ProfileScope(char const* zoneName);
+	~ProfileScope();
+
+private:
+	char const* m_zoneName = nullptr;
+	double m_beginSeconds = 0.0;
+	int m_depth = -1;
+};
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "Game/RenderCommandList.hpp"
+#include "Game/MeshCache.hpp"
+#include "Game/RenderStateTracker.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include <algorithm>
+#include <string.h>
+
+template <typename IndexType>
+static void AppendOffsetIndexes(std::vector<unsigned int>& indexes, IndexType const* meshIndexes, size_t numMeshIndexes, unsigned int firstVertex)
+{
+	for (size_t index = 0; index < numMeshIndexes; ++index)
+	{
+		indexes.push_back(firstVertex + meshIndexes[index]);
+	}
+}
+
+static Rgba8 MultiplyColors(Rgba8 const& colorA, Rgba8 const& colorB)
+{
+	return Rgba8(
+		static_cast<unsigned char>((colorA.r * colorB.r) / 255),
+		static_cast<unsigned char>((colorA.g * colorB.g) / 255),
+		static_cast<unsigned char>((colorA.b * colorB.b) / 255),
+		static_cast<unsigned char>((colorA.a * colorB.a) / 255));
+}
+
+bool RenderState::operator==(RenderState const& compare) const
+{
+	return m_blendMode == compare.m_blendMode && m_rasterizerMode == compare.m_rasterizerMode && m_depthMode == compare.m_depthMode && m_texture == compare.m_texture;
+}
+
+RenderCommandList::RenderCommandList()
+{
+}
+
+RenderCommandList::~RenderCommandList()
+{
+	Release();
+}
+
+void RenderCommandList::Reset()
+{
+	// Batches and their baked vertexes carry over; only what was added this frame is drawn
+	++m_frameNumber;
+	m_textureSlots.clear();
+	m_drawCommands.clear();
+	for (size_t groupIndex = 0; groupIndex < m_movingGroups.size(); ++groupIndex)
+	{
+		m_movingGroups[groupIndex].m_instances.clear();
+	}
+	m_numMovingInstances = 0;
+}
+
+void RenderCommandList::AddInstance(int entityIndex, int meshID, RenderState const& renderState, Mat44 const& modelToWorld, Rgba8 const& tint)
+{
+	if (entityIndex >= static_cast<int>(m_entitySlots.size()))
+	{
+		m_entitySlots.resize(static_cast<size_t>(entityIndex) + 1);
+	}
+
+	// An entity usually stays in the batch it was in last frame, so that one is checked before searching
+	EntitySlot& entitySlot = m_entitySlots[entityIndex];
+	int batchIndex = entitySlot.m_batchIndex;
+	bool isInPreviousBatch = batchIndex >= 0 && m_batches[batchIndex].m_meshID == meshID && m_batches[batchIndex].m_renderState == renderState;
+	if (!isInPreviousBatch)
+	{
+		batchIndex = FindOrCreateBatch(meshID, renderState);
+	}
+	InstanceBatch& batch = m_batches[batchIndex];
+
+	int slot = entitySlot.m_slot;
+	bool ownsSlot = isInPreviousBatch && slot >= 0 && slot < static_cast<int>(batch.m_slotEntities.size()) && batch.m_slotEntities[slot] == entityIndex
+		&& batch.m_slotFrames[slot] != m_frameNumber;
+	if (ownsSlot)
+	{
+		InstanceData& instance = batch.m_slotInstances[slot];
+		bool isSameTint = instance.m_tint.r == tint.r && instance.m_tint.g == tint.g && instance.m_tint.b == tint.b && instance.m_tint.a == tint.a;
+		if (!isSameTint || memcmp(&instance.m_modelToWorld, &modelToWorld, sizeof(Mat44)) != 0)
+		{
+			instance.m_modelToWorld = modelToWorld;
+			instance.m_tint = tint;
+			if (batch.m_slotBakes[slot] == INSTANCE_SLOT_BAKED)
+			{
+				batch.m_slotBakes[slot] = INSTANCE_SLOT_CHANGED;
+			}
+		}
+	}
+	else
+	{
+		// The slot the entity had in another batch is left behind and freed at Build
+		slot = TakeSlot(batch);
+		batch.m_slotEntities[slot] = entityIndex;
+		batch.m_slotInstances[slot].m_modelToWorld = modelToWorld;
+		batch.m_slotInstances[slot].m_tint = tint;
+		batch.m_slotBakes[slot] = INSTANCE_SLOT_ADDED;
+		entitySlot.m_batchIndex = batchIndex;
+		entitySlot.m_slot = slot;
+	}
+	batch.m_slotFrames[slot] = m_frameNumber;
+}
+
+void RenderCommandList::AddMovingInstance(int entityIndex, int meshID, RenderState const& renderState, Mat44 const& modelToWorld, Rgba8 const& tint)
+{
+	if (entityIndex >= static_cast<int>(m_entitySlots.size()))
+	{
+		m_entitySlots.resize(static_cast<size_t>(entityIndex) + 1);
+	}
+
+	// Not being added to its batch frees the entity's baked slot at Build, so a prop that starts moving stops being baked
+	EntitySlot& entitySlot = m_entitySlots[entityIndex];
+	int groupIndex = entitySlot.m_movingGroupIndex;
+	if (groupIndex < 0 || m_movingGroups[groupIndex].m_meshID != meshID || !(m_movingGroups[groupIndex].m_renderState == renderState))
+	{
+		groupIndex = -1;
+		for (int searchIndex = 0; searchIndex < static_cast<int>(m_movingGroups.size()); ++searchIndex)
+		{
+			if (m_movingGroups[searchIndex].m_meshID == meshID && m_movingGroups[searchIndex].m_renderState == renderState)
+			{
+				groupIndex = searchIndex;
+				break;
+			}
+		}
+		if (groupIndex < 0)
+		{
+			m_movingGroups.emplace_back();
+			groupIndex = static_cast<int>(m_movingGroups.size()) - 1;
+			m_movingGroups[groupIndex].m_meshID = meshID;
+			m_movingGroups[groupIndex].m_renderState = renderState;
+		}
+		entitySlot.m_movingGroupIndex = groupIndex;
+	}
+
+	InstanceData instance;
+	instance.m_modelToWorld = modelToWorld;
+	instance.m_tint = tint;
+	m_movingGroups[groupIndex].m_instances.push_back(instance);
+	++m_numMovingInstances;
+}
+
+void RenderCommandList::Build(MeshCache const& meshCache)
+{
+	m_drawCommands.clear();
+	m_numBakedInstances = 0;
+
+	for (int batchIndex = 0; batchIndex < static_cast<int>(m_batches.size()); ++batchIndex)
+	{
+		InstanceBatch& batch = m_batches[batchIndex];
+		if (batch.m_meshID < 0)
+		{
+			continue;
+		}
+
+		Mesh const& mesh = meshCache.GetMesh(batch.m_meshID);
+		size_t numMeshVertexes = mesh.m_numVertexes;
+		if (batch.m_numSlotsPerChunk == 0)
+		{
+			size_t numSlotsPerChunk = numMeshVertexes > 0 ? RENDER_CHUNK_MAX_VERTEXES / numMeshVertexes : RENDER_CHUNK_MAX_VERTEXES;
+			batch.m_numSlotsPerChunk = numSlotsPerChunk > 0 ? static_cast<int>(numSlotsPerChunk) : 1;
+		}
+
+		// Entities not added this frame went out of view or moved to another batch
+		int numSlots = static_cast<int>(batch.m_slotEntities.size());
+		int numChunks = (numSlots + batch.m_numSlotsPerChunk - 1) / batch.m_numSlotsPerChunk;
+		if (static_cast<int>(batch.m_chunks.size()) < numChunks)
+		{
+			batch.m_chunks.resize(static_cast<size_t>(numChunks));
+		}
+		for (int slot = 0; slot < numSlots; ++slot)
+		{
+			if (batch.m_slotEntities[slot] >= 0 && batch.m_slotFrames[slot] != m_frameNumber)
+			{
+				batch.m_slotEntities[slot] = -1;
+				batch.m_freeSlots.push_back(slot);
+				batch.m_chunks[slot / batch.m_numSlotsPerChunk].m_areIndexesDirty = true;
+				--batch.m_numLiveSlots;
+			}
+		}
+		if (batch.m_numLiveSlots == 0)
+		{
+			RetireBatch(batch);
+			continue;
+		}
+
+		for (int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+		{
+			InstanceChunk& chunk = batch.m_chunks[chunkIndex];
+			int firstSlot = chunkIndex * batch.m_numSlotsPerChunk;
+			int endSlot = firstSlot + batch.m_numSlotsPerChunk < numSlots ? firstSlot + batch.m_numSlotsPerChunk : numSlots;
+			chunk.m_vertexes.resize(static_cast<size_t>(endSlot - firstSlot) * numMeshVertexes);
+
+			// Bake each changed instance's transform and tint into its own run of the chunk's vertexes
+			for (int slot = firstSlot; slot < endSlot; ++slot)
+			{
+				if (batch.m_slotEntities[slot] < 0 || batch.m_slotBakes[slot] == INSTANCE_SLOT_BAKED)
+				{
+					continue;
+				}
+				if (batch.m_slotBakes[slot] == INSTANCE_SLOT_ADDED)
+				{
+					chunk.m_areIndexesDirty = true;
+				}
+				batch.m_slotBakes[slot] = INSTANCE_SLOT_BAKED;
+				chunk.m_areVertexesDirty = true;
+				++m_numBakedInstances;
+
+				InstanceData const& instance = batch.m_slotInstances[slot];
+				Vertex_PCU* outVertex = chunk.m_vertexes.data() + static_cast<size_t>(slot - firstSlot) * numMeshVertexes;
+				for (size_t vertIndex = 0; vertIndex < numMeshVertexes; ++vertIndex)
+				{
+					Vertex_PCU const& meshVertex = mesh.m_vertexes[vertIndex];
+					outVertex[vertIndex].m_position = instance.m_modelToWorld.TransformPosition3D(meshVertex.m_position);
+					outVertex[vertIndex].m_color = MultiplyColors(meshVertex.m_color, instance.m_tint);
+					outVertex[vertIndex].m_uvTexCoords = meshVertex.m_uvTexCoords;
+				}
+			}
+
+			if (chunk.m_areIndexesDirty)
+			{
+				RebuildChunkIndexes(batch, chunk, firstSlot, endSlot, mesh);
+			}
+			if (chunk.m_indexes.empty())
+			{
+				continue;
+			}
+
+			DrawCommand command;
+			command.m_sortKey = ComputeSortKey(batch.m_meshID, batch.m_renderState);
+			command.m_renderState = batch.m_renderState;
+			command.m_batchIndex = batchIndex;
+			command.m_chunkIndex = chunkIndex;
+			command.m_numIndexes = chunk.m_indexes.size();
+			m_drawCommands.push_back(command);
+		}
+	}
+
+	// Each group of moving props is one command, sorted alongside the baked chunks of the same mesh and state
+	for (int groupIndex = 0; groupIndex < static_cast<int>(m_movingGroups.size()); ++groupIndex)
+	{
+		MovingInstanceGroup& group = m_movingGroups[groupIndex];
+		if (group.m_instances.empty())
+		{
+			continue;
+		}
+		group.m_mesh = &meshCache.GetMesh(group.m_meshID);
+
+		DrawCommand command;
+		command.m_sortKey = ComputeSortKey(group.m_meshID, group.m_renderState);
+		command.m_renderState = group.m_renderState;
+		command.m_movingGroupIndex = groupIndex;
+		command.m_numIndexes = group.m_mesh->m_numIndexes;
+		m_drawCommands.push_back(command);
+	}
+
+	std::sort(m_drawCommands.begin(), m_drawCommands.end(), [](DrawCommand const& commandA, DrawCommand const& commandB)
+		{
+			return commandA.m_sortKey < commandB.m_sortKey;
+		});
+}
+
+void RenderCommandList::Submit(RenderStateTracker& stateTracker)
+{
+	for (size_t commandIndex = 0; commandIndex < m_drawCommands.size(); ++commandIndex)
+	{
+		DrawCommand const& command = m_drawCommands[commandIndex];
+		stateTracker.SetBlendMode(command.m_renderState.m_blendMode);
+		stateTracker.SetRasterizerMode(command.m_renderState.m_rasterizerMode);
+		stateTracker.SetDepthMode(command.m_renderState.m_depthMode);
+		stateTracker.BindTexture(command.m_renderState.m_texture);
+
+		if (command.m_movingGroupIndex >= 0)
+		{
+			MovingInstanceGroup const& group = m_movingGroups[command.m_movingGroupIndex];
+			if (group.m_meshID >= static_cast<int>(m_sharedMeshBuffers.size()))
+			{
+				m_sharedMeshBuffers.resize(static_cast<size_t>(group.m_meshID) + 1);
+			}
+			SharedMeshBuffers& buffers = m_sharedMeshBuffers[group.m_meshID];
+			if (!buffers.m_isUploaded)
+			{
+				UploadSharedMeshBuffers(stateTracker, buffers, *group.m_mesh);
+			}
+			for (size_t instanceIndex = 0; instanceIndex < group.m_instances.size(); ++instanceIndex)
+			{
+				stateTracker.SetModelConstants(group.m_instances[instanceIndex].m_modelToWorld, group.m_instances[instanceIndex].m_tint);
+				stateTracker.DrawIndexedVertexBuffer(buffers.m_vertexBuffer, buffers.m_indexBuffer, static_cast<int>(command.m_numIndexes));
+			}
+			continue;
+		}
+
+		// Transforms and tints are already in a chunk's vertexes, so baked chunks draw with identity constants
+		InstanceChunk& chunk = m_batches[command.m_batchIndex].m_chunks[command.m_chunkIndex];
+		stateTracker.SetModelConstants();
+
+		// Buffers are only written on the main thread, and only for chunks whose contents changed since they were last drawn
+		if (chunk.m_areVertexesDirty)
+		{
+			stateTracker.CopyVertexesToGPU(chunk.m_vertexBuffer, chunk.m_vertexBufferSize, chunk.m_vertexes.data(), chunk.m_vertexes.size());
+			chunk.m_areVertexesDirty = false;
+		}
+		if (chunk.m_areIndexesDirty)
+		{
+			stateTracker.CopyIndexesToGPU(chunk.m_indexBuffer, chunk.m_indexBufferSize, chunk.m_indexes.data(), chunk.m_indexes.size());
+			chunk.m_areIndexesDirty = false;
+		}
+		stateTracker.DrawIndexedVertexBuffer(chunk.m_vertexBuffer, chunk.m_indexBuffer, static_cast<int>(command.m_numIndexes));
+	}
+}
+
+void RenderCommandList::Release()
+{
+	for (size_t batchIndex = 0; batchIndex < m_batches.size(); ++batchIndex)
+	{
+		std::vector<InstanceChunk>& chunks = m_batches[batchIndex].m_chunks;
+		for (size_t chunkIndex = 0; chunkIndex < chunks.size(); ++chunkIndex)
+		{
+			delete chunks[chunkIndex].m_vertexBuffer;
+			delete chunks[chunkIndex].m_indexBuffer;
+		}
+	}
+	for (size_t meshID = 0; meshID < m_sharedMeshBuffers.size(); ++meshID)
+	{
+		delete m_sharedMeshBuffers[meshID].m_vertexBuffer;
+		delete m_sharedMeshBuffers[meshID].m_indexBuffer;
+	}
+	m_batches.clear();
+	m_movingGroups.clear();
+	m_sharedMeshBuffers.clear();
+	m_entitySlots.clear();
+	m_textureSlots.clear();
+	m_drawCommands.clear();
+}
+
+int RenderCommandList::GetNumDrawCommands() const
+{
+	return static_cast<int>(m_drawCommands.size());
+}
+
+size_t RenderCommandList::GetNumInstances() const
+{
+	size_t numInstances = 0;
+	for (size_t batchIndex = 0; batchIndex < m_batches.size(); ++batchIndex)
+	{
+		numInstances += m_batches[batchIndex].m_numLiveSlots;
+	}
+	return numInstances;
+}
+
+size_t RenderCommandList::GetNumBakedInstances() const
+{
+	return m_numBakedInstances;
+}
+
+size_t RenderCommandList::GetNumMovingInstances() const
+{
+	return m_numMovingInstances;
+}
+
+std::vector<DrawCommand> const& RenderCommandList::GetDrawCommands() const
+{
+	return m_drawCommands;
+}
+
+int RenderCommandList::FindOrCreateBatch(int meshID, RenderState const& renderState)
+{
+	int unusedBatchIndex = -1;
+	for (int batchIndex = 0; batchIndex < static_cast<int>(m_batches.size()); ++batchIndex)
+	{
+		InstanceBatch const& batch = m_batches[batchIndex];
+		if (batch.m_meshID == meshID && batch.m_renderState == renderState)
+		{
+			return batchIndex;
+		}
+		if (batch.m_meshID < 0 && unusedBatchIndex < 0)
+		{
+			unusedBatchIndex = batchIndex;
+		}
+	}
+
+	// A retired batch is reused before a new one is added, keeping its storage and GPU buffers
+	if (unusedBatchIndex < 0)
+	{
+		m_batches.emplace_back();
+		unusedBatchIndex = static_cast<int>(m_batches.size()) - 1;
+	}
+	InstanceBatch& batch = m_batches[unusedBatchIndex];
+	batch.m_meshID = meshID;
+	batch.m_renderState = renderState;
+	batch.m_numSlotsPerChunk = 0;
+	return unusedBatchIndex;
+}
+
+int RenderCommandList::TakeSlot(InstanceBatch& batch)
+{
+	++batch.m_numLiveSlots;
+	if (!batch.m_freeSlots.empty())
+	{
+		int slot = batch.m_freeSlots.back();
+		batch.m_freeSlots.pop_back();
+		return slot;
+	}
+
+	batch.m_slotInstances.emplace_back();
+	batch.m_slotEntities.push_back(-1);
+	batch.m_slotFrames.push_back(0);
+	batch.m_slotBakes.push_back(INSTANCE_SLOT_ADDED);
+	return static_cast<int>(batch.m_slotEntities.size()) - 1;
+}
+
+void RenderCommandList::RetireBatch(InstanceBatch& batch)
+{
+	// Nothing drew with this mesh and state this frame; the batch keeps its capacity for whichever pair needs one next
+	batch.m_meshID = -1;
+	batch.m_renderState = RenderState();
+	batch.m_numSlotsPerChunk = 0;
+	batch.m_slotInstances.clear();
+	batch.m_slotEntities.clear();
+	batch.m_slotFrames.clear();
+	batch.m_slotBakes.clear();
+	batch.m_freeSlots.clear();
+	batch.m_numLiveSlots = 0;
+	for (size_t chunkIndex = 0; chunkIndex < batch.m_chunks.size(); ++chunkIndex)
+	{
+		batch.m_chunks[chunkIndex].m_vertexes.clear();
+		batch.m_chunks[chunkIndex].m_indexes.clear();
+		batch.m_chunks[chunkIndex].m_areVertexesDirty = false;
+		batch.m_chunks[chunkIndex].m_areIndexesDirty = false;
+	}
+}
+
+void RenderCommandList::UploadSharedMeshBuffers(RenderStateTracker& stateTracker, SharedMeshBuffers& buffers, Mesh const& mesh)
+{
+	// Done once per mesh on the main thread; the cached mesh never changes after it is created
+	m_uploadIndexes.resize(mesh.m_numIndexes);
+	for (size_t indexIndex = 0; indexIndex < mesh.m_numIndexes; ++indexIndex)
+	{
+		m_uploadIndexes[indexIndex] = mesh.GetIndex(indexIndex);
+	}
+	stateTracker.CopyVertexesToGPU(buffers.m_vertexBuffer, buffers.m_vertexBufferSize, mesh.m_vertexes, mesh.m_numVertexes);
+	stateTracker.CopyIndexesToGPU(buffers.m_indexBuffer, buffers.m_indexBufferSize, m_uploadIndexes.data(), m_uploadIndexes.size());
+	buffers.m_isUploaded = true;
+}
+
+void RenderCommandList::RebuildChunkIndexes(InstanceBatch const& batch, InstanceChunk& chunk, int firstSlot, int endSlot, Mesh const& mesh) const
+{
+	// The mesh's cache-ordered index list, offset to each live slot's vertexes; chunks can pass 64K vertexes, so these are always 32-bit
+	chunk.m_indexes.clear();
+	for (int slot = firstSlot; slot < endSlot; ++slot)
+	{
+		if (batch.m_slotEntities[slot] < 0)
+		{
+			continue;
+		}
+		unsigned int firstVertex = static_cast<unsigned int>(static_cast<size_t>(slot - firstSlot) * mesh.m_numVertexes);
+		if (mesh.m_indexFormat == MeshIndexFormat::UINT16)
+		{
+			AppendOffsetIndexes(chunk.m_indexes, static_cast<uint16_t const*>(mesh.m_indexes), mesh.m_numIndexes, firstVertex);
+		}
+		else
+		{
+			AppendOffsetIndexes(chunk.m_indexes, static_cast<uint32_t const*>(mesh.m_indexes), mesh.m_numIndexes, firstVertex);
+		}
+	}
+}
+
+uint64_t RenderCommandList::ComputeSortKey(int meshID, RenderState const& renderState)
+{
+	// Textures get a small per-frame slot so they fit in the key
+	uint64_t textureSlot = 0;
+	while (textureSlot < m_textureSlots.size() && m_textureSlots[textureSlot] != renderState.m_texture)
+	{
+		++textureSlot;
+	}
+	if (textureSlot == m_textureSlots.size())
+	{
+		m_textureSlots.push_back(renderState.m_texture);
+	}
+
+	// Opaque draws go first, then the remaining blend modes in enum order
+	uint64_t blendRank = renderState.m_blendMode == BlendMode::OPAQUE ? 0 : 1 + static_cast<uint64_t>(renderState.m_blendMode);
+
+	// | blend:4 | rasterizer:4 | depth:4 | texture:20 | mesh:32 |
+	uint64_t sortKey = 0;
+	sortKey |= (blendRank & 0xF) << 60;
+	sortKey |= (static_cast<uint64_t>(renderState.m_rasterizerMode) & 0xF) << 56;
+	sortKey |= (static_cast<uint64_t>(renderState.m_depthMode) & 0xF) << 52;
+	sortKey |= (textureSlot & 0xFFFFF) << 32;
+	sortKey |= static_cast<uint64_t>(static_cast<uint32_t>(meshID));
+	return sortKey;
+}
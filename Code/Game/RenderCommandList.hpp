@@ -0,0 +1,163 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Renderer/Renderer.h"
+#include <vector>
+#include <cstdint>
+// -----------------------------------------------------------------------------
+class IndexBuffer;
+class MeshCache;
+struct Mesh;
+class RenderStateTracker;
+class Texture;
+class VertexBuffer;
+// -----------------------------------------------------------------------------
+constexpr size_t RENDER_CHUNK_MAX_VERTEXES = 1 << 18;	// 6 MB of Vertex_PCU, the most one instance change can cause to be re-uploaded
+// -----------------------------------------------------------------------------
+struct RenderState
+{
+	BlendMode m_blendMode = BlendMode::OPAQUE;
+	RasterizerMode m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+	DepthMode m_depthMode = DepthMode::READ_WRITE_LESS_EQUAL;
+	Texture* m_texture = nullptr;
+
+	bool operator==(RenderState const& compare) const;
+};
+// -----------------------------------------------------------------------------
+struct InstanceData
+{
+	Mat44 m_modelToWorld;
+	Rgba8 m_tint = Rgba8::WHITE;
+};
+// -----------------------------------------------------------------------------
+// A run of a batch's instance slots drawn with one call. Vertexes are kept for
+// every slot, live or not, so a slot's vertexes only change when its instance
+// does; the index list covers the live slots only.
+// -----------------------------------------------------------------------------
+struct InstanceChunk
+{
+	std::vector<Vertex_PCU> m_vertexes;
+	std::vector<unsigned int> m_indexes;
+	VertexBuffer* m_vertexBuffer = nullptr;
+	IndexBuffer* m_indexBuffer = nullptr;
+	unsigned int m_vertexBufferSize = 0;
+	unsigned int m_indexBufferSize = 0;
+	bool m_areVertexesDirty = false;
+	bool m_areIndexesDirty = false;
+};
+// -----------------------------------------------------------------------------
+enum InstanceSlotBake : unsigned char
+{
+	INSTANCE_SLOT_BAKED,
+	INSTANCE_SLOT_CHANGED,		// Same entity, new transform or tint
+	INSTANCE_SLOT_ADDED,		// Newly taken, so its chunk's index list changes too
+};
+// -----------------------------------------------------------------------------
+// The props of one mesh and render state whose transforms were rebuilt in the
+// last simulation step. Baking them would mean re-transforming and re-uploading
+// their vertexes every frame, so they are drawn from the mesh's shared buffers
+// instead, one call each with their transform and tint as model constants.
+// -----------------------------------------------------------------------------
+struct MovingInstanceGroup
+{
+	int m_meshID = -1;
+	RenderState m_renderState;
+	Mesh const* m_mesh = nullptr;				// Resolved at Build so Submit can upload the shared buffers without the cache
+	std::vector<InstanceData> m_instances;		// This frame's only; cleared at Reset
+};
+// -----------------------------------------------------------------------------
+struct SharedMeshBuffers
+{
+	VertexBuffer* m_vertexBuffer = nullptr;
+	IndexBuffer* m_indexBuffer = nullptr;
+	unsigned int m_vertexBufferSize = 0;
+	unsigned int m_indexBufferSize = 0;
+	bool m_isUploaded = false;
+};
+// -----------------------------------------------------------------------------
+struct InstanceBatch
+{
+	int m_meshID = -1;							// -1 while the batch is unused and free for another mesh and state
+	RenderState m_renderState;
+	int m_numSlotsPerChunk = 0;
+
+	std::vector<InstanceData>	m_slotInstances;
+	std::vector<int>			m_slotEntities;		// -1 for free slots
+	std::vector<uint32_t>		m_slotFrames;		// Last frame the slot's entity was added; live slots left behind are freed at Build
+	std::vector<unsigned char>	m_slotBakes;		// InstanceSlotBake
+	std::vector<int>			m_freeSlots;
+	std::vector<InstanceChunk>	m_chunks;
+	size_t m_numLiveSlots = 0;
+};
+// -----------------------------------------------------------------------------
+struct DrawCommand
+{
+	uint64_t m_sortKey = 0;
+	RenderState m_renderState;
+	int m_batchIndex = -1;
+	int m_chunkIndex = 0;
+	int m_movingGroupIndex = -1;				// Set instead of a batch for a group of moving props
+	size_t m_numIndexes = 0;
+};
+// -----------------------------------------------------------------------------
+// Collects the props that share a mesh and render state into batches whose
+// instance transforms and tints are baked into the vertexes, so each chunk of
+// a batch is one indexed draw. Batches persist between frames: an entity keeps
+// its instance slot while it stays in the same batch, and only slots whose
+// transform or tint changed are baked again, so props that do not move cost a
+// 64-byte compare instead of a mesh transform and nothing is re-uploaded for
+// chunks where nothing changed. Props that moved in the last simulation step
+// are added as moving instances instead and drawn from their mesh's shared
+// buffers, so motion never re-bakes anything. Draws are sorted by blend/
+// rasterizer/depth/texture/mesh so consecutive commands share as much state as
+// possible.
+// Recording and building are CPU-only; Submit is the only call that touches the
+// renderer, so draw counts can be checked without a device.
+// -----------------------------------------------------------------------------
+class RenderCommandList
+{
+public:
+	RenderCommandList();
+	~RenderCommandList();
+
+	void Reset();
+	void AddInstance(int entityIndex, int meshID, RenderState const& renderState, Mat44 const& modelToWorld, Rgba8 const& tint);
+	void AddMovingInstance(int entityIndex, int meshID, RenderState const& renderState, Mat44 const& modelToWorld, Rgba8 const& tint);
+	void Build(MeshCache const& meshCache);
+	void Submit(RenderStateTracker& stateTracker);
+	void Release();
+
+	int GetNumDrawCommands() const;
+	size_t GetNumInstances() const;
+	size_t GetNumBakedInstances() const;
+	size_t GetNumMovingInstances() const;
+	std::vector<DrawCommand> const& GetDrawCommands() const;
+
+private:
+	struct EntitySlot
+	{
+		int m_batchIndex = -1;
+		int m_slot = -1;
+		int m_movingGroupIndex = -1;
+	};
+
+	int  FindOrCreateBatch(int meshID, RenderState const& renderState);
+	int  TakeSlot(InstanceBatch& batch);
+	void RetireBatch(InstanceBatch& batch);
+	void UploadSharedMeshBuffers(RenderStateTracker& stateTracker, SharedMeshBuffers& buffers, Mesh const& mesh);
+	void RebuildChunkIndexes(InstanceBatch const& batch, InstanceChunk& chunk, int firstSlot, int endSlot, Mesh const& mesh) const;
+	uint64_t ComputeSortKey(int meshID, RenderState const& renderState);
+
+private:
+	std::vector<InstanceBatch> m_batches;
+	std::vector<MovingInstanceGroup> m_movingGroups;	// Kept between frames for their capacity
+	std::vector<SharedMeshBuffers> m_sharedMeshBuffers;	// Indexed by mesh ID, uploaded the first time a moving prop uses the mesh
+	std::vector<unsigned int> m_uploadIndexes;
+	std::vector<EntitySlot> m_entitySlots;		// Indexed by entity index; checked against the slot's entity before use
+	std::vector<Texture*> m_textureSlots;
+	std::vector<DrawCommand> m_drawCommands;
+	uint32_t m_frameNumber = 0;
+	size_t m_numBakedInstances = 0;
+	size_t m_numMovingInstances = 0;
+};
\ No newline at end of file
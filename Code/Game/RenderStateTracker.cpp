@@ -0,0 +1,183 @@
+#include "Game/RenderStateTracker.hpp"
+#include "Game/GameCommon.h"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include <string.h>
+
+RenderStateTracker::RenderStateTracker()
+{
+}
+
+RenderStateTracker::~RenderStateTracker()
+{
+}
+
+void RenderStateTracker::BeginFrame()
+{
+	m_lastFrameStats = m_frameStats;
+	m_frameStats = RenderStats();
+	Invalidate();
+}
+
+void RenderStateTracker::Invalidate()
+{
+	// Anything drawn outside the tracker (debug render, dev console) may have changed the real state
+	m_isBlendModeKnown = false;
+	m_isRasterizerModeKnown = false;
+	m_isDepthModeKnown = false;
+	m_isTextureKnown = false;
+	m_areModelConstantsKnown = false;
+}
+
+void RenderStateTracker::SetNullBackend(bool isNullBackend)
+{
+	m_isNullBackend = isNullBackend;
+	Invalidate();
+}
+
+void RenderStateTracker::SetBlendMode(BlendMode blendMode)
+{
+	if (m_isBlendModeKnown && m_blendMode == blendMode)
+	{
+		++m_frameStats.m_numStateChangesFiltered;
+		return;
+	}
+	m_isBlendModeKnown = true;
+	m_blendMode = blendMode;
+	++m_frameStats.m_numStateChangesIssued;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->SetBlendMode(blendMode);
+	}
+}
+
+void RenderStateTracker::SetRasterizerMode(RasterizerMode rasterizerMode)
+{
+	if (m_isRasterizerModeKnown && m_rasterizerMode == rasterizerMode)
+	{
+		++m_frameStats.m_numStateChangesFiltered;
+		return;
+	}
+	m_isRasterizerModeKnown = true;
+	m_rasterizerMode = rasterizerMode;
+	++m_frameStats.m_numStateChangesIssued;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->SetRasterizerMode(rasterizerMode);
+	}
+}
+
+void RenderStateTracker::SetDepthMode(DepthMode depthMode)
+{
+	if (m_isDepthModeKnown && m_depthMode == depthMode)
+	{
+		++m_frameStats.m_numStateChangesFiltered;
+		return;
+	}
+	m_isDepthModeKnown = true;
+	m_depthMode = depthMode;
+	++m_frameStats.m_numStateChangesIssued;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->SetDepthMode(depthMode);
+	}
+}
+
+void RenderStateTracker::BindTexture(Texture const* texture)
+{
+	if (m_isTextureKnown && m_texture == texture)
+	{
+		++m_frameStats.m_numStateChangesFiltered;
+		return;
+	}
+	m_isTextureKnown = true;
+	m_texture = texture;
+	++m_frameStats.m_numStateChangesIssued;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->BindTexture(texture);
+	}
+}
+
+void RenderStateTracker::SetModelConstants(Mat44 const& modelToWorldTransform, Rgba8 const& modelColor)
+{
+	bool isSameColor = m_modelColor.r == modelColor.r && m_modelColor.g == modelColor.g && m_modelColor.b == modelColor.b && m_modelColor.a == modelColor.a;
+	if (m_areModelConstantsKnown && isSameColor && memcmp(&m_modelToWorldTransform, &modelToWorldTransform, sizeof(Mat44)) == 0)
+	{
+		++m_frameStats.m_numStateChangesFiltered;
+		return;
+	}
+	m_areModelConstantsKnown = true;
+	m_modelToWorldTransform = modelToWorldTransform;
+	m_modelColor = modelColor;
+	++m_frameStats.m_numStateChangesIssued;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->SetModelConstants(modelToWorldTransform, modelColor);
+	}
+}
+
+void RenderStateTracker::DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes)
+{
+	++m_frameStats.m_numDrawCalls;
+	m_frameStats.m_numVertexes += numVertexes;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->DrawVertexArray(numVertexes, vertexes);
+	}
+}
+
+void RenderStateTracker::DrawIndexedVertexBuffer(VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, int numIndexes)
+{
+	++m_frameStats.m_numDrawCalls;
+	m_frameStats.m_numIndexes += numIndexes;
+	if (!m_isNullBackend)
+	{
+		g_theRenderer->DrawIndexedVertexBuffer(vertexBuffer, indexBuffer, static_cast<unsigned int>(numIndexes));
+	}
+}
+
+void RenderStateTracker::CopyVertexesToGPU(VertexBuffer*& vertexBuffer, unsigned int& vertexBufferSize, Vertex_PCU const* vertexes, size_t numVertexes)
+{
+	// The buffer is only replaced when the data outgrows it
+	unsigned int numBytes = static_cast<unsigned int>(numVertexes * sizeof(Vertex_PCU));
+	m_frameStats.m_numBytesUploaded += numBytes;
+	if (m_isNullBackend || numBytes == 0)
+	{
+		return;
+	}
+	if (vertexBuffer == nullptr || numBytes > vertexBufferSize)
+	{
+		delete vertexBuffer;
+		vertexBuffer = g_theRenderer->CreateVertexBuffer(numBytes);
+		vertexBufferSize = numBytes;
+	}
+	g_theRenderer->CopyCPUToGPU(vertexes, numBytes, vertexBuffer);
+}
+
+void RenderStateTracker::CopyIndexesToGPU(IndexBuffer*& indexBuffer, unsigned int& indexBufferSize, unsigned int const* indexes, size_t numIndexes)
+{
+	unsigned int numBytes = static_cast<unsigned int>(numIndexes * sizeof(unsigned int));
+	m_frameStats.m_numBytesUploaded += numBytes;
+	if (m_isNullBackend || numBytes == 0)
+	{
+		return;
+	}
+	if (indexBuffer == nullptr || numBytes > indexBufferSize)
+	{
+		delete indexBuffer;
+		indexBuffer = g_theRenderer->CreateIndexBuffer(numBytes);
+		indexBufferSize = numBytes;
+	}
+	g_theRenderer->CopyCPUToGPU(indexes, numBytes, indexBuffer);
+}
+
+RenderStats const& RenderStateTracker::GetFrameStats() const
+{
+	return m_frameStats;
+}
+
+RenderStats const& RenderStateTracker::GetLastFrameStats() const
+{
+	return m_lastFrameStats;
+}
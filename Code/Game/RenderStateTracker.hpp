@@ -0,0 +1,66 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Renderer/Renderer.h"
+// -----------------------------------------------------------------------------
+class Texture;
+class VertexBuffer;
+class IndexBuffer;
+// -----------------------------------------------------------------------------
+struct RenderStats
+{
+	int m_numStateChangesIssued = 0;
+	int m_numStateChangesFiltered = 0;
+	int m_numDrawCalls = 0;
+	int m_numVertexes = 0;
+	int m_numIndexes = 0;
+	size_t m_numBytesUploaded = 0;
+};
+// -----------------------------------------------------------------------------
+// Sits between game rendering code and the Renderer, remembering the last state
+// that was set so that repeated blend/rasterizer/depth/texture/constant changes
+// are dropped instead of reaching the driver. With the null backend nothing
+// reaches the Renderer at all and only the stats are recorded.
+// -----------------------------------------------------------------------------
+class RenderStateTracker
+{
+public:
+	RenderStateTracker();
+	~RenderStateTracker();
+
+	void BeginFrame();
+	void Invalidate();
+	void SetNullBackend(bool isNullBackend);
+
+	void SetBlendMode(BlendMode blendMode);
+	void SetRasterizerMode(RasterizerMode rasterizerMode);
+	void SetDepthMode(DepthMode depthMode);
+	void BindTexture(Texture const* texture);
+	void SetModelConstants(Mat44 const& modelToWorldTransform = Mat44(), Rgba8 const& modelColor = Rgba8::WHITE);
+	void DrawVertexArray(int numVertexes, Vertex_PCU const* vertexes);
+	void DrawIndexedVertexBuffer(VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, int numIndexes);
+	void CopyVertexesToGPU(VertexBuffer*& vertexBuffer, unsigned int& vertexBufferSize, Vertex_PCU const* vertexes, size_t numVertexes);
+	void CopyIndexesToGPU(IndexBuffer*& indexBuffer, unsigned int& indexBufferSize, unsigned int const* indexes, size_t numIndexes);
+
+	RenderStats const& GetFrameStats() const;
+	RenderStats const& GetLastFrameStats() const;
+
+private:
+	bool m_isNullBackend = false;
+	bool m_isBlendModeKnown = false;
+	bool m_isRasterizerModeKnown = false;
+	bool m_isDepthModeKnown = false;
+	bool m_isTextureKnown = false;
+	bool m_areModelConstantsKnown = false;
+
+	BlendMode m_blendMode = BlendMode::OPAQUE;
+	RasterizerMode m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+	DepthMode m_depthMode = DepthMode::READ_WRITE_LESS_EQUAL;
+	Texture const* m_texture = nullptr;
+	Mat44 m_modelToWorldTransform;
+	Rgba8 m_modelColor = Rgba8::WHITE;
+
+	RenderStats m_frameStats;
+	RenderStats m_lastFrameStats;
+};
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include "Game/SceneFile.hpp"
+#include "Game/MeshCache.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/StringUtils.hpp"
+#include <fstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+bool SceneFile::Open(std::string const& filePath, std::string& out_error)
+{
+	Close();
+	if (!m_mappedFile.Open(filePath))
+	{
+		out_error = Stringf("could not map \"%s\"", filePath.c_str());
+		return false;
+	}
+
+	if (m_mappedFile.GetSize() < sizeof(SceneFileHeader))
+	{
+		out_error = "file is smaller than a scene header";
+		Close();
+		return false;
+	}
+	m_header = reinterpret_cast<SceneFileHeader const*>(m_mappedFile.GetData());
+
+	if (!Validate(out_error))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void SceneFile::Close()
+{
+	m_header = nullptr;
+	m_mappedFile.Close();
+}
+
+int SceneFile::GetNumMeshes() const
+{
+	return static_cast<int>(m_header->m_numMeshes);
+}
+
+int SceneFile::GetNumTextures() const
+{
+	return static_cast<int>(m_header->m_numTextures);
+}
+
+int SceneFile::GetNumEntities() const
+{
+	return static_cast<int>(m_header->m_numEntities);
+}
+
+SceneMeshRecord const& SceneFile::GetMesh(int meshIndex) const
+{
+	return static_cast<SceneMeshRecord const*>(GetBytesAt(m_header->m_meshesOffset))[meshIndex];
+}
+
+SceneEntityRecord const* SceneFile::GetEntities() const
+{
+	return static_cast<SceneEntityRecord const*>(GetBytesAt(m_header->m_entitiesOffset));
+}
+
+char const* SceneFile::GetTexturePath(int textureIndex) const
+{
+	SceneTextureRecord const& texture = static_cast<SceneTextureRecord const*>(GetBytesAt(m_header->m_texturesOffset))[textureIndex];
+	return static_cast<char const*>(GetBytesAt(texture.m_pathOffset));
+}
+
+void const* SceneFile::GetBytesAt(uint32_t offset) const
+{
+	return m_mappedFile.GetData() + offset;
+}
+
+bool SceneFile::Validate(std::string& out_error) const
+{
+	// Everything is range-checked once here so the getters can index the mapping directly
+	SceneFileHeader const& header = *m_header;
+	uint64_t fileSize = static_cast<uint64_t>(m_mappedFile.GetSize());
+	if (header.m_magic != SCENE_FILE_MAGIC)
+	{
+		out_error = "not a scene file";
+		return false;
+	}
+	if (header.m_version != SCENE_FILE_VERSION)
+	{
+		out_error = Stringf("scene version %u, expected %u", header.m_version, SCENE_FILE_VERSION);
+		return false;
+	}
+	if (header.m_fileSize != fileSize)
+	{
+		out_error = "scene file is truncated";
+		return false;
+	}
+
+	auto IsRangeInFile = [fileSize](uint32_t offset, uint64_t numBytes)
+		{
+			return (offset % 4) == 0 && static_cast<uint64_t>(offset) + numBytes <= fileSize;
+		};
+	if (!IsRangeInFile(header.m_meshesOffset, static_cast<uint64_t>(header.m_numMeshes) * sizeof(SceneMeshRecord))
+		|| !IsRangeInFile(header.m_texturesOffset, static_cast<uint64_t>(header.m_numTextures) * sizeof(SceneTextureRecord))
+		|| !IsRangeInFile(header.m_entitiesOffset, static_cast<uint64_t>(header.m_numEntities) * sizeof(SceneEntityRecord))
+		|| !IsRangeInFile(header.m_blobOffset, header.m_blobSize)
+		|| !IsRangeInFile(header.m_stringsOffset, header.m_stringsSize))
+	{
+		out_error = "scene section lies outside the file";
+		return false;
+	}
+
+	SceneMeshRecord const* meshes = static_cast<SceneMeshRecord const*>(GetBytesAt(header.m_meshesOffset));
+	for (uint32_t meshIndex = 0; meshIndex < header.m_numMeshes; ++meshIndex)
+	{
+		SceneMeshRecord const& mesh = meshes[meshIndex];
+		bool hasShortIndexes = mesh.m_indexFormat == static_cast<uint32_t>(MeshIndexFormat::UINT16);
+		size_t indexSize = hasShortIndexes ? sizeof(uint16_t) : sizeof(uint32_t);
+		if (mesh.m_shape >= static_cast<uint32_t>(MeshShape::COUNT)
+			|| (!hasShortIndexes && mesh.m_indexFormat != static_cast<uint32_t>(MeshIndexFormat::UINT32))
+			|| !IsRangeInFile(mesh.m_vertexesOffset, static_cast<uint64_t>(mesh.m_numVertexes) * sizeof(Vertex_PCU))
+			|| !IsRangeInFile(mesh.m_indexesOffset, static_cast<uint64_t>(mesh.m_numIndexes) * indexSize))
+		{
+			out_error = Stringf("mesh %u is invalid", meshIndex);
+			return false;
+		}
+		void const* indexes = GetBytesAt(mesh.m_indexesOffset);
+		for (uint32_t indexIndex = 0; indexIndex < mesh.m_numIndexes; ++indexIndex)
+		{
+			uint32_t index = hasShortIndexes ? static_cast<uint16_t const*>(indexes)[indexIndex] : static_cast<uint32_t const*>(indexes)[indexIndex];
+			if (index >= mesh.m_numVertexes)
+			{
+				out_error = Stringf("mesh %u has an index past its vertexes", meshIndex);
+				return false;
+			}
+		}
+	}
+
+	SceneTextureRecord const* textures = static_cast<SceneTextureRecord const*>(GetBytesAt(header.m_texturesOffset));
+	for (uint32_t textureIndex = 0; textureIndex < header.m_numTextures; ++textureIndex)
+	{
+		SceneTextureRecord const& texture = textures[textureIndex];
+		uint64_t pathEnd = static_cast<uint64_t>(texture.m_pathOffset) + texture.m_pathLength;
+		if (pathEnd >= fileSize || static_cast<char const*>(GetBytesAt(texture.m_pathOffset))[texture.m_pathLength] != '\0')
+		{
+			out_error = Stringf("texture %u path is invalid", textureIndex);
+			return false;
+		}
+	}
+
+	SceneEntityRecord const* entities = GetEntities();
+	for (uint32_t entityIndex = 0; entityIndex < header.m_numEntities; ++entityIndex)
+	{
+		SceneEntityRecord const& entity = entities[entityIndex];
+		if (entity.m_meshIndex >= header.m_numMeshes || entity.m_textureIndex >= static_cast<int32_t>(header.m_numTextures) || entity.m_textureIndex < -1)
+		{
+			out_error = Stringf("entity %u references a missing mesh or texture", entityIndex);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool ParseFloatList(std::string const& text, float* out_values, int numValues)
+{
+	Strings parts = SplitStringOnDelimiter(text, ',');
+	if (static_cast<int>(parts.size()) != numValues)
+	{
+		return false;
+	}
+	for (int valueIndex = 0; valueIndex < numValues; ++valueIndex)
+	{
+		out_values[valueIndex] = static_cast<float>(atof(parts[valueIndex].c_str()));
+	}
+	return true;
+}
+
+static uint32_t GetIndexSize(MeshIndexFormat indexFormat)
+{
+	return indexFormat == MeshIndexFormat::UINT16 ? static_cast<uint32_t>(sizeof(uint16_t)) : static_cast<uint32_t>(sizeof(uint32_t));
+}
+
+static void AppendBytes(std::vector<unsigned char>& buffer, void const* data, size_t numBytes)
+{
+	unsigned char const* bytes = static_cast<unsigned char const*>(data);
+	buffer.insert(buffer.end(), bytes, bytes + numBytes);
+}
+
+bool SceneFile::ConvertTextToBinary(std::string const& textFilePath, std::string const& binaryFilePath, std::string& out_error)
+{
+	// Text format, one prop per line:
+	//   prop <cube|sphere|cylinder|arrow> <x> <y> <z> [orientation=yaw,pitch,roll] [spin=yaw,pitch,roll] [color=r,g,b,a] [texture=path] [pulse] [occluder]
+	std::ifstream textFile(textFilePath);
+	if (!textFile.is_open())
+	{
+		out_error = Stringf("could not open \"%s\"", textFilePath.c_str());
+		return false;
+	}
+
+	MeshCache meshCache;
+	std::vector<MeshKey> meshKeys;
+	std::vector<int> meshIDs;
+	std::vector<std::string> texturePaths;
+	std::vector<SceneEntityRecord> entities;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(textFile, line))
+	{
+		++lineNumber;
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		Strings tokens;
+		Strings splitLine = SplitStringOnDelimiter(line, ' ');
+		for (size_t tokenIndex = 0; tokenIndex < splitLine.size(); ++tokenIndex)
+		{
+			if (!splitLine[tokenIndex].empty())
+			{
+				tokens.push_back(splitLine[tokenIndex]);
+			}
+		}
+		if (tokens.empty() || tokens[0][0] == '#')
+		{
+			continue;
+		}
+		if (tokens[0] != "prop" || tokens.size() < 5)
+		{
+			out_error = Stringf("line %d: expected \"prop <shape> <x> <y> <z>\"", lineNumber);
+			return false;
+		}
+
+		MeshKey meshKey;
+		if (tokens[1] == "cube")
+		{
+			meshKey = MeshKey::MakeFullDetail(MeshShape::CUBE);
+		}
+		else if (tokens[1] == "sphere")
+		{
+			meshKey = MeshKey::MakeFullDetail(MeshShape::SPHERE);
+		}
+		else if (tokens[1] == "cylinder")
+		{
+			meshKey = MeshKey::MakeFullDetail(MeshShape::CYLINDER);
+		}
+		else if (tokens[1] == "arrow")
+		{
+			meshKey = MeshKey::MakeFullDetail(MeshShape::ARROW);
+		}
+		else
+		{
+			out_error = Stringf("line %d: unknown shape \"%s\"", lineNumber, tokens[1].c_str());
+			return false;
+		}
+
+		// Only the full-detail meshes are baked; the cache also builds their coarser levels, so its mesh IDs are not the file's mesh indexes
+		SceneEntityRecord entity;
+		size_t meshIndex = 0;
+		while (meshIndex < meshKeys.size() && !(meshKeys[meshIndex] == meshKey))
+		{
+			++meshIndex;
+		}
+		if (meshIndex == meshKeys.size())
+		{
+			meshKeys.push_back(meshKey);
+			meshIDs.push_back(meshCache.CreateOrGetMeshID(meshKey));
+		}
+		entity.m_meshIndex = static_cast<uint32_t>(meshIndex);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			entity.m_position[axis] = static_cast<float>(atof(tokens[2 + axis].c_str()));
+		}
+
+		for (size_t tokenIndex = 5; tokenIndex < tokens.size(); ++tokenIndex)
+		{
+			Strings keyAndValue = SplitStringOnDelimiter(tokens[tokenIndex], '=');
+			std::string const& key = keyAndValue[0];
+			std::string value = keyAndValue.size() > 1 ? keyAndValue[1] : "";
+			bool isValid = true;
+			if (key == "orientation")
+			{
+				isValid = ParseFloatList(value, entity.m_orientationDegrees, 3);
+			}
+			else if (key == "spin")
+			{
+				isValid = ParseFloatList(value, entity.m_angularVelocityDegrees, 3);
+			}
+			else if (key == "color")
+			{
+				float color[4] = {};
+				isValid = ParseFloatList(value, color, 4);
+				for (int channel = 0; channel < 4; ++channel)
+				{
+					entity.m_color[channel] = static_cast<uint8_t>(color[channel]);
+				}
+			}
+			else if (key == "texture" && !value.empty())
+			{
+				size_t textureIndex = 0;
+				while (textureIndex < texturePaths.size() && texturePaths[textureIndex] != value)
+				{
+					++textureIndex;
+				}
+				if (textureIndex == texturePaths.size())
+				{
+					texturePaths.push_back(value);
+				}
+				entity.m_textureIndex = static_cast<int32_t>(textureIndex);
+			}
+			else if (key == "pulse")
+			{
+				entity.m_flags |= SCENE_ENTITY_FLAG_PULSE_COLOR;
+			}
+			else if (key == "occluder")
+			{
+				entity.m_flags |= SCENE_ENTITY_FLAG_OCCLUDER;
+			}
+			else
+			{
+				isValid = false;
+			}
+
+			if (!isValid)
+			{
+				out_error = Stringf("line %d: bad option \"%s\"", lineNumber, tokens[tokenIndex].c_str());
+				return false;
+			}
+		}
+		entities.push_back(entity);
+	}
+
+	// Lay out the sections first so every record can be written with its final offsets
+	SceneFileHeader header;
+	header.m_numMeshes = static_cast<uint32_t>(meshKeys.size());
+	header.m_numTextures = static_cast<uint32_t>(texturePaths.size());
+	header.m_numEntities = static_cast<uint32_t>(entities.size());
+	header.m_meshesOffset = static_cast<uint32_t>(sizeof(SceneFileHeader));
+	header.m_texturesOffset = header.m_meshesOffset + header.m_numMeshes * static_cast<uint32_t>(sizeof(SceneMeshRecord));
+	header.m_entitiesOffset = header.m_texturesOffset + header.m_numTextures * static_cast<uint32_t>(sizeof(SceneTextureRecord));
+	header.m_blobOffset = header.m_entitiesOffset + header.m_numEntities * static_cast<uint32_t>(sizeof(SceneEntityRecord));
+
+	std::vector<SceneMeshRecord> meshRecords(meshKeys.size());
+	uint32_t blobCursor = header.m_blobOffset;
+	for (size_t meshIndex = 0; meshIndex < meshKeys.size(); ++meshIndex)
+	{
+		Mesh const& mesh = meshCache.GetMesh(meshIDs[meshIndex]);
+		SceneMeshRecord& meshRecord = meshRecords[meshIndex];
+		meshRecord.m_shape = static_cast<uint32_t>(meshKeys[meshIndex].m_shape);
+		meshRecord.m_numSlices = meshKeys[meshIndex].m_numSlices;
+		meshRecord.m_numStacks = meshKeys[meshIndex].m_numStacks;
+		meshRecord.m_vertexesOffset = blobCursor;
+		meshRecord.m_numVertexes = static_cast<uint32_t>(mesh.m_numVertexes);
+		blobCursor += meshRecord.m_numVertexes * static_cast<uint32_t>(sizeof(Vertex_PCU));
+		meshRecord.m_indexesOffset = blobCursor;
+		meshRecord.m_numIndexes = static_cast<uint32_t>(mesh.m_numIndexes);
+		meshRecord.m_indexFormat = static_cast<uint32_t>(mesh.m_indexFormat);
+		blobCursor += meshRecord.m_numIndexes * GetIndexSize(mesh.m_indexFormat);
+
+		// 16-bit index lists can end mid-word; the next mesh's vertexes start aligned
+		blobCursor = (blobCursor + 3) & ~3u;
+	}
+	header.m_blobSize = blobCursor - header.m_blobOffset;
+	header.m_stringsOffset = blobCursor;
+
+	std::vector<SceneTextureRecord> textureRecords(texturePaths.size());
+	uint32_t stringsCursor = header.m_stringsOffset;
+	for (size_t textureIndex = 0; textureIndex < texturePaths.size(); ++textureIndex)
+	{
+		textureRecords[textureIndex].m_pathOffset = stringsCursor;
+		textureRecords[textureIndex].m_pathLength = static_cast<uint32_t>(texturePaths[textureIndex].size());
+		stringsCursor += textureRecords[textureIndex].m_pathLength + 1;
+	}
+	header.m_stringsSize = stringsCursor - header.m_stringsOffset;
+
+	// Keep the file size a multiple of four so another file can be appended to it aligned
+	uint32_t paddedFileSize = (stringsCursor + 3) & ~3u;
+	header.m_fileSize = paddedFileSize;
+
+	std::vector<unsigned char> fileBytes;
+	fileBytes.reserve(paddedFileSize);
+	AppendBytes(fileBytes, &header, sizeof(header));
+	AppendBytes(fileBytes, meshRecords.data(), meshRecords.size() * sizeof(SceneMeshRecord));
+	AppendBytes(fileBytes, textureRecords.data(), textureRecords.size() * sizeof(SceneTextureRecord));
+	AppendBytes(fileBytes, entities.data(), entities.size() * sizeof(SceneEntityRecord));
+	for (size_t meshIndex = 0; meshIndex < meshKeys.size(); ++meshIndex)
+	{
+		Mesh const& mesh = meshCache.GetMesh(meshIDs[meshIndex]);
+		AppendBytes(fileBytes, mesh.m_vertexes, mesh.m_numVertexes * sizeof(Vertex_PCU));
+		AppendBytes(fileBytes, mesh.m_indexes, mesh.m_numIndexes * GetIndexSize(mesh.m_indexFormat));
+		fileBytes.resize((fileBytes.size() + 3) & ~static_cast<size_t>(3), 0);
+	}
+	for (size_t textureIndex = 0; textureIndex < texturePaths.size(); ++textureIndex)
+	{
+		AppendBytes(fileBytes, texturePaths[textureIndex].c_str(), texturePaths[textureIndex].size() + 1);
+	}
+	fileBytes.resize(paddedFileSize, 0);
+
+	std::ofstream binaryFile(binaryFilePath, std::ios::binary);
+	if (!binaryFile.is_open())
+	{
+		out_error = Stringf("could not write \"%s\"", binaryFilePath.c_str());
+		return false;
+	}
+	binaryFile.write(reinterpret_cast<char const*>(fileBytes.data()), static_cast<std::streamsize>(fileBytes.size()));
+	return binaryFile.good();
+}
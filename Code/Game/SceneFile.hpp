@@ -0,0 +1,88 @@
+#pragma once
+#include "Game/MappedFile.hpp"
+#include <stdint.h>
+#include <string>
+// -----------------------------------------------------------------------------
+class MeshCache;
+// -----------------------------------------------------------------------------
+constexpr uint32_t SCENE_FILE_MAGIC = 0x53334750;	// "PG3S"
+constexpr uint32_t SCENE_FILE_VERSION = 1;
+constexpr uint32_t SCENE_ENTITY_FLAG_PULSE_COLOR = 1 << 0;
+constexpr uint32_t SCENE_ENTITY_FLAG_OCCLUDER = 1 << 1;
+// -----------------------------------------------------------------------------
+// On-disk layout. Every record is plain 4-byte-aligned data and every offset is
+// from the start of the file, so a mapped file is used in place with no parsing.
+//
+// | header | mesh records | texture records | entity records | vertex/index blob | path strings |
+// -----------------------------------------------------------------------------
+struct SceneFileHeader
+{
+	uint32_t m_magic = SCENE_FILE_MAGIC;
+	uint32_t m_version = SCENE_FILE_VERSION;
+	uint32_t m_fileSize = 0;
+	uint32_t m_numMeshes = 0;
+	uint32_t m_meshesOffset = 0;
+	uint32_t m_numTextures = 0;
+	uint32_t m_texturesOffset = 0;
+	uint32_t m_numEntities = 0;
+	uint32_t m_entitiesOffset = 0;
+	uint32_t m_blobOffset = 0;
+	uint32_t m_blobSize = 0;
+	uint32_t m_stringsOffset = 0;
+	uint32_t m_stringsSize = 0;
+};
+// -----------------------------------------------------------------------------
+struct SceneMeshRecord
+{
+	uint32_t m_shape = 0;			// MeshShape, the key the mesh is cached under
+	int32_t  m_numSlices = 0;
+	int32_t  m_numStacks = 0;
+	uint32_t m_vertexesOffset = 0;	// Vertex_PCU array, already deduplicated and cache-ordered
+	uint32_t m_numVertexes = 0;
+	uint32_t m_indexesOffset = 0;	// Triangle list of uint16_t or uint32_t, per m_indexFormat
+	uint32_t m_numIndexes = 0;
+	uint32_t m_indexFormat = 0;		// MeshIndexFormat
+};
+// -----------------------------------------------------------------------------
+struct SceneTextureRecord
+{
+	uint32_t m_pathOffset = 0;		// Null-terminated
+	uint32_t m_pathLength = 0;
+};
+// -----------------------------------------------------------------------------
+struct SceneEntityRecord
+{
+	float    m_position[3] = {};
+	float    m_orientationDegrees[3] = {};		// Yaw, pitch, roll
+	float    m_angularVelocityDegrees[3] = {};	// Yaw, pitch, roll per second
+	uint8_t  m_color[4] = { 255, 255, 255, 255 };
+	uint32_t m_meshIndex = 0;
+	int32_t  m_textureIndex = -1;
+	uint32_t m_flags = 0;
+};
+// -----------------------------------------------------------------------------
+// A validated view over a memory-mapped scene file
+// -----------------------------------------------------------------------------
+class SceneFile
+{
+public:
+	bool Open(std::string const& filePath, std::string& out_error);
+	void Close();
+
+	int GetNumMeshes() const;
+	int GetNumTextures() const;
+	int GetNumEntities() const;
+	SceneMeshRecord const& GetMesh(int meshIndex) const;
+	SceneEntityRecord const* GetEntities() const;
+	char const* GetTexturePath(int textureIndex) const;
+	void const* GetBytesAt(uint32_t offset) const;
+
+	static bool ConvertTextToBinary(std::string const& textFilePath, std::string const& binaryFilePath, std::string& out_error);
+
+private:
+	bool Validate(std::string& out_error) const;
+
+private:
+	MappedFile m_mappedFile;
+	SceneFileHeader const* m_header = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,435 @@
+#include "Game/SpatialGrid.hpp"
+#include "Game/FrameArena.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Core/EngineCommon.h"
+#include <math.h>
+
+SpatialGrid::SpatialGrid()
+{
+}
+
+SpatialGrid::~SpatialGrid()
+{
+}
+
+void SpatialGrid::Initialize(Vec2 const& worldMins, Vec2 const& worldMaxs, float cellSize)
+{
+	GUARANTEE_OR_DIE(cellSize > 0.f, "SpatialGrid::Initialize requires a positive cell size");
+
+	m_worldMins = worldMins;
+	m_cellSize = cellSize;
+	m_numCellsX = static_cast<int>(ceilf((worldMaxs.x - worldMins.x) / cellSize));
+	m_numCellsY = static_cast<int>(ceilf((worldMaxs.y - worldMins.y) / cellSize));
+	if (m_numCellsX < 1)
+	{
+		m_numCellsX = 1;
+	}
+	if (m_numCellsY < 1)
+	{
+		m_numCellsY = 1;
+	}
+
+	Clear();
+	m_cells.resize(static_cast<size_t>(m_numCellsX * m_numCellsY));
+}
+
+void SpatialGrid::Clear()
+{
+	for (size_t cellIndex = 0; cellIndex < m_cells.size(); ++cellIndex)
+	{
+		m_cells[cellIndex].clear();
+	}
+	m_slotCells.clear();
+	m_slotHandles.clear();
+	m_slotQueryStamps.clear();
+	m_maxBoundingRadius = 0.f;
+}
+
+void SpatialGrid::Update(EntityStore const& entities)
+{
+	size_t numSlots = static_cast<size_t>(entities.GetNumSlots());
+	if (m_slotCells.size() < numSlots)
+	{
+		m_slotCells.resize(numSlots, -1);
+		m_slotHandles.resize(numSlots);
+		m_slotQueryStamps.resize(numSlots, 0);
+	}
+
+	// Only entities whose center crossed into a different cell are moved
+	m_maxBoundingRadius = 0.f;
+	int numEntities = entities.GetNumEntities();
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex)
+	{
+		m_maxBoundingRadius = fmaxf(m_maxBoundingRadius, entities.m_boundingRadii[entityIndex]);
+
+		EntityHandle handle = entities.GetHandle(entityIndex);
+		int newCell = GetCellIndex(GetCellX(entities.m_boundsCentersX[entityIndex]), GetCellY(entities.m_boundsCentersY[entityIndex]));
+		int oldCell = m_slotCells[handle.m_slot];
+		if (oldCell == newCell && m_slotHandles[handle.m_slot].m_generation == handle.m_generation)
+		{
+			continue;
+		}
+
+		// Either the entity moved cells, or its slot was recycled and still holds the previous owner
+		if (oldCell != -1)
+		{
+			Remove(m_slotHandles[handle.m_slot]);
+		}
+		m_cells[newCell].push_back(handle);
+		m_slotCells[handle.m_slot] = newCell;
+		m_slotHandles[handle.m_slot] = handle;
+	}
+}
+
+void SpatialGrid::Remove(EntityHandle handle)
+{
+	if (handle.m_slot >= m_slotCells.size() || m_slotCells[handle.m_slot] == -1 || m_slotHandles[handle.m_slot].m_generation != handle.m_generation)
+	{
+		return;
+	}
+
+	std::vector<EntityHandle>& cell = m_cells[m_slotCells[handle.m_slot]];
+	for (size_t cellEntry = 0; cellEntry < cell.size(); ++cellEntry)
+	{
+		if (cell[cellEntry].m_slot == handle.m_slot)
+		{
+			cell[cellEntry] = cell.back();
+			cell.pop_back();
+			break;
+		}
+	}
+	m_slotCells[handle.m_slot] = -1;
+}
+
+EntityRaycastResult SpatialGrid::Raycast(EntityStore const& entities, Vec3 const& start, Vec3 const& forwardNormal, float maxDist) const
+{
+	EntityRaycastResult bestResult;
+	bestResult.m_impactDist = maxDist;
+	if (!BeginQuery())
+	{
+		return bestResult;
+	}
+
+	int cellMargin = GetLooseCellMargin();
+
+	// Rays starting off the grid are rare; just test every cell
+	float relativeX = start.x - m_worldMins.x;
+	float relativeY = start.y - m_worldMins.y;
+	bool isStartInGrid = relativeX >= 0.f && relativeY >= 0.f && relativeX < m_cellSize * m_numCellsX && relativeY < m_cellSize * m_numCellsY;
+	if (!isStartInGrid)
+	{
+		int halfExtent = (m_numCellsX > m_numCellsY ? m_numCellsX : m_numCellsY);
+		TestCellsForRaycast(entities, 0, 0, halfExtent, start, forwardNormal, maxDist, bestResult);
+		return bestResult;
+	}
+
+	// Walk the cells the ray crosses in the XY plane, nearest first (Amanatides & Woo)
+	int cellX = GetCellX(start.x);
+	int cellY = GetCellY(start.y);
+	int stepX = forwardNormal.x >= 0.f ? 1 : -1;
+	int stepY = forwardNormal.y >= 0.f ? 1 : -1;
+
+	constexpr float NO_CROSSING = 1e30f;
+	float cellMinX = m_worldMins.x + m_cellSize * static_cast<float>(cellX);
+	float cellMinY = m_worldMins.y + m_cellSize * static_cast<float>(cellY);
+	float distToNextX = NO_CROSSING;
+	float distToNextY = NO_CROSSING;
+	float distPerCellX = NO_CROSSING;
+	float distPerCellY = NO_CROSSING;
+	if (forwardNormal.x != 0.f)
+	{
+		float boundaryX = stepX > 0 ? cellMinX + m_cellSize : cellMinX;
+		distToNextX = (boundaryX - start.x) / forwardNormal.x;
+		distPerCellX = m_cellSize / fabsf(forwardNormal.x);
+	}
+	if (forwardNormal.y != 0.f)
+	{
+		float boundaryY = stepY > 0 ? cellMinY + m_cellSize : cellMinY;
+		distToNextY = (boundaryY - start.y) / forwardNormal.y;
+		distPerCellY = m_cellSize / fabsf(forwardNormal.y);
+	}
+
+	for (;;)
+	{
+		TestCellsForRaycast(entities, cellX, cellY, cellMargin, start, forwardNormal, maxDist, bestResult);
+
+		// Any hit beyond this point would lie in a cell we have not reached yet, so a closer hit ends the walk
+		float distToNextCell = distToNextX < distToNextY ? distToNextX : distToNextY;
+		if (distToNextCell > maxDist || (bestResult.m_didImpact && distToNextCell > bestResult.m_impactDist))
+		{
+			break;
+		}
+
+		if (distToNextX < distToNextY)
+		{
+			cellX += stepX;
+			distToNextX += distPerCellX;
+		}
+		else
+		{
+			cellY += stepY;
+			distToNextY += distPerCellY;
+		}
+
+		if (cellX < 0 || cellY < 0 || cellX >= m_numCellsX || cellY >= m_numCellsY)
+		{
+			break;
+		}
+	}
+
+	return bestResult;
+}
+
+void SpatialGrid::FindOverlappingSphere(EntityStore const& entities, Vec3 const& center, float radius, std::vector<EntityHandle>& out_entities) const
+{
+	if (!BeginQuery())
+	{
+		return;
+	}
+
+	float reach = radius + m_maxBoundingRadius;
+	int minCellX = GetCellX(center.x - reach);
+	int maxCellX = GetCellX(center.x + reach);
+	int minCellY = GetCellY(center.y - reach);
+	int maxCellY = GetCellY(center.y + reach);
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY)
+	{
+		for (int cellX = minCellX; cellX <= maxCellX; ++cellX)
+		{
+			std::vector<EntityHandle> const& cell = m_cells[GetCellIndex(cellX, cellY)];
+			for (size_t cellEntry = 0; cellEntry < cell.size(); ++cellEntry)
+			{
+				EntityHandle handle = cell[cellEntry];
+				if (!entities.IsAlive(handle))
+				{
+					continue;
+				}
+
+				int entityIndex = entities.GetIndex(handle);
+				Vec3 entityCenter(entities.m_boundsCentersX[entityIndex], entities.m_boundsCentersY[entityIndex], entities.m_boundsCentersZ[entityIndex]);
+				float combinedRadius = radius + entities.m_boundingRadii[entityIndex];
+				if ((entityCenter - center).GetLengthSquared() < combinedRadius * combinedRadius)
+				{
+					out_entities.push_back(handle);
+				}
+			}
+		}
+	}
+}
+
+void SpatialGrid::FindOverlappingAABB(EntityStore const& entities, AABB3 const& bounds, std::vector<EntityHandle>& out_entities) const
+{
+	if (!BeginQuery())
+	{
+		return;
+	}
+
+	int minCellX = GetCellX(bounds.m_mins.x - m_maxBoundingRadius);
+	int maxCellX = GetCellX(bounds.m_maxs.x + m_maxBoundingRadius);
+	int minCellY = GetCellY(bounds.m_mins.y - m_maxBoundingRadius);
+	int maxCellY = GetCellY(bounds.m_maxs.y + m_maxBoundingRadius);
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY)
+	{
+		for (int cellX = minCellX; cellX <= maxCellX; ++cellX)
+		{
+			std::vector<EntityHandle> const& cell = m_cells[GetCellIndex(cellX, cellY)];
+			for (size_t cellEntry = 0; cellEntry < cell.size(); ++cellEntry)
+			{
+				EntityHandle handle = cell[cellEntry];
+				if (!entities.IsAlive(handle))
+				{
+					continue;
+				}
+
+				int entityIndex = entities.GetIndex(handle);
+				Vec3 entityCenter(entities.m_boundsCentersX[entityIndex], entities.m_boundsCentersY[entityIndex], entities.m_boundsCentersZ[entityIndex]);
+				Vec3 nearestPoint(GetClamped(entityCenter.x, bounds.m_mins.x, bounds.m_maxs.x), GetClamped(entityCenter.y, bounds.m_mins.y, bounds.m_maxs.y),
+					GetClamped(entityCenter.z, bounds.m_mins.z, bounds.m_maxs.z));
+				float entityRadius = entities.m_boundingRadii[entityIndex];
+				if ((entityCenter - nearestPoint).GetLengthSquared() < entityRadius * entityRadius)
+				{
+					out_entities.push_back(handle);
+				}
+			}
+		}
+	}
+}
+
+void SpatialGrid::FindNearest(EntityStore const& entities, Vec3 const& point, int numNearest, std::vector<EntityHandle>& out_entities) const
+{
+	if (numNearest <= 0 || m_cells.empty())
+	{
+		return;
+	}
+
+	// Sorted nearest-first by distance to the entity center, scratch space only needed for this query
+	FrameVector<float> nearestDistancesSquared;
+	FrameVector<EntityHandle> nearestEntities;
+	nearestDistancesSquared.reserve(static_cast<size_t>(numNearest) + 1);
+	nearestEntities.reserve(static_cast<size_t>(numNearest) + 1);
+
+	// Entities are binned by center, so a ring of cells r steps out is at least (r - 1) cells away
+	float relativeX = point.x - m_worldMins.x;
+	float relativeY = point.y - m_worldMins.y;
+	bool isPointInGrid = relativeX >= 0.f && relativeY >= 0.f && relativeX < m_cellSize * m_numCellsX && relativeY < m_cellSize * m_numCellsY;
+	int centerCellX = GetCellX(point.x);
+	int centerCellY = GetCellY(point.y);
+	int maxRing = m_numCellsX > m_numCellsY ? m_numCellsX : m_numCellsY;
+	for (int ring = 0; ring <= maxRing; ++ring)
+	{
+		if (isPointInGrid && static_cast<int>(nearestEntities.size()) == numNearest)
+		{
+			float ringMinDist = m_cellSize * static_cast<float>(ring - 1);
+			if (ringMinDist > 0.f && ringMinDist * ringMinDist > nearestDistancesSquared.back())
+			{
+				break;
+			}
+		}
+
+		for (int cellY = centerCellY - ring; cellY <= centerCellY + ring; ++cellY)
+		{
+			if (cellY < 0 || cellY >= m_numCellsY)
+			{
+				continue;
+			}
+
+			bool isEdgeRow = cellY == centerCellY - ring || cellY == centerCellY + ring;
+			int cellXStep = isEdgeRow || ring == 0 ? 1 : 2 * ring;
+			for (int cellX = centerCellX - ring; cellX <= centerCellX + ring; cellX += cellXStep)
+			{
+				if (cellX < 0 || cellX >= m_numCellsX)
+				{
+					continue;
+				}
+
+				std::vector<EntityHandle> const& cell = m_cells[GetCellIndex(cellX, cellY)];
+				for (size_t cellEntry = 0; cellEntry < cell.size(); ++cellEntry)
+				{
+					EntityHandle handle = cell[cellEntry];
+					if (!entities.IsAlive(handle))
+					{
+						continue;
+					}
+
+					int entityIndex = entities.GetIndex(handle);
+					Vec3 entityCenter(entities.m_boundsCentersX[entityIndex], entities.m_boundsCentersY[entityIndex], entities.m_boundsCentersZ[entityIndex]);
+					float distSquared = (entityCenter - point).GetLengthSquared();
+					if (static_cast<int>(nearestEntities.size()) == numNearest && distSquared >= nearestDistancesSquared.back())
+					{
+						continue;
+					}
+
+					size_t insertIndex = nearestDistancesSquared.size();
+					while (insertIndex > 0 && nearestDistancesSquared[insertIndex - 1] > distSquared)
+					{
+						--insertIndex;
+					}
+					nearestDistancesSquared.insert(nearestDistancesSquared.begin() + insertIndex, distSquared);
+					nearestEntities.insert(nearestEntities.begin() + insertIndex, handle);
+					if (static_cast<int>(nearestEntities.size()) > numNearest)
+					{
+						nearestDistancesSquared.pop_back();
+						nearestEntities.pop_back();
+					}
+				}
+			}
+		}
+	}
+
+	out_entities.insert(out_entities.end(), nearestEntities.begin(), nearestEntities.end());
+}
+
+int SpatialGrid::GetCellX(float worldX) const
+{
+	int cellX = static_cast<int>(floorf((worldX - m_worldMins.x) / m_cellSize));
+	return GetClamped(cellX, 0, m_numCellsX - 1);
+}
+
+int SpatialGrid::GetCellY(float worldY) const
+{
+	int cellY = static_cast<int>(floorf((worldY - m_worldMins.y) / m_cellSize));
+	return GetClamped(cellY, 0, m_numCellsY - 1);
+}
+
+int SpatialGrid::GetCellIndex(int cellX, int cellY) const
+{
+	return cellY * m_numCellsX + cellX;
+}
+
+int SpatialGrid::GetLooseCellMargin() const
+{
+	return static_cast<int>(ceilf(m_maxBoundingRadius / m_cellSize));
+}
+
+void SpatialGrid::TestCellsForRaycast(EntityStore const& entities, int centerCellX, int centerCellY, int cellMargin, Vec3 const& start, Vec3 const& forwardNormal, float maxDist, EntityRaycastResult& bestResult) const
+{
+	int minCellX = GetClamped(centerCellX - cellMargin, 0, m_numCellsX - 1);
+	int maxCellX = GetClamped(centerCellX + cellMargin, 0, m_numCellsX - 1);
+	int minCellY = GetClamped(centerCellY - cellMargin, 0, m_numCellsY - 1);
+	int maxCellY = GetClamped(centerCellY + cellMargin, 0, m_numCellsY - 1);
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY)
+	{
+		for (int cellX = minCellX; cellX <= maxCellX; ++cellX)
+		{
+			std::vector<EntityHandle> const& cell = m_cells[GetCellIndex(cellX, cellY)];
+			for (size_t cellEntry = 0; cellEntry < cell.size(); ++cellEntry)
+			{
+				EntityHandle handle = cell[cellEntry];
+				if (!entities.IsAlive(handle) || m_slotQueryStamps[handle.m_slot] == m_queryStamp)
+				{
+					continue;
+				}
+				m_slotQueryStamps[handle.m_slot] = m_queryStamp;
+
+				// Ray vs bounding sphere
+				int entityIndex = entities.GetIndex(handle);
+				Vec3 entityCenter(entities.m_boundsCentersX[entityIndex], entities.m_boundsCentersY[entityIndex], entities.m_boundsCentersZ[entityIndex]);
+				float radius = entities.m_boundingRadii[entityIndex];
+				Vec3 startToCenter = entityCenter - start;
+				float startToCenterLengthSquared = startToCenter.GetLengthSquared();
+				float impactDist = 0.f;
+				if (startToCenterLengthSquared > radius * radius)
+				{
+					float projectedDist = DotProduct3D(startToCenter, forwardNormal);
+					float missDistSquared = startToCenterLengthSquared - projectedDist * projectedDist;
+					if (projectedDist < 0.f || missDistSquared > radius * radius)
+					{
+						continue;
+					}
+					impactDist = projectedDist - sqrtf(radius * radius - missDistSquared);
+				}
+
+				if (impactDist > maxDist || (bestResult.m_didImpact && impactDist >= bestResult.m_impactDist))
+				{
+					continue;
+				}
+
+				bestResult.m_didImpact = true;
+				bestResult.m_impactDist = impactDist;
+				bestResult.m_impactPos = start + forwardNormal * impactDist;
+				bestResult.m_impactNormal = impactDist > 0.f ? (bestResult.m_impactPos - entityCenter).GetNormalized() : forwardNormal * -1.f;
+				bestResult.m_entity = handle;
+			}
+		}
+	}
+}
+
+bool SpatialGrid::BeginQuery() const
+{
+	if (m_cells.empty())
+	{
+		return false;
+	}
+
+	++m_queryStamp;
+	if (m_queryStamp == 0)
+	{
+		// Stamp wrapped around; old stamps could now collide
+		for (size_t slot = 0; slot < m_slotQueryStamps.size(); ++slot)
+		{
+			m_slotQueryStamps[slot] = 0;
+		}
+		m_queryStamp = 1;
+	}
+	return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Game/EntityStore.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/AABB3.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+struct EntityRaycastResult
+{
+	bool m_didImpact = false;
+	float m_impactDist = 0.f;
+	Vec3 m_impactPos;
+	Vec3 m_impactNormal;
+	EntityHandle m_entity;
+};
+// -----------------------------------------------------------------------------
+// Loose uniform grid over the XY plane. Each entity lives in the single cell that
+// contains its bounding sphere center; queries widen their cell range by the
+// largest bounding radius so spheres that spill into neighbouring cells are
+// still found. Entities outside the grid bounds are clamped into the edge cells.
+// -----------------------------------------------------------------------------
+class SpatialGrid
+{
+public:
+	SpatialGrid();
+	~SpatialGrid();
+
+	void Initialize(Vec2 const& worldMins, Vec2 const& worldMaxs, float cellSize);
+	void Clear();
+	void Update(EntityStore const& entities);
+	void Remove(EntityHandle handle);
+
+	EntityRaycastResult Raycast(EntityStore const& entities, Vec3 const& start, Vec3 const& forwardNormal, float maxDist) const;
+	void FindOverlappingSphere(EntityStore const& entities, Vec3 const& center, float radius, std::vector<EntityHandle>& out_entities) const;
+	void FindOverlappingAABB(EntityStore const& entities, AABB3 const& bounds, std::vector<EntityHandle>& out_entities) const;
+	void FindNearest(EntityStore const& entities, Vec3 const& point, int numNearest, std::vector<EntityHandle>& out_entities) const;
+
+private:
+	int  GetCellX(float worldX) const;
+	int  GetCellY(float worldY) const;
+	int  GetCellIndex(int cellX, int cellY) const;
+	int  GetLooseCellMargin() const;
+	void TestCellsForRaycast(EntityStore const& entities, int centerCellX, int centerCellY, int cellMargin, Vec3 const& start, Vec3 const& forwardNormal, float maxDist, EntityRaycastResult& bestResult) const;
+	bool BeginQuery() const;
+
+private:
+	Vec2 m_worldMins;
+	float m_cellSize = 1.f;
+	int m_numCellsX = 0;
+	int m_numCellsY = 0;
+	float m_maxBoundingRadius = 0.f;
+
+	std::vector<std::vector<EntityHandle>> m_cells;
+	std::vector<int> m_slotCells;
+	std::vector<EntityHandle> m_slotHandles;
+
+	// Per-slot stamps so an entity reached from several cells is only tested once per query
+	mutable std::vector<unsigned int> m_slotQueryStamps;
+	mutable unsigned int m_queryStamp = 0;
+};
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "Game/StaticGrid.hpp"
+#include "Game/GameCommon.h"
+#include "Game/Frustum.hpp"
+#include "Game/RenderStateTracker.hpp"
+#include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <math.h>
+
+// Corner c of a box has x from bit 0, y from bit 1 and z from bit 2; each face is bottom-left, bottom-right, top-right, top-left seen from outside
+static const int BOX_FACE_CORNERS[6][4] =
+{
+	{ 1, 3, 7, 5 },	// +X
+	{ 2, 0, 4, 6 },	// -X
+	{ 3, 2, 6, 7 },	// +Y
+	{ 0, 1, 5, 4 },	// -Y
+	{ 4, 5, 7, 6 },	// +Z
+	{ 2, 3, 1, 0 },	// -Z
+};
+
+StaticGrid::StaticGrid()
+{
+}
+
+StaticGrid::~StaticGrid()
+{
+	Release();
+}
+
+void StaticGrid::Initialize(Vec2 const& mins, Vec2 const& maxs, int numTilesX, int numTilesY)
+{
+	Release();
+	m_vertexes.clear();
+	m_majorLineIndexes.clear();
+	m_fineLineTiles.clear();
+
+	m_mins = mins;
+	m_maxs = maxs;
+	m_numTilesX = numTilesX;
+	m_numTilesY = numTilesY;
+
+	Vec2 tileSize((maxs.x - mins.x) / static_cast<float>(numTilesX), (maxs.y - mins.y) / static_cast<float>(numTilesY));
+	m_fineLineTiles.resize(static_cast<size_t>(numTilesX * numTilesY));
+	for (int tileY = 0; tileY < numTilesY; ++tileY)
+	{
+		for (int tileX = 0; tileX < numTilesX; ++tileX)
+		{
+			Vec3 tileMins(mins.x + tileSize.x * tileX, mins.y + tileSize.y * tileY, 0.f);
+			m_fineLineTiles[tileY * numTilesX + tileX].m_bounds = AABB3(tileMins, tileMins + Vec3(tileSize.x, tileSize.y, 0.f));
+		}
+	}
+}
+
+void StaticGrid::AddMajorLine(AABB3 const& bounds, Rgba8 const& color)
+{
+	AddIndexedBox(bounds, color, m_majorLineIndexes);
+}
+
+void StaticGrid::AddFineLine(AABB3 const& bounds, Rgba8 const& color)
+{
+	// Each tile gets the piece of the line that lies inside it
+	for (size_t tileIndex = 0; tileIndex < m_fineLineTiles.size(); ++tileIndex)
+	{
+		StaticGridTile& tile = m_fineLineTiles[tileIndex];
+		AABB3 clippedBounds = bounds;
+		clippedBounds.m_mins.x = fmaxf(bounds.m_mins.x, tile.m_bounds.m_mins.x);
+		clippedBounds.m_mins.y = fmaxf(bounds.m_mins.y, tile.m_bounds.m_mins.y);
+		clippedBounds.m_maxs.x = fminf(bounds.m_maxs.x, tile.m_bounds.m_maxs.x);
+		clippedBounds.m_maxs.y = fminf(bounds.m_maxs.y, tile.m_bounds.m_maxs.y);
+		if (clippedBounds.m_mins.x >= clippedBounds.m_maxs.x || clippedBounds.m_mins.y >= clippedBounds.m_maxs.y)
+		{
+			continue;
+		}
+
+		AddIndexedBox(clippedBounds, color, tile.m_indexes);
+		tile.m_bounds.m_mins.z = fminf(tile.m_bounds.m_mins.z, bounds.m_mins.z);
+		tile.m_bounds.m_maxs.z = fmaxf(tile.m_bounds.m_maxs.z, bounds.m_maxs.z);
+	}
+}
+
+void StaticGrid::Bake()
+{
+	// Headless runs have no renderer, the tracker's null backend only needs the counts
+	if (g_theRenderer == nullptr)
+	{
+		return;
+	}
+
+	unsigned int vertexBufferSize = static_cast<unsigned int>(m_vertexes.size() * sizeof(Vertex_PCU));
+	m_vertexBuffer = g_theRenderer->CreateVertexBuffer(vertexBufferSize);
+	g_theRenderer->CopyCPUToGPU(m_vertexes.data(), vertexBufferSize, m_vertexBuffer);
+
+	m_majorLineIndexBuffer = CreateIndexBuffer(m_majorLineIndexes);
+	for (size_t tileIndex = 0; tileIndex < m_fineLineTiles.size(); ++tileIndex)
+	{
+		m_fineLineTiles[tileIndex].m_indexBuffer = CreateIndexBuffer(m_fineLineTiles[tileIndex].m_indexes);
+	}
+}
+
+void StaticGrid::Release()
+{
+	delete m_vertexBuffer;
+	m_vertexBuffer = nullptr;
+	delete m_majorLineIndexBuffer;
+	m_majorLineIndexBuffer = nullptr;
+	for (size_t tileIndex = 0; tileIndex < m_fineLineTiles.size(); ++tileIndex)
+	{
+		delete m_fineLineTiles[tileIndex].m_indexBuffer;
+		m_fineLineTiles[tileIndex].m_indexBuffer = nullptr;
+	}
+}
+
+void StaticGrid::Render(RenderStateTracker& renderStateTracker, Vec3 const& viewPosition, Frustum const& viewFrustum) const
+{
+	renderStateTracker.DrawIndexedVertexBuffer(m_vertexBuffer, m_majorLineIndexBuffer, static_cast<int>(m_majorLineIndexes.size()));
+
+	float lodDistanceSquared = GRID_FINE_LINE_LOD_DISTANCE * GRID_FINE_LINE_LOD_DISTANCE;
+	for (size_t tileIndex = 0; tileIndex < m_fineLineTiles.size(); ++tileIndex)
+	{
+		StaticGridTile const& tile = m_fineLineTiles[tileIndex];
+		if (tile.m_indexes.empty())
+		{
+			continue;
+		}
+
+		// Distance from the camera to the closest point of the tile, so a tile the camera stands in is always drawn
+		Vec3 nearestPoint(GetClamped(viewPosition.x, tile.m_bounds.m_mins.x, tile.m_bounds.m_maxs.x),
+			GetClamped(viewPosition.y, tile.m_bounds.m_mins.y, tile.m_bounds.m_maxs.y),
+			GetClamped(viewPosition.z, tile.m_bounds.m_mins.z, tile.m_bounds.m_maxs.z));
+		if ((nearestPoint - viewPosition).GetLengthSquared() > lodDistanceSquared)
+		{
+			continue;
+		}
+
+		Vec3 tileCenter = (tile.m_bounds.m_mins + tile.m_bounds.m_maxs) * 0.5f;
+		float tileRadius = (tile.m_bounds.m_maxs - tileCenter).GetLength();
+		if (!viewFrustum.IsSphereVisible(tileCenter, tileRadius))
+		{
+			continue;
+		}
+
+		renderStateTracker.DrawIndexedVertexBuffer(m_vertexBuffer, tile.m_indexBuffer, static_cast<int>(tile.m_indexes.size()));
+	}
+}
+
+int StaticGrid::GetNumVertexes() const
+{
+	return static_cast<int>(m_vertexes.size());
+}
+
+void StaticGrid::AddIndexedBox(AABB3 const& bounds, Rgba8 const& color, std::vector<unsigned int>& indexes)
+{
+	unsigned int firstVertexIndex = static_cast<unsigned int>(m_vertexes.size());
+	for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		Vec3 corner((cornerIndex & 1) ? bounds.m_maxs.x : bounds.m_mins.x,
+			(cornerIndex & 2) ? bounds.m_maxs.y : bounds.m_mins.y,
+			(cornerIndex & 4) ? bounds.m_maxs.z : bounds.m_mins.z);
+		m_vertexes.push_back(Vertex_PCU(corner, color, Vec2::ZERO));
+	}
+
+	for (int faceIndex = 0; faceIndex < 6; ++faceIndex)
+	{
+		int const* faceCorners = BOX_FACE_CORNERS[faceIndex];
+		indexes.push_back(firstVertexIndex + faceCorners[0]);
+		indexes.push_back(firstVertexIndex + faceCorners[1]);
+		indexes.push_back(firstVertexIndex + faceCorners[2]);
+		indexes.push_back(firstVertexIndex + faceCorners[0]);
+		indexes.push_back(firstVertexIndex + faceCorners[2]);
+		indexes.push_back(firstVertexIndex + faceCorners[3]);
+	}
+}
+
+IndexBuffer* StaticGrid::CreateIndexBuffer(std::vector<unsigned int> const& indexes) const
+{
+	if (indexes.empty())
+	{
+		return nullptr;
+	}
+
+	unsigned int indexBufferSize = static_cast<unsigned int>(indexes.size() * sizeof(unsigned int));
+	IndexBuffer* indexBuffer = g_theRenderer->CreateIndexBuffer(indexBufferSize);
+	g_theRenderer->CopyCPUToGPU(indexes.data(), indexBufferSize, indexBuffer);
+	return indexBuffer;
+}
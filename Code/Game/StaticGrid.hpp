@@ -0,0 +1,58 @@
+#pragma once
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+class Frustum;
+class IndexBuffer;
+class RenderStateTracker;
+class VertexBuffer;
+// -----------------------------------------------------------------------------
+constexpr float GRID_FINE_LINE_LOD_DISTANCE = 30.f;
+// -----------------------------------------------------------------------------
+struct StaticGridTile
+{
+	AABB3 m_bounds;
+	std::vector<unsigned int> m_indexes;
+	IndexBuffer* m_indexBuffer = nullptr;
+};
+// -----------------------------------------------------------------------------
+// Ground grid geometry baked once into a vertex buffer shared by several index
+// buffers. Every line is an indexed 8-vertex box. Major lines are always drawn.
+// Fine lines are split into tiles, and a tile is skipped when it is outside the
+// view or farther than GRID_FINE_LINE_LOD_DISTANCE from the camera.
+// -----------------------------------------------------------------------------
+class StaticGrid
+{
+public:
+	StaticGrid();
+	~StaticGrid();
+
+	void Initialize(Vec2 const& mins, Vec2 const& maxs, int numTilesX, int numTilesY);
+	void AddMajorLine(AABB3 const& bounds, Rgba8 const& color);
+	void AddFineLine(AABB3 const& bounds, Rgba8 const& color);
+	void Bake();
+	void Release();
+
+	void Render(RenderStateTracker& renderStateTracker, Vec3 const& viewPosition, Frustum const& viewFrustum) const;
+	int  GetNumVertexes() const;
+
+private:
+	void AddIndexedBox(AABB3 const& bounds, Rgba8 const& color, std::vector<unsigned int>& indexes);
+	IndexBuffer* CreateIndexBuffer(std::vector<unsigned int> const& indexes) const;
+
+private:
+	Vec2 m_mins;
+	Vec2 m_maxs;
+	int m_numTilesX = 0;
+	int m_numTilesY = 0;
+
+	std::vector<Vertex_PCU> m_vertexes;
+	VertexBuffer* m_vertexBuffer = nullptr;
+	std::vector<unsigned int> m_majorLineIndexes;
+	IndexBuffer* m_majorLineIndexBuffer = nullptr;
+	std::vector<StaticGridTile> m_fineLineTiles;
+};
\ No newline at end of file
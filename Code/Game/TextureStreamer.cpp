@@ -0,0 +1,192 @@
+#include "Game/TextureStreamer.hpp"
+#include "Game/GameCommon.h"
+#include "Game/Profiler.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/Texture.hpp"
+
+TextureStreamer::TextureStreamer(TextureStreamerConfig const& config)
+	: m_config(config)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+}
+
+void TextureStreamer::Startup()
+{
+	// Headless runs have no renderer, so textures are tracked but never decoded or uploaded
+	if (g_theRenderer != nullptr)
+	{
+		m_placeholderTexture = g_theRenderer->CreateTextureFromImage(Image(IntVec2(2, 2), Rgba8::WHITE));
+	}
+}
+
+void TextureStreamer::Shutdown()
+{
+	for (size_t textureIndex = 0; textureIndex < m_textures.size(); ++textureIndex)
+	{
+		StreamedTexture* streamedTexture = m_textures[textureIndex];
+		g_theJobSystem->WaitForCounter(streamedTexture->m_decodeCounter);
+		delete streamedTexture->m_decodedImage;
+		delete streamedTexture->m_texture;
+		delete streamedTexture;
+	}
+	m_textures.clear();
+	m_residentBytes = 0;
+
+	delete m_placeholderTexture;
+	m_placeholderTexture = nullptr;
+}
+
+void TextureStreamer::Update()
+{
+	PROFILE_SCOPE("TextureStreamer::Update");
+	++m_frameNumber;
+	UploadDecodedTextures();
+	EvictOverBudget();
+}
+
+int TextureStreamer::RequestTexture(std::string const& imageFilePath)
+{
+	for (size_t textureIndex = 0; textureIndex < m_textures.size(); ++textureIndex)
+	{
+		if (m_textures[textureIndex]->m_imageFilePath == imageFilePath)
+		{
+			return static_cast<int>(textureIndex);
+		}
+	}
+
+	StreamedTexture* streamedTexture = new StreamedTexture();
+	streamedTexture->m_imageFilePath = imageFilePath;
+	streamedTexture->m_lastUsedFrame = m_frameNumber;
+	m_textures.push_back(streamedTexture);
+	StartDecode(*streamedTexture);
+	return static_cast<int>(m_textures.size()) - 1;
+}
+
+Texture* TextureStreamer::GetTexture(int textureID) const
+{
+	if (textureID < 0 || textureID >= static_cast<int>(m_textures.size()))
+	{
+		return nullptr;
+	}
+
+	StreamedTexture const& streamedTexture = *m_textures[textureID];
+	if (streamedTexture.m_state.load(std::memory_order_relaxed) == StreamedTextureState::RESIDENT)
+	{
+		return streamedTexture.m_texture;
+	}
+	return m_placeholderTexture;
+}
+
+void TextureStreamer::MarkUsed(int textureID)
+{
+	if (textureID < 0 || textureID >= static_cast<int>(m_textures.size()))
+	{
+		return;
+	}
+
+	StreamedTexture& streamedTexture = *m_textures[textureID];
+	streamedTexture.m_lastUsedFrame = m_frameNumber;
+	if (streamedTexture.m_state.load(std::memory_order_relaxed) == StreamedTextureState::UNLOADED)
+	{
+		StartDecode(streamedTexture);
+	}
+}
+
+int TextureStreamer::GetNumTextures() const
+{
+	return static_cast<int>(m_textures.size());
+}
+
+StreamedTextureState TextureStreamer::GetState(int textureID) const
+{
+	return m_textures[textureID]->m_state.load(std::memory_order_acquire);
+}
+
+void TextureStreamer::StartDecode(StreamedTexture& streamedTexture)
+{
+	if (g_theRenderer == nullptr)
+	{
+		return;
+	}
+
+	streamedTexture.m_state.store(StreamedTextureState::DECODING, std::memory_order_relaxed);
+	StreamedTexture* decodeTarget = &streamedTexture;
+	g_theJobSystem->SubmitJob([decodeTarget]()
+		{
+			PROFILE_SCOPE("TextureStreamer::Decode");
+			Image* image = new Image(decodeTarget->m_imageFilePath.c_str());
+			decodeTarget->m_decodedImage = image;
+			IntVec2 dimensions = image->GetDimensions();
+			bool didDecode = dimensions.x > 0 && dimensions.y > 0;
+			decodeTarget->m_state.store(didDecode ? StreamedTextureState::DECODED : StreamedTextureState::FAILED, std::memory_order_release);
+		}, streamedTexture.m_decodeCounter, JobPriority::BACKGROUND);
+}
+
+void TextureStreamer::UploadDecodedTextures()
+{
+	// D3D resources are created on the main thread, a few per frame so a big batch does not cause a spike
+	int numUploads = 0;
+	for (size_t textureIndex = 0; textureIndex < m_textures.size() && numUploads < m_config.m_maxUploadsPerFrame; ++textureIndex)
+	{
+		StreamedTexture& streamedTexture = *m_textures[textureIndex];
+		StreamedTextureState state = streamedTexture.m_state.load(std::memory_order_acquire);
+		if (state == StreamedTextureState::FAILED && streamedTexture.m_decodedImage != nullptr)
+		{
+			ERROR_RECOVERABLE(Stringf("TextureStreamer could not decode \"%s\"", streamedTexture.m_imageFilePath.c_str()));
+			delete streamedTexture.m_decodedImage;
+			streamedTexture.m_decodedImage = nullptr;
+			continue;
+		}
+		if (state != StreamedTextureState::DECODED)
+		{
+			continue;
+		}
+
+		Image* image = streamedTexture.m_decodedImage;
+		IntVec2 dimensions = image->GetDimensions();
+		streamedTexture.m_texture = g_theRenderer->CreateTextureFromImage(*image);
+		streamedTexture.m_numBytes = static_cast<size_t>(dimensions.x) * static_cast<size_t>(dimensions.y) * 4;
+		streamedTexture.m_decodedImage = nullptr;
+		delete image;
+
+		m_residentBytes += streamedTexture.m_numBytes;
+		streamedTexture.m_state.store(StreamedTextureState::RESIDENT, std::memory_order_relaxed);
+		++numUploads;
+	}
+}
+
+void TextureStreamer::EvictOverBudget()
+{
+	// Least recently used first; anything drawn last frame stays even if that leaves us over budget
+	while (m_residentBytes > m_config.m_memoryBudgetBytes)
+	{
+		StreamedTexture* leastRecentlyUsed = nullptr;
+		for (size_t textureIndex = 0; textureIndex < m_textures.size(); ++textureIndex)
+		{
+			StreamedTexture* streamedTexture = m_textures[textureIndex];
+			if (streamedTexture->m_state.load(std::memory_order_relaxed) != StreamedTextureState::RESIDENT || streamedTexture->m_lastUsedFrame + 1 >= m_frameNumber)
+			{
+				continue;
+			}
+			if (leastRecentlyUsed == nullptr || streamedTexture->m_lastUsedFrame < leastRecentlyUsed->m_lastUsedFrame)
+			{
+				leastRecentlyUsed = streamedTexture;
+			}
+		}
+		if (leastRecentlyUsed == nullptr)
+		{
+			break;
+		}
+
+		delete leastRecentlyUsed->m_texture;
+		leastRecentlyUsed->m_texture = nullptr;
+		m_residentBytes -= leastRecentlyUsed->m_numBytes;
+		leastRecentlyUsed->m_numBytes = 0;
+		leastRecentlyUsed->m_state.store(StreamedTextureState::UNLOADED, std::memory_order_relaxed);
+	}
+}
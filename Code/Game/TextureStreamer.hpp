@@ -0,0 +1,73 @@
+#pragma once
+#include "Game/JobSystem.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+class Image;
+class Texture;
+// -----------------------------------------------------------------------------
+enum class StreamedTextureState
+{
+	UNLOADED,
+	DECODING,
+	DECODED,
+	RESIDENT,
+	FAILED
+};
+// -----------------------------------------------------------------------------
+struct TextureStreamerConfig
+{
+	size_t m_memoryBudgetBytes = 256 * 1024 * 1024;
+	int m_maxUploadsPerFrame = 4;
+};
+// -----------------------------------------------------------------------------
+// Loads textures without blocking the frame. RequestTexture returns an ID right
+// away; the file is decoded into an Image on a job system worker, and the GPU
+// upload happens on the main thread in Update. Until then GetTexture returns
+// a placeholder. When resident textures exceed the memory budget, the ones that
+// have gone longest without being drawn are released, and they stream back in
+// the next time they are marked as used. Update must run at a point where no
+// render list still holds a Texture* that was not marked used this frame.
+// -----------------------------------------------------------------------------
+class TextureStreamer
+{
+public:
+	TextureStreamer(TextureStreamerConfig const& config);
+	~TextureStreamer();
+
+	void Startup();
+	void Shutdown();
+	void Update();
+
+	int RequestTexture(std::string const& imageFilePath);
+	Texture* GetTexture(int textureID) const;
+	void MarkUsed(int textureID);
+	int GetNumTextures() const;
+
+	StreamedTextureState GetState(int textureID) const;
+	size_t GetResidentBytes() const { return m_residentBytes; }
+
+private:
+	struct StreamedTexture
+	{
+		std::string m_imageFilePath;
+		std::atomic<StreamedTextureState> m_state{ StreamedTextureState::UNLOADED };
+		Image* m_decodedImage = nullptr;	// Written by the decode job before the state becomes DECODED
+		Texture* m_texture = nullptr;
+		size_t m_numBytes = 0;
+		unsigned int m_lastUsedFrame = 0;
+		JobCounter m_decodeCounter;
+	};
+
+	void StartDecode(StreamedTexture& streamedTexture);
+	void UploadDecodedTextures();
+	void EvictOverBudget();
+
+private:
+	TextureStreamerConfig m_config;
+	std::vector<StreamedTexture*> m_textures;
+	Texture* m_placeholderTexture = nullptr;
+	size_t m_residentBytes = 0;
+	unsigned int m_frameNumber = 0;
+};
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "Game/TransformKernels.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <emmintrin.h>
+#include <math.h>
+
+// Cephes single-precision minimax coefficients, accurate to about 1 ulp on [-pi/4, pi/4]
+static const float SIN_COEFFICIENT_3 = -1.6666654611e-1f;
+static const float SIN_COEFFICIENT_5 = 8.3321608736e-3f;
+static const float SIN_COEFFICIENT_7 = -1.9515295891e-4f;
+static const float COS_COEFFICIENT_4 = 4.166664568298827e-2f;
+static const float COS_COEFFICIENT_6 = -1.388731625493765e-3f;
+static const float COS_COEFFICIENT_8 = 2.443315711809948e-5f;
+static const float RADIANS_PER_DEGREE = ConvertDegreesToRadians(1.f);
+
+static void SinCosDegrees4(__m128 degrees, __m128& out_sin, __m128& out_cos)
+{
+	// Reduce to [-45, 45] degrees around the nearest multiple of 90, remembering which quadrant that was
+	__m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(degrees, _mm_set1_ps(1.f / 90.f)));
+	__m128 reducedDegrees = _mm_sub_ps(degrees, _mm_mul_ps(_mm_cvtepi32_ps(quadrant), _mm_set1_ps(90.f)));
+	__m128 x = _mm_mul_ps(reducedDegrees, _mm_set1_ps(RADIANS_PER_DEGREE));
+	__m128 x2 = _mm_mul_ps(x, x);
+
+	__m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_COEFFICIENT_7), x2), _mm_set1_ps(SIN_COEFFICIENT_5));
+	sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, x2), _mm_set1_ps(SIN_COEFFICIENT_3));
+	sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, x2), x), x);
+
+	__m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_COEFFICIENT_8), x2), _mm_set1_ps(COS_COEFFICIENT_6));
+	cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, x2), _mm_set1_ps(COS_COEFFICIENT_4));
+	cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, x2), x2);
+	cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly, _mm_mul_ps(x2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.f));
+
+	// Odd quadrants swap sine and cosine; sine flips sign in quadrants 2 and 3, cosine in quadrants 1 and 2
+	__m128 swapMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+	__m128 sinValue = _mm_or_ps(_mm_and_ps(swapMask, cosPoly), _mm_andnot_ps(swapMask, sinPoly));
+	__m128 cosValue = _mm_or_ps(_mm_and_ps(swapMask, sinPoly), _mm_andnot_ps(swapMask, cosPoly));
+	__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+	__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+	out_sin = _mm_xor_ps(sinValue, sinSign);
+	out_cos = _mm_xor_ps(cosValue, cosSign);
+}
+
+static void StoreColumns4(__m128 x, __m128 y, __m128 z, __m128 w, Mat44* transforms, int firstValueIndex)
+{
+	// Four matrices' worth of one column, transposed so each matrix gets its own x, y, z, w
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_storeu_ps(&transforms[0].m_values[firstValueIndex], x);
+	_mm_storeu_ps(&transforms[1].m_values[firstValueIndex], y);
+	_mm_storeu_ps(&transforms[2].m_values[firstValueIndex], z);
+	_mm_storeu_ps(&transforms[3].m_values[firstValueIndex], w);
+}
+
+void ComputeModelToWorldTransforms_Reference(int numTransforms, Vec3 const* positions, EulerAngles const* orientations, Mat44* out_transforms)
+{
+	for (int transformIndex = 0; transformIndex < numTransforms; ++transformIndex)
+	{
+		Mat44 modelToWorldMatrix;
+		modelToWorldMatrix.SetTranslation3D(positions[transformIndex]);
+		modelToWorldMatrix.Append(orientations[transformIndex].GetAsMatrix_IFwd_JLeft_KUp());
+		out_transforms[transformIndex] = modelToWorldMatrix;
+	}
+}
+
+void ComputeModelToWorldTransforms(int numTransforms, Vec3 const* positions, EulerAngles const* orientations, Mat44* out_transforms)
+{
+	int transformIndex = 0;
+	for (; transformIndex + 4 <= numTransforms; transformIndex += 4)
+	{
+		EulerAngles const* angles = orientations + transformIndex;
+		Vec3 const* translations = positions + transformIndex;
+		__m128 yaw = _mm_setr_ps(angles[0].m_yawDegrees, angles[1].m_yawDegrees, angles[2].m_yawDegrees, angles[3].m_yawDegrees);
+		__m128 pitch = _mm_setr_ps(angles[0].m_pitchDegrees, angles[1].m_pitchDegrees, angles[2].m_pitchDegrees, angles[3].m_pitchDegrees);
+		__m128 roll = _mm_setr_ps(angles[0].m_rollDegrees, angles[1].m_rollDegrees, angles[2].m_rollDegrees, angles[3].m_rollDegrees);
+
+		__m128 sy, cy, sp, cp, sr, cr;
+		SinCosDegrees4(yaw, sy, cy);
+		SinCosDegrees4(pitch, sp, cp);
+		SinCosDegrees4(roll, sr, cr);
+
+		// Same basis as EulerAngles::GetAsMatrix_IFwd_JLeft_KUp: yaw about K, then pitch about J, then roll about I
+		__m128 cySp = _mm_mul_ps(cy, sp);
+		__m128 sySp = _mm_mul_ps(sy, sp);
+		__m128 iX = _mm_mul_ps(cy, cp);
+		__m128 iY = _mm_mul_ps(sy, cp);
+		__m128 iZ = _mm_sub_ps(_mm_setzero_ps(), sp);
+		__m128 jX = _mm_sub_ps(_mm_mul_ps(cySp, sr), _mm_mul_ps(sy, cr));
+		__m128 jY = _mm_add_ps(_mm_mul_ps(sySp, sr), _mm_mul_ps(cy, cr));
+		__m128 jZ = _mm_mul_ps(cp, sr);
+		__m128 kX = _mm_add_ps(_mm_mul_ps(cySp, cr), _mm_mul_ps(sy, sr));
+		__m128 kY = _mm_sub_ps(_mm_mul_ps(sySp, cr), _mm_mul_ps(cy, sr));
+		__m128 kZ = _mm_mul_ps(cp, cr);
+
+		__m128 tX = _mm_setr_ps(translations[0].x, translations[1].x, translations[2].x, translations[3].x);
+		__m128 tY = _mm_setr_ps(translations[0].y, translations[1].y, translations[2].y, translations[3].y);
+		__m128 tZ = _mm_setr_ps(translations[0].z, translations[1].z, translations[2].z, translations[3].z);
+
+		Mat44* transforms = out_transforms + transformIndex;
+		StoreColumns4(iX, iY, iZ, _mm_setzero_ps(), transforms, Mat44::Ix);
+		StoreColumns4(jX, jY, jZ, _mm_setzero_ps(), transforms, Mat44::Jx);
+		StoreColumns4(kX, kY, kZ, _mm_setzero_ps(), transforms, Mat44::Kx);
+		StoreColumns4(tX, tY, tZ, _mm_set1_ps(1.f), transforms, Mat44::Tx);
+	}
+
+	ComputeModelToWorldTransforms_Reference(numTransforms - transformIndex, positions + transformIndex, orientations + transformIndex, out_transforms + transformIndex);
+}
+
+float GetMaxTransformDifference(int numTransforms, Mat44 const* transformsA, Mat44 const* transformsB)
+{
+	float maxDifference = 0.f;
+	for (int transformIndex = 0; transformIndex < numTransforms; ++transformIndex)
+	{
+		for (int valueIndex = 0; valueIndex < 16; ++valueIndex)
+		{
+			float difference = fabsf(transformsA[transformIndex].m_values[valueIndex] - transformsB[transformIndex].m_values[valueIndex]);
+			maxDifference = fmaxf(maxDifference, difference);
+		}
+	}
+	return maxDifference;
+}
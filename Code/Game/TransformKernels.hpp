@@ -0,0 +1,15 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Mat44.hpp"
+// -----------------------------------------------------------------------------
+// Batched model-to-world transforms: for each entity, translation by its
+// position followed by its yaw/pitch/roll orientation in the I-forward,
+// J-left, K-up convention. The reference builds each matrix the same way
+// Entity::GetModelToWorldTransform does and is what the SSE path is checked
+// against. The SSE path handles four entities per iteration with a polynomial
+// sine/cosine in place of per-angle trig calls.
+// -----------------------------------------------------------------------------
+void ComputeModelToWorldTransforms_Reference(int numTransforms, Vec3 const* positions, EulerAngles const* orientations, Mat44* out_transforms);
+void ComputeModelToWorldTransforms(int numTransforms, Vec3 const* positions, EulerAngles const* orientations, Mat44* out_transforms);
+float GetMaxTransformDifference(int numTransforms, Mat44 const* transformsA, Mat44 const* transformsB);
\ No newline at end of file